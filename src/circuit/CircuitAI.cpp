@@ -20,10 +20,13 @@
 #include "terrain/path/PathFinder.h"
 #include "task/PlayerTask.h"
 #include "unit/CircuitUnit.h"
+#include "unit/enemy/EnemyIndex.h"
 #include "unit/enemy/EnemyUnit.h"
 #include "util/GameAttribute.h"
+#include "util/Profiler.h"
 #include "util/Scheduler.h"
 #include "util/Utils.h"
+#include "util/FileSystem.h"
 #ifdef DEBUG_VIS
 #include "map/InfluenceMap.h"
 #include "map/ThreatMap.h"
@@ -95,6 +98,7 @@ CCircuitAI::CCircuitAI(OOAICallback* clb)
 		, isInitialized(false)
 		, isLoadSave(false)
 		, isResigned(false)
+		, isProfileTrace(false)
 		// NOTE: assert(lastFrame != -1): CCircuitUnit initialized with -1
 		//       and lastFrame check will misbehave until first update event.
 		, lastFrame(-2)
@@ -169,6 +173,7 @@ void CCircuitAI::Resign(int newTeamId, Economy* economy)
 
 int CCircuitAI::HandleGameEvent(int topic, const void* data)
 {
+	PROFILE_ZONE("CCircuitAI::HandleGameEvent");
 	int ret = ERROR_UNKNOWN;
 
 	switch (topic) {
@@ -587,6 +592,9 @@ int CCircuitAI::Init(int skirmishAIId, const struct SSkirmishAICallback* sAICall
 		return ERROR_INIT;
 	}
 	setupManager->ReadConfig();
+	scheduler->SetFrameBudget(setupManager->GetConfig()["quota"].get("frame_budget", FRAME_BUDGET_US).asInt());
+	scheduler->SetMaxThreads(setupManager->GetConfig()["quota"].get("job_threads", JOB_THREADS).asInt());
+	isProfileTrace = setupManager->GetConfig()["quota"].get("profile_trace", false).asBool();
 	if (!setupManager->PickCommander()) {
 		Release(RELEASE_COMMANDER);
 		return ERROR_INIT;
@@ -595,6 +603,7 @@ int CCircuitAI::Init(int skirmishAIId, const struct SSkirmishAICallback* sAICall
 	isAllyAware &= allyTeam->GetSize() > 1;
 
 	terrainManager = std::make_shared<CTerrainManager>(this, &gameAttribute->GetTerrainData());
+	enemyIndex = std::make_shared<CEnemyIndex>(this);
 	economyManager = std::make_shared<CEconomyManager>(this);
 
 	allyTeam->Init(this, decloakRadius);
@@ -631,7 +640,7 @@ int CCircuitAI::Init(int skirmishAIId, const struct SSkirmishAICallback* sAICall
 	if (isCheating) {
 		cheats->SetEnabled(true);
 		cheats->SetEventsEnabled(true);
-		scheduler->RunTaskAt(std::make_shared<CGameTask>(&CCircuitAI::CheatPreload, this), skirmishAIId + 1);
+		scheduler->RunTaskAt(MakeTask(&CCircuitAI::CheatPreload, this), skirmishAIId + 1);
 	}
 
 	scheduler->ProcessInit();  // Init modules: allows to manipulate units on gadget:Initialize
@@ -675,12 +684,15 @@ int CCircuitAI::Release(int reason)
 	scheduler->ProcessRelease();
 	scheduler = nullptr;
 
+	LOG("Shared cost map hit rate: %.2f", pathfinder->GetCostMapHitRate());
+
 	modules.clear();
 	scriptManager = nullptr;
 	militaryManager = nullptr;
 	economyManager = nullptr;
 	factoryManager = nullptr;
 	builderManager = nullptr;
+	enemyIndex = nullptr;
 	terrainManager = nullptr;
 	metalManager = nullptr;
 	pathfinder = nullptr;
@@ -720,6 +732,7 @@ int CCircuitAI::Release(int reason)
 
 int CCircuitAI::Update(int frame)
 {
+	PROFILE_ZONE("CCircuitAI::Update");
 	lastFrame = frame;
 	if (isResigned) {
 		Release(RELEASE_RESIGN);
@@ -953,6 +966,7 @@ int CCircuitAI::UnitFinished(CCircuitUnit* unit)
 
 int CCircuitAI::UnitIdle(CCircuitUnit* unit)
 {
+	unit->SetIdleEvent();
 	for (auto& module : modules) {
 		module->UnitIdle(unit);
 	}
@@ -1312,6 +1326,7 @@ std::pair<CEnemyInfo*, bool> CCircuitAI::RegisterEnemyInfo(ICoreUnit::Id unitId,
 
 	unit = new CEnemyInfo(data);
 	enemyInfos[unitId] = unit;
+	enemyIndex->SetDirty();
 
 	return std::make_pair(unit, true);
 }
@@ -1325,6 +1340,7 @@ CEnemyInfo* CCircuitAI::RegisterEnemyInfo(Unit* e)
 
 	CEnemyInfo* unit = new CEnemyInfo(data);
 	enemyInfos[unit->GetId()] = unit;
+	enemyIndex->SetDirty();
 
 	return unit;
 }
@@ -1333,6 +1349,7 @@ void CCircuitAI::UnregisterEnemyInfo(CEnemyInfo* enemy)
 {
 	allyTeam->UnregisterEnemyUnit(enemy->GetData(), this);
 	enemyInfos.erase(enemy->GetId());
+	enemyIndex->SetDirty();
 	delete enemy;
 }
 
@@ -1575,6 +1592,7 @@ void CCircuitAI::DestroyGameAttribute()
 {
 	gameAttribute->UnregisterAI(this);
 	if (gaCounter <= 1) {
+		SaveProfile();  // last AI of the process
 		if (gameAttribute != nullptr) {
 			gameAttribute = nullptr;  // deletes singleton here;
 		}
@@ -1584,6 +1602,29 @@ void CCircuitAI::DestroyGameAttribute()
 	}
 }
 
+void CCircuitAI::SaveProfile()
+{
+	LOG("Profile:\n%s", CProfiler::Summary().c_str());
+	LOG("Task pool heap allocations: %llu", CTaskPool::GetNumAllocs());
+	if (!isProfileTrace) {
+		return;
+	}
+
+	const std::string mapName = utils::MakeFileSystemCompatible(map->GetName());
+	std::string filename = "profile" SLASH + mapName + ".json";
+	std::string statsName = "profile" SLASH + mapName + "_stats.json";
+	DataDirs* datadirs = callback->GetDataDirs();
+	const bool located = utils::LocatePath(datadirs, filename, true)
+			&& utils::LocatePath(datadirs, statsName, true);
+	delete datadirs;
+	if (located && CProfiler::ExportTrace(filename)) {
+		LOG("Profile trace: %s", filename.c_str());
+	}
+	if (located && CProfiler::ExportStats(statsName)) {
+		LOG("Profile stats: %s", statsName.c_str());
+	}
+}
+
 void CCircuitAI::PrepareAreaUpdate()
 {
 	GetPathfinder()->SetAreaUpdated(false);  // one pathfinder for few allies
@@ -64,6 +64,7 @@ class CScheduler;
 class IModule;
 class CCircuitUnit;
 class CEnemyInfo;
+class CEnemyIndex;
 class COOAICallback;
 class CEngine;
 class CMap;
@@ -164,6 +165,7 @@ public:
 	CEnemyInfo* GetEnemyInfo(springai::Unit* u) const;
 	CEnemyInfo* GetEnemyInfo(ICoreUnit::Id unitId) const;
 	const EnemyInfos& GetEnemyInfos() const { return enemyInfos; }
+	CEnemyIndex* GetEnemyIndex() const { return enemyIndex.get(); }
 
 	CAllyTeam* GetAllyTeam() const { return allyTeam; }
 
@@ -178,6 +180,7 @@ private:
 
 	Units teamUnits;  // owner
 	EnemyInfos enemyInfos;  // owner
+	std::shared_ptr<CEnemyIndex> enemyIndex;
 	CAllyTeam* allyTeam;
 
 	std::vector<CCircuitUnit*> actionUnits;
@@ -294,6 +297,7 @@ private:
 	bool isInitialized;
 	bool isLoadSave;
 	bool isResigned;
+	bool isProfileTrace;
 	int lastFrame;
 	int skirmishAIId;
 	int teamId;
@@ -317,6 +321,7 @@ private:
 	static unsigned int gaCounter;
 	void CreateGameAttribute();
 	void DestroyGameAttribute();
+	void SaveProfile();
 	std::shared_ptr<CScheduler> scheduler;
 	std::shared_ptr<CScriptManager> scriptManager;
 	std::shared_ptr<CSetupManager> setupManager;
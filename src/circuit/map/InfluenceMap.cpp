@@ -12,6 +12,7 @@
 #include "terrain/TerrainManager.h"
 #include "unit/ally/AllyUnit.h"
 #include "CircuitAI.h"
+#include "util/math/CircleRaster.h"
 #include "util/Scheduler.h"
 #include "util/Utils.h"
 #include "json/json.h"
@@ -32,7 +33,9 @@ using namespace springai;
 CInfluenceMap::CInfluenceMap(CMapManager* manager)
 		: manager(manager)
 //		, vulnMax(0.f)
+		, pInflData(&inflData0)
 		, isUpdating(false)
+		, numPinSkips(0)
 {
 	CCircuitAI* circuit = manager->GetCircuit();
 	squareSize = circuit->GetTerrainManager()->GetConvertStoP() * 4;
@@ -96,11 +99,19 @@ void CInfluenceMap::EnqueueUpdate()
 //	if (isUpdating) {
 //		return;
 //	}
+	CCircuitAI* circuit = manager->GetCircuit();
+	if (GetNextInflData()->numPins.load(std::memory_order_acquire) > 0) {
+		// NOTE: Next buffer is still read by CMapQuery, skip this update
+		if (++numPinSkips == INFL_PIN_SKIPS) {
+			circuit->LOG("INFLUENCE: %i updates skipped, buffer pinned by long-lived CMapQuery", numPinSkips);
+		}
+		return;
+	}
+	numPinSkips = 0;
 	isUpdating = true;
 
-	CCircuitAI* circuit = manager->GetCircuit();
-	circuit->GetScheduler()->RunParallelTask(std::make_shared<CGameTask>(&CInfluenceMap::Update, this),
-											 std::make_shared<CGameTask>(&CInfluenceMap::Apply, this));
+	circuit->GetScheduler()->RunParallelTask(MakeTask(&CInfluenceMap::Update, this),
+											 MakeTask(&CInfluenceMap::Apply, this));
 }
 
 void CInfluenceMap::Prepare(SInfluenceData& inflData)
@@ -128,8 +139,9 @@ void CInfluenceMap::Update()
 
 	CEnemyManager* enemyMgr = manager->GetCircuit()->GetEnemyManager();
 
-	for (const SEnemyData& e : enemyMgr->GetHostileDatas()) {
-		AddEnemy(e);
+	const SEnemySnapshot& snapshot = enemyMgr->GetSnapshot();
+	for (size_t i = 0; i < snapshot.numHostile; ++i) {
+		AddEnemy(snapshot, i);
 	}
 }
 
@@ -229,6 +241,18 @@ int CInfluenceMap::Pos2Index(const AIFloat3& pos) const
 	return int(pos.z / squareSize) * width + int(pos.x / squareSize);
 }
 
+CInfluenceMap::SLayers CInfluenceMap::Pin()
+{
+	SInfluenceData* inflData = pInflData.load();
+	inflData->numPins.fetch_add(1, std::memory_order_relaxed);
+	return {enemyInfl, allyInfl, influence, &inflData->numPins};
+}
+
+void CInfluenceMap::Unpin(const SLayers& layers)
+{
+	layers.pins->fetch_sub(1, std::memory_order_release);
+}
+
 int CInfluenceMap::GetUnitRange(CAllyUnit* u) const
 {
 	const CCircuitDef* cdef = u->GetCircuitDef();
@@ -274,27 +298,12 @@ void CInfluenceMap::AddMobileArmed(CAllyUnit* u)
 	const float val = u->GetCircuitDef()->GetPower();
 	// FIXME: GetInfluenceRange: for statics it's just range; mobile should account for speed
 	const int range = GetUnitRange(u);
-	const int rangeSq = SQUARE(range);
-
-	const int beginX = std::max(int(posx - range + 1),       0);
-	const int endX   = std::min(int(posx + range    ),  width);
-	const int beginZ = std::max(int(posz - range + 1),       0);
-	const int endZ   = std::min(int(posz + range    ), height);
-
-	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
-			const int lenSq = dxSq + dzSq;
-			if (lenSq > rangeSq) {
-				continue;
-			}
 
-			const int index = z * width + x;
-			const float infl = val * (1.0f - 1.0f * sqrtf(lenSq) / range);
-			drawAllyInfl[index] += infl;
-		}
-	}
+	// infl = val * (1.0f - 1.0f * dist / range)
+	CCircleRaster::ForEachRow(posx, posz, range, width, height,
+			[this, val](int z, int beginX, int endX, const float* dist) {
+		CCircleRaster::AddSpan(&drawAllyInfl[z * width + beginX], dist, endX - beginX, val, -val);
+	});
 }
 
 void CInfluenceMap::AddStaticArmed(CAllyUnit* u)
@@ -305,28 +314,13 @@ void CInfluenceMap::AddStaticArmed(CAllyUnit* u)
 
 	const float val = u->GetCircuitDef()->GetPower();
 	const int range = u->GetCircuitDef()->GetThreatRange(CCircuitDef::ThreatType::LAND) / 2;
-	const int rangeSq = SQUARE(range);
-
-	const int beginX = std::max(int(posx - range + 1),       0);
-	const int endX   = std::min(int(posx + range    ),  width);
-	const int beginZ = std::max(int(posz - range + 1),       0);
-	const int endZ   = std::min(int(posz + range    ), height);
-
-	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
-			const int lenSq = dxSq + dzSq;
-			if (lenSq > rangeSq) {
-				continue;
-			}
 
-			const int index = z * width + x;
-			const float infl = val * (1.0f - 1.0f * sqrtf(lenSq) / range);
-			drawAllyInfl[index] += infl;
-			drawAllyDefendInfl[index] += infl;
-		}
-	}
+	CCircleRaster::ForEachRow(posx, posz, range, width, height,
+			[this, val](int z, int beginX, int endX, const float* dist) {
+		const int index = z * width + beginX;
+		CCircleRaster::AddSpan(&drawAllyInfl[index], dist, endX - beginX, val, -val);
+		CCircleRaster::AddSpan(&drawAllyDefendInfl[index], dist, endX - beginX, val, -val);
+	});
 }
 
 void CInfluenceMap::AddUnarmed(CAllyUnit* u)
@@ -337,63 +331,28 @@ void CInfluenceMap::AddUnarmed(CAllyUnit* u)
 
 	const float val = 2.f;
 	const int range = DEFAULT_SLACK * 4 * defRadius / squareSize;
-	const int rangeSq = SQUARE(range);
-
-	const int beginX = std::max(int(posx - range + 1),       0);
-	const int endX   = std::min(int(posx + range    ),  width);
-	const int beginZ = std::max(int(posz - range + 1),       0);
-	const int endZ   = std::min(int(posz + range    ), height);
-
-	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
-			const int lenSq = dxSq + dzSq;
-			if (lenSq > rangeSq) {
-				continue;
-			}
 
-			const int index = z * width + x;
-			const float infl = val * (1.0f - 1.0f * sqrtf(lenSq) / range);
-			drawAllyDefendInfl[index] += infl;
-		}
-	}
+	CCircleRaster::ForEachRow(posx, posz, range, width, height,
+			[this, val](int z, int beginX, int endX, const float* dist) {
+		CCircleRaster::AddSpan(&drawAllyDefendInfl[z * width + beginX], dist, endX - beginX, val, -val);
+	});
 }
 
-void CInfluenceMap::AddEnemy(const SEnemyData& e)
+void CInfluenceMap::AddEnemy(const SEnemySnapshot& snapshot, size_t i)
 {
-	int posx, posz;
-
-	PosToXZ(e.pos, posx, posz);
+	const int posx = (int)snapshot.posX[i] / squareSize;
+	const int posz = (int)snapshot.posZ[i] / squareSize;
 
-	const float val = e.threat;
+	const float val = snapshot.threat[i];
 	// FIXME: GetInfluenceRange: for statics it's just range; mobile should account for speed
-	const int range = (e.cdef == nullptr)
-			? e.GetRange(CCircuitDef::ThreatType::LAND)
-			: e.cdef->IsMobile()
-					? e.GetRange(CCircuitDef::ThreatType::LAND)
-					: e.GetRange(CCircuitDef::ThreatType::LAND) / 2;
-	const int rangeSq = SQUARE(range);
-
-	const int beginX = std::max(int(posx - range + 1),       0);
-	const int endX   = std::min(int(posx + range    ),  width);
-	const int beginZ = std::max(int(posz - range + 1),       0);
-	const int endZ   = std::min(int(posz + range    ), height);
-
-	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
-			const int lenSq = dxSq + dzSq;
-			if (lenSq > rangeSq) {
-				continue;
-			}
-
-			const int index = z * width + x;
-			const float infl = val * (1.0f - 1.0f * sqrtf(lenSq) / range);
-			drawEnemyInfl[index] += infl;
-		}
-	}
+	const int range = ((snapshot.cdef[i] == nullptr) || snapshot.IsMobile(i))
+			? snapshot.GetRange(CCircuitDef::ThreatType::LAND, i)
+			: snapshot.GetRange(CCircuitDef::ThreatType::LAND, i) / 2;
+
+	CCircleRaster::ForEachRow(posx, posz, range, width, height,
+			[this, val](int z, int beginX, int endX, const float* dist) {
+		CCircleRaster::AddSpan(&drawEnemyInfl[z * width + beginX], dist, endX - beginX, val, -val);
+	});
 }
 
 //void CInfluenceMap::AddFeature(Feature* f)
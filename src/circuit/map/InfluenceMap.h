@@ -24,6 +24,7 @@ namespace circuit {
 
 #define INFL_BASE		0.f
 #define INFL_EPS		0.01f
+#define INFL_PIN_SKIPS	8  // updates skipped in a row on pinned buffer before warning
 
 class CMapManager;
 class CAllyUnit;
@@ -46,6 +47,21 @@ public:
 	float GetInfluenceAt(const springai::AIFloat3& position) const;
 
 	int Pos2Index(const springai::AIFloat3& pos) const;
+	int GetSquareSize() const { return squareSize; }
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+
+	/*
+	 * Layers of current buffer for CMapQuery, see CThreatMap::Pin
+	 */
+	struct SLayers {
+		const float* enemyInfl;
+		const float* allyInfl;
+		const float* influence;
+		std::atomic<int>* pins;
+	};
+	SLayers Pin();
+	static void Unpin(const SLayers& layers);
 
 private:
 	struct SInfluenceData {
@@ -53,6 +69,7 @@ private:
 		FloatVec allyInfl;
 		FloatVec allyDefendInfl;
 		FloatVec influence;
+		std::atomic<int> numPins{0};  // CMapQuery readers
 //		FloatVec tension;
 //		FloatVec vulnerability;
 //		FloatVec featureInfl;
@@ -65,7 +82,7 @@ private:
 	void AddMobileArmed(CAllyUnit* u);
 	void AddStaticArmed(CAllyUnit* u);
 	void AddUnarmed(CAllyUnit* u);
-	void AddEnemy(const SEnemyData& e);
+	void AddEnemy(const SEnemySnapshot& snapshot, size_t i);
 //	void AddFeature(springai::Feature* f);
 	inline void PosToXZ(const springai::AIFloat3& pos, int& x, int& z) const;
 
@@ -94,6 +111,7 @@ private:
 //	float* drawVulnerability;
 //	float* drawFeatureInfl;
 	bool isUpdating;
+	int numPinSkips;  // updates skipped in a row while next buffer is pinned
 
 	float* enemyInfl;
 	float* allyInfl;
@@ -0,0 +1,126 @@
+/*
+ * MapQuery.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#include "map/MapQuery.h"
+#include "map/MapManager.h"
+#include "unit/CircuitDef.h"
+#include "util/Utils.h"
+
+namespace circuit {
+
+using namespace springai;
+
+CMapQuery::CMapQuery(CMapManager* manager)
+{
+	CThreatMap* threatMap = manager->GetThreatMap();
+	threat = threatMap->Pin();
+	threatSquareSize = threatMap->GetSquareSize();
+	threatWidth = threatMap->GetThreatMapWidth();
+	threatHeight = threatMap->GetThreatMapHeight();
+
+	CInfluenceMap* inflMap = manager->GetInflMap();
+	infl = inflMap->Pin();
+	inflSquareSize = inflMap->GetSquareSize();
+	inflWidth = inflMap->GetWidth();
+	inflHeight = inflMap->GetHeight();
+}
+
+CMapQuery::~CMapQuery()
+{
+	CThreatMap::Unpin(threat);
+	CInfluenceMap::Unpin(infl);
+}
+
+CMapQuery::Layer CMapQuery::GetThreatLayer(const CCircuitDef* cdef)
+{
+	if (cdef->IsAbleToFly()) {
+		return Layer::AIR;
+	}
+	if (cdef->IsAmphibious()) {
+		return Layer::AMPH;
+	}
+	return Layer::SURF;
+}
+
+float CMapQuery::GetThreat(const SSample& sample, Layer threatLayer)
+{
+	switch (threatLayer) {
+		case Layer::AIR:   return sample.air;
+		case Layer::AMPH:  return sample.amph;
+		case Layer::CLOAK: return sample.cloak;
+		default:           return sample.surf;
+	}
+}
+
+void CMapQuery::Query(const AIFloat3* positions, size_t count, unsigned layers, SSample* outSamples) const
+{
+	const bool isThreat = (layers & Layer::THREAT) != 0;
+	const bool isInfl = (layers & Layer::INFL) != 0;
+	int threatIdx[MAP_QUERY_BLOCK];
+	int inflIdx[MAP_QUERY_BLOCK];
+
+	for (size_t begin = 0; begin < count; begin += MAP_QUERY_BLOCK) {
+		const int num = std::min<size_t>(count - begin, MAP_QUERY_BLOCK);
+		const AIFloat3* pos = positions + begin;
+		SSample* out = outSamples + begin;
+
+		// Cells first, prefetch lines of the primary layers
+		for (int i = 0; i < num; ++i) {
+			if (isThreat) {
+				const int x = utils::clamp((int)pos[i].x / threatSquareSize, 0, threatWidth - 1);
+				const int z = utils::clamp((int)pos[i].z / threatSquareSize, 0, threatHeight - 1);
+				threatIdx[i] = z * threatWidth + x;
+				__builtin_prefetch(&threat.surf[threatIdx[i]]);
+			}
+			if (isInfl) {
+				const int x = utils::clamp((int)pos[i].x / inflSquareSize, 0, inflWidth - 1);
+				const int z = utils::clamp((int)pos[i].z / inflSquareSize, 0, inflHeight - 1);
+				inflIdx[i] = z * inflWidth + x;
+				__builtin_prefetch(&infl.influence[inflIdx[i]]);
+			}
+		}
+
+		// Gather per layer
+		if (layers & Layer::AIR) {
+			for (int i = 0; i < num; ++i) {
+				out[i].air = threat.air[threatIdx[i]] - THREAT_BASE;
+			}
+		}
+		if (layers & Layer::SURF) {
+			for (int i = 0; i < num; ++i) {
+				out[i].surf = threat.surf[threatIdx[i]] - THREAT_BASE;
+			}
+		}
+		if (layers & Layer::AMPH) {
+			for (int i = 0; i < num; ++i) {
+				out[i].amph = threat.amph[threatIdx[i]] - THREAT_BASE;
+			}
+		}
+		if (layers & Layer::CLOAK) {
+			for (int i = 0; i < num; ++i) {
+				out[i].cloak = threat.cloak[threatIdx[i]] - THREAT_BASE;
+			}
+		}
+		if (layers & Layer::ENEMY_INFL) {
+			for (int i = 0; i < num; ++i) {
+				out[i].enemyInfl = infl.enemyInfl[inflIdx[i]] - INFL_BASE;
+			}
+		}
+		if (layers & Layer::ALLY_INFL) {
+			for (int i = 0; i < num; ++i) {
+				out[i].allyInfl = infl.allyInfl[inflIdx[i]] - INFL_BASE;
+			}
+		}
+		if (layers & Layer::INFLUENCE) {
+			for (int i = 0; i < num; ++i) {
+				out[i].influence = infl.influence[inflIdx[i]] - INFL_BASE;
+			}
+		}
+	}
+}
+
+} // namespace circuit
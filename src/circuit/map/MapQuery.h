@@ -0,0 +1,86 @@
+/*
+ * MapQuery.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_MAP_MAPQUERY_H_
+#define SRC_CIRCUIT_MAP_MAPQUERY_H_
+
+#include "map/ThreatMap.h"
+#include "map/InfluenceMap.h"
+
+#include <vector>
+
+#define MAP_QUERY_BLOCK		64  // positions per index/prefetch pass
+
+namespace circuit {
+
+class CMapManager;
+
+/*
+ * Batched threat and influence reads over pinned buffers of CThreatMap and CInfluenceMap.
+ * Create on main thread, read from any thread until destruction; maps skip their updates
+ * while pinned buffer would be redrawn, so keep it short-lived (one job).
+ */
+class CMapQuery {
+public:
+	enum Layer: unsigned {
+		AIR        = 0x01,
+		SURF       = 0x02,
+		AMPH       = 0x04,
+		CLOAK      = 0x08,
+		ENEMY_INFL = 0x10,
+		ALLY_INFL  = 0x20,
+		INFLUENCE  = 0x40,
+		THREAT     = AIR | SURF | AMPH | CLOAK,
+		INFL       = ENEMY_INFL | ALLY_INFL | INFLUENCE,
+		ALL        = THREAT | INFL
+	};
+	/*
+	 * Values minus THREAT_BASE / INFL_BASE, as CThreatMap::GetThreatAt and CInfluenceMap::GetInfluenceAt.
+	 * Only fields of requested layers are written.
+	 */
+	struct SSample {
+		float air;
+		float surf;
+		float amph;
+		float cloak;
+		float enemyInfl;
+		float allyInfl;
+		float influence;
+	};
+
+	CMapQuery(CMapManager* manager);
+	CMapQuery(const CMapQuery&) = delete;
+	CMapQuery& operator=(const CMapQuery&) = delete;
+	~CMapQuery();
+
+	/*
+	 * Threat layer of a unit as in CThreatMap::SetThreatType
+	 */
+	static Layer GetThreatLayer(const CCircuitDef* cdef);
+	static float GetThreat(const SSample& sample, Layer threatLayer);
+
+	void Query(const springai::AIFloat3* positions, size_t count, unsigned layers, SSample* outSamples) const;
+	void Query(const std::vector<springai::AIFloat3>& positions, unsigned layers, std::vector<SSample>& outSamples) const {
+		outSamples.resize(positions.size());
+		Query(positions.data(), positions.size(), layers, outSamples.data());
+	}
+
+private:
+	CThreatMap::SLayers threat;
+	int threatSquareSize;
+	int threatWidth;
+	int threatHeight;
+
+	CInfluenceMap::SLayers infl;
+	int inflSquareSize;
+	int inflWidth;
+	int inflHeight;
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_MAP_MAPQUERY_H_
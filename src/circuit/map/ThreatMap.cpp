@@ -11,6 +11,7 @@
 #include "terrain/TerrainManager.h"
 #include "unit/CircuitUnit.h"
 #include "CircuitAI.h"
+#include "util/math/CircleRaster.h"
 #include "util/Scheduler.h"
 #include "util/Utils.h"
 #include "json/json.h"
@@ -29,11 +30,24 @@ using namespace springai;
 #define THREAT_DECAY	1e-2f
 #define THREAT_CLOAK	16.0f
 #define VEL_EPSILON		1e-2f
+#define THREAT_EPSILON	1e-3f
+
+/*
+ * MicroPather cannot deal with negative costs (which may arise due to
+ * floating-point drift after erasing stamps) nor with zero-cost nodes
+ * (see MP::SetMapData, threat is not used as an additive overlay)
+ */
+static inline void AddHeat(float& cell, const float heat)
+{
+	cell = std::max(cell + heat, THREAT_BASE);
+}
 
 CThreatMap::CThreatMap(CMapManager* manager, float decloakRadius)
 		: manager(manager)
 		, pThreatData(&threatData0)
 		, isUpdating(false)
+		, updateNum(0)
+		, numPinSkips(0)
 {
 	CCircuitAI* circuit = manager->GetCircuit();
 	areaData = circuit->GetTerrainManager()->GetAreaData();
@@ -50,6 +64,8 @@ CThreatMap::CThreatMap(CMapManager* manager, float decloakRadius)
 	threatData0.amphThreat.resize(mapSize, THREAT_BASE);
 	threatData0.cloakThreat.resize(mapSize, THREAT_BASE);
 	threatData0.shield.resize(mapSize, 0.f);
+	threatData0.areaData = nullptr;
+	threatData0.numDeltas = 0;
 	airThreat = threatData0.airThreat.data();
 	surfThreat = threatData0.surfThreat.data();
 	amphThreat = threatData0.amphThreat.data();
@@ -62,6 +78,8 @@ CThreatMap::CThreatMap(CMapManager* manager, float decloakRadius)
 	threatData1.amphThreat.resize(mapSize, THREAT_BASE);
 	threatData1.cloakThreat.resize(mapSize, THREAT_BASE);
 	threatData1.shield.resize(mapSize, 0.f);
+	threatData1.areaData = nullptr;
+	threatData1.numDeltas = 0;
 	drawAirThreat = threatData1.airThreat.data();
 	drawSurfThreat = threatData1.surfThreat.data();
 	drawAmphThreat = threatData1.amphThreat.data();
@@ -74,6 +92,7 @@ CThreatMap::CThreatMap(CMapManager* manager, float decloakRadius)
 	const Json::Value& speedSlack = slack["speed"];
 	slackMod.speedMod = speedSlack.get((unsigned)0, 1.f).asFloat() * DEFAULT_SLACK / squareSize;
 	slackMod.speedModMax = speedSlack.get((unsigned)1, 2).asInt() * DEFAULT_SLACK / squareSize;
+	fullUpdateRate = circuit->GetSetupManager()->GetConfig()["quota"].get("thr_full", 16).asInt();
 	constexpr float allowedRange = 2000.f;
 	for (CCircuitDef& cdef : circuit->GetCircuitDefs()) {
 		float slack = squareSize - 1 + cdef.GetAoe() / 2 + DEFAULT_SLACK * slackMod.allMod;
@@ -119,13 +138,21 @@ void CThreatMap::EnqueueUpdate()
 //	if (isUpdating) {
 //		return;
 //	}
+	CCircuitAI* circuit = manager->GetCircuit();
+	if (GetNextThreatData()->numPins.load(std::memory_order_acquire) > 0) {
+		// NOTE: Next buffer is still read by CMapQuery, skip this update
+		if (++numPinSkips == THREAT_PIN_SKIPS) {
+			circuit->LOG("THREAT: %i updates skipped, buffer pinned by long-lived CMapQuery", numPinSkips);
+		}
+		return;
+	}
+	numPinSkips = 0;
 	isUpdating = true;
 
-	CCircuitAI* circuit = manager->GetCircuit();
 	areaData = circuit->GetTerrainManager()->GetAreaData();
 
-	circuit->GetScheduler()->RunParallelTask(std::make_shared<CGameTask>(&CThreatMap::Update, this),
-											 std::make_shared<CGameTask>(&CThreatMap::Apply, this));
+	circuit->GetScheduler()->RunParallelTask(MakeTask(&CThreatMap::Update, this),
+											 MakeTask(&CThreatMap::Apply, this));
 }
 
 void CThreatMap::SetEnemyUnitRange(CEnemyUnit* e) const
@@ -241,6 +268,18 @@ float CThreatMap::GetUnitThreat(CCircuitUnit* unit) const
 	return unit->GetDamage() * sqrtf(std::max(health, 0.f));  // / unit->GetUnit()->GetMaxHealth();
 }
 
+CThreatMap::SLayers CThreatMap::Pin()
+{
+	SThreatData* threatData = pThreatData.load();
+	threatData->numPins.fetch_add(1, std::memory_order_relaxed);
+	return {airThreat, surfThreat, amphThreat, cloakThreat, &threatData->numPins};
+}
+
+void CThreatMap::Unpin(const SLayers& layers)
+{
+	layers.pins->fetch_sub(1, std::memory_order_release);
+}
+
 inline void CThreatMap::PosToXZ(const AIFloat3& pos, int& x, int& z) const
 {
 	x = (int)pos.x / squareSize;
@@ -255,205 +294,140 @@ inline AIFloat3 CThreatMap::XZToPos(int x, int z) const
 	return pos;
 }
 
-void CThreatMap::AddEnemyUnit(const SEnemyData& e)
+void CThreatMap::AddEnemyUnit(const SThreatStamp& e, const float sign)
 {
 	CCircuitDef* cdef = e.cdef;
 	if (cdef == nullptr) {
-		AddEnemyUnitAll(e);
+		AddEnemyUnitAll(e, sign);
 		return;
 	}
 
-	const int vsl = std::min(int(e.vel.Length2D() * slackMod.speedMod), slackMod.speedModMax);
 	if (cdef->HasAntiAir()) {
-		AddEnemyAir(e, vsl);
+		AddEnemyAir(e, e.vsl, sign);
 	}
 	if (cdef->HasAntiLand() || cdef->HasAntiWater()) {
-		cdef->IsAlwaysHit() ? AddEnemyAmphConst(e, vsl) : AddEnemyAmphGradient(e, vsl);
+		cdef->IsAlwaysHit() ? AddEnemyAmphConst(e, e.vsl, sign) : AddEnemyAmphGradient(e, e.vsl, sign);
 	}
-	AddDecloaker(e);
+	AddDecloaker(e, sign);
 
 	if (cdef->GetShieldMount() != nullptr) {
-		AddShield(e);
+		AddShield(e, sign);
 	}
 }
 
-void CThreatMap::AddEnemyUnitAll(const SEnemyData& e)
+void CThreatMap::AddEnemyUnitAll(const SThreatStamp& e, const float sign)
 {
-	AddEnemyAir(e);
-	AddEnemyAmphGradient(e);
-	AddDecloaker(e);
+	AddEnemyAir(e, 0, sign);
+	AddEnemyAmphGradient(e, 0, sign);
+	AddDecloaker(e, sign);
 }
 
-void CThreatMap::AddEnemyAir(const SEnemyData& e, const int slack)
+void CThreatMap::AddEnemyAir(const SThreatStamp& e, const int slack, const float sign)
 {
-	int posx, posz;
-	PosToXZ(e.pos, posx, posz);
+	const int posx = e.x;
+	const int posz = e.z;
 
-	const float threat = e.threat/* - THREAT_DECAY*/;
+	const float threat = e.threat * sign/* - THREAT_DECAY*/;
 	const int range = e.GetRange(CCircuitDef::ThreatType::AIR) + slack;
-	const int rangeSq = SQUARE(range);
 
-	// Threat circles are large and often have appendix, decrease it by 1 for micro-optimization
-	const int beginX = std::max(int(posx - range + 1),      0);
-	const int endX   = std::min(int(posx + range    ),  width);
-	const int beginZ = std::max(int(posz - range + 1),      0);
-	const int endZ   = std::min(int(posz + range    ), height);
-
-	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
-			const int sum = dxSq + dzSq;
-			if (sum > rangeSq) {
-				continue;
-			}
-
-			const int index = z * width + x;
-			const float heat = threat * (1.0f - 0.5f * sqrtf(sum) / range);
-			// MicroPather cannot deal with negative costs
-			// (which may arise due to floating-point drift)
-			// nor with zero-cost nodes (see MP::SetMapData,
-			// threat is not used as an additive overlay)
-			drawAirThreat[index] += heat;
-		}
-	}
+	// Threat circles are large and often have appendix, CCircleRaster decreases it by 1 for micro-optimization
+	// heat = threat * (1.0f - 0.5f * dist / range)
+	CCircleRaster::ForEachRow(posx, posz, range, width, height,
+			[this, threat](int z, int beginX, int endX, const float* dist) {
+		CCircleRaster::AddSpanClamp(&drawAirThreat[z * width + beginX], dist, endX - beginX,
+				threat, -0.5f * threat, THREAT_BASE);
+	});
 }
 
-void CThreatMap::AddEnemyAmphConst(const SEnemyData& e, const int slack)
+void CThreatMap::AddEnemyAmphConst(const SThreatStamp& e, const int slack, const float sign)
 {
-	int posx, posz;
-	PosToXZ(e.pos, posx, posz);
-
-	const float threat = e.threat/* - THREAT_DECAY*/;
-	const int rangeLand = e.GetRange(CCircuitDef::ThreatType::LAND) + slack;
-	const int rangeLandSq = SQUARE(rangeLand);
-	const int rangeWater = e.GetRange(CCircuitDef::ThreatType::WATER) + slack;
-	const int rangeWaterSq = SQUARE(rangeWater);
-	const int range = std::max(rangeLand, rangeWater);
-	const std::vector<STerrainMapSector>& sector = areaData->sector;
-
-	const int beginX = std::max(int(posx - range + 1),      0);
-	const int endX   = std::min(int(posx + range    ),  width);
-	const int beginZ = std::max(int(posz - range + 1),      0);
-	const int endZ   = std::min(int(posz + range    ), height);
-
-	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
+	AddEnemyAmph(e, slack, sign, 0.f);
+}
 
-			const int sum = dxSq + dzSq;
-			const int index = z * width + x;
-			bool isWaterThreat = (sum <= rangeWaterSq) && sector[index].isWater;
-			if (isWaterThreat || ((sum <= rangeLandSq) && (sector[index].position.y >= -SQUARE_SIZE * 5)))
-			{
-				drawAmphThreat[index] += threat;
-			}
-			if (isWaterThreat || (sum <= rangeLandSq))
-			{
-				drawSurfThreat[index] += threat;
-			}
-		}
-	}
+void CThreatMap::AddEnemyAmphGradient(const SThreatStamp& e, const int slack, const float sign)
+{
+	// TODO: 1) Draw as LOS. 2) Separate draw rules for artillery, superweapons, instant-hit weapons
+	// Arty: center have no/little threat
+	// Super: same as arty, or totally ignore its threat
+	// Laser: no gradient
+	AddEnemyAmph(e, slack, sign, 0.5f);
 }
 
-void CThreatMap::AddEnemyAmphGradient(const SEnemyData& e, const int slack)
+void CThreatMap::AddEnemyAmph(const SThreatStamp& e, const int slack, const float sign, const float falloff)
 {
-	int posx, posz;
-	PosToXZ(e.pos, posx, posz);
+	const int posx = e.x;
+	const int posz = e.z;
 
-	const float threat = e.threat/* - THREAT_DECAY*/;
+	const float threat = e.threat * sign/* - THREAT_DECAY*/;
+	const float grad = -falloff * threat;
 	const int rangeLand = e.GetRange(CCircuitDef::ThreatType::LAND) + slack;
-	const int rangeLandSq = SQUARE(rangeLand);
 	const int rangeWater = e.GetRange(CCircuitDef::ThreatType::WATER) + slack;
-	const int rangeWaterSq = SQUARE(rangeWater);
 	const int range = std::max(rangeLand, rangeWater);
+	if (range <= 0) {
+		return;
+	}
 	const std::vector<STerrainMapSector>& sector = areaData->sector;
+	const CCircleRaster::SCircle& circle = CCircleRaster::GetCircle(range);
 
-	const int beginX = std::max(int(posx - range + 1),      0);
-	const int endX   = std::min(int(posx + range    ),  width);
 	const int beginZ = std::max(int(posz - range + 1),      0);
 	const int endZ   = std::min(int(posz + range    ), height);
 
 	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
+		const int dz = std::abs(posz - z);
+		const int extLand = CCircleRaster::RowExtent(range, rangeLand, dz);
+		const int extWater = CCircleRaster::RowExtent(range, rangeWater, dz);
+		const int ext = std::max(extLand, extWater);
+		const int beginX = std::max(int(posx - ext    ),     0);
+		const int endX   = std::min(int(posx + ext + 1), width);
+		// dist[x - beginX] = sqrt(dx^2 + dz^2) / range
+		const float* dist = circle.GetRow(dz) + (circle.extent[dz] + beginX - posx);
 
-			// TODO: 1) Draw as LOS. 2) Separate draw rules for artillery, superweapons, instant-hit weapons
-			// Arty: center have no/little threat
-			// Super: same as arty, or totally ignore its threat
-			// Laser: no gradient
-			const int sum = dxSq + dzSq;
+		for (int x = beginX; x < endX; ++x) {
+			const int dx = std::abs(posx - x);
+			const bool isLandThreat = (dx <= extLand);
 			const int index = z * width + x;
-			const float heat = threat * (1.0f - 0.5f * sqrtf(sum) / range);
-			bool isWaterThreat = (sum <= rangeWaterSq) && sector[index].isWater;
-			if (isWaterThreat || ((sum <= rangeLandSq) && (sector[index].position.y >= -SQUARE_SIZE * 5)))
+			const float heat = threat + grad * dist[x - beginX];
+			const bool isWaterThreat = (dx <= extWater) && sector[index].isWater;
+			if (isWaterThreat || (isLandThreat && (sector[index].position.y >= -SQUARE_SIZE * 5)))
 			{
-				drawAmphThreat[index] += heat;
+				AddHeat(drawAmphThreat[index], heat);
 			}
-			if (isWaterThreat || (sum <= rangeLandSq))
+			if (isWaterThreat || isLandThreat)
 			{
-				drawSurfThreat[index] += heat;
+				AddHeat(drawSurfThreat[index], heat);
 			}
 		}
 	}
 }
 
-void CThreatMap::AddDecloaker(const SEnemyData& e)
+void CThreatMap::AddDecloaker(const SThreatStamp& e, const float sign)
 {
-	int posx, posz;
-	PosToXZ(e.pos, posx, posz);
+	const int posx = e.x;
+	const int posz = e.z;
 
-	const float threatCloak = THREAT_CLOAK;
+	const float threatCloak = THREAT_CLOAK * sign;
 	const int rangeCloak = e.GetRange(CCircuitDef::ThreatType::CLOAK);
-	const int rangeCloakSq = SQUARE(rangeCloak);
-
-	// For small decloak ranges full range shouldn't hit performance
-	const int beginX = std::max(int(posx - rangeCloak + 1),      0);
-	const int endX   = std::min(int(posx + rangeCloak    ),  width);
-	const int beginZ = std::max(int(posz - rangeCloak + 1),      0);
-	const int endZ   = std::min(int(posz + rangeCloak    ), height);
 
-	for (int z = beginZ; z < endZ; ++z) {
-		const int dzSq = SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			const int dxSq = SQUARE(posx - x);
-			const int sum = dxSq + dzSq;
-			if (sum > rangeCloakSq) {
-				continue;
-			}
-
-			const int index = z * width + x;
-			const float heat = threatCloak * (1.0f - 0.75f * sqrtf(sum) / rangeCloak);
-			drawCloakThreat[index] += heat;
-		}
-	}
+	// heat = threatCloak * (1.0f - 0.75f * dist / rangeCloak)
+	CCircleRaster::ForEachRow(posx, posz, rangeCloak, width, height,
+			[this, threatCloak](int z, int beginX, int endX, const float* dist) {
+		CCircleRaster::AddSpanClamp(&drawCloakThreat[z * width + beginX], dist, endX - beginX,
+				threatCloak, -0.75f * threatCloak, THREAT_BASE);
+	});
 }
 
-void CThreatMap::AddShield(const SEnemyData& e)
+void CThreatMap::AddShield(const SThreatStamp& e, const float sign)
 {
-	int posx, posz;
-	PosToXZ(e.pos, posx, posz);
+	const int posx = e.x;
+	const int posz = e.z;
 
-	const float shieldVal = e.shieldPower;
+	const float shieldVal = e.shieldPower * sign;
 	const int rangeShield = e.GetRange(CCircuitDef::ThreatType::SHIELD);
-	const int rangeShieldSq = SQUARE(rangeShield);
 
-	const int beginX = std::max(int(posx - rangeShield + 1),      0);
-	const int endX   = std::min(int(posx + rangeShield    ),  width);
-	const int beginZ = std::max(int(posz - rangeShield + 1),      0);
-	const int endZ   = std::min(int(posz + rangeShield    ), height);
-
-	for (int z = beginZ; z < endZ; ++z) {
-		const int rrz = rangeShieldSq - SQUARE(posz - z);
-		for (int x = beginX; x < endX; ++x) {
-			if (SQUARE(posx - x) > rrz) {
-				continue;
-			}
-			drawShieldArray[z * width + x] += shieldVal;
-		}
-	}
+	CCircleRaster::ForEachRow(posx, posz, rangeShield, width, height,
+			[this, shieldVal](int z, int beginX, int endX, const float* dist) {
+		CCircleRaster::AddConstClamp(&drawShieldArray[z * width + beginX], endX - beginX, shieldVal, 0.f);
+	});
 }
 
 int CThreatMap::GetCloakRange(const CCircuitDef* edef) const
@@ -486,6 +460,46 @@ float CThreatMap::GetEnemyUnitThreat(const CEnemyUnit* e) const
 	return e->GetDamage() * sqrtf(health + shieldArray[z * width + x] * SHIELD_MOD);  // / unit->GetUnit()->GetMaxHealth();
 }
 
+CThreatMap::SThreatStamp CThreatMap::MakeStamp(const SEnemySnapshot& snapshot, size_t i) const
+{
+	SThreatStamp stamp;
+	stamp.cdef = snapshot.cdef[i];
+	stamp.threat = snapshot.threat[i];
+	stamp.shieldPower = snapshot.shieldPower[i];
+	for (CCircuitDef::ThreatT tt = 0; tt < static_cast<CCircuitDef::ThreatT>(CCircuitDef::ThreatType::_SIZE_); ++tt) {
+		stamp.range[tt] = snapshot.range[tt][i];
+	}
+	stamp.x = (int)snapshot.posX[i] / squareSize;
+	stamp.z = (int)snapshot.posZ[i] / squareSize;
+	stamp.vsl = std::min(int(snapshot.speed[i] * slackMod.speedMod), slackMod.speedModMax);
+	stamp.isHostile = snapshot.IsHostile(i);
+	return stamp;
+}
+
+bool CThreatMap::IsStampChanged(const SThreatStamp& stamp, const SThreatStamp& other) const
+{
+	if ((stamp.x != other.x) || (stamp.z != other.z) || (stamp.isHostile != other.isHostile)
+		|| (stamp.cdef != other.cdef) || (stamp.range != other.range))
+	{
+		return true;
+	}
+	if (!stamp.isHostile) {
+		return false;  // decloaker depends on position and range only
+	}
+	return (stamp.vsl != other.vsl)
+		|| (std::fabs(stamp.threat - other.threat) > THREAT_EPSILON)
+		|| (std::fabs(stamp.shieldPower - other.shieldPower) > THREAT_EPSILON);
+}
+
+void CThreatMap::DrawStamp(const SThreatStamp& stamp, const float sign)
+{
+	if (stamp.isHostile) {
+		AddEnemyUnit(stamp, sign);
+	} else {
+		AddDecloaker(stamp, sign);
+	}
+}
+
 void CThreatMap::Prepare(SThreatData& threatData)
 {
 	std::fill(threatData.airThreat.begin(), threatData.airThreat.end(), THREAT_BASE);
@@ -493,6 +507,10 @@ void CThreatMap::Prepare(SThreatData& threatData)
 	std::fill(threatData.amphThreat.begin(), threatData.amphThreat.end(), THREAT_BASE);
 	std::fill(threatData.cloakThreat.begin(), threatData.cloakThreat.end(), THREAT_BASE);
 	std::fill(threatData.shield.begin(), threatData.shield.end(), 0.f);
+	threatData.stamps.clear();
+	threatData.fakeStamps.clear();
+	threatData.areaData = areaData;
+	threatData.numDeltas = 0;
 
 	drawAirThreat = threatData.airThreat.data();
 	drawSurfThreat = threatData.surfThreat.data();
@@ -503,17 +521,82 @@ void CThreatMap::Prepare(SThreatData& threatData)
 
 void CThreatMap::Update()
 {
-	Prepare(*GetNextThreatData());
+	SThreatData& threatData = *GetNextThreatData();
+	// NOTE: Each buffer keeps own stamps as it lags 2 updates behind.
+	//       Sectors' isWater may change with areaData, hence full redraw.
+	if ((fullUpdateRate <= 1) || (threatData.areaData != areaData) || (threatData.numDeltas >= fullUpdateRate)) {
+		UpdateFull(threatData);
+	} else {
+		UpdateDelta(threatData);
+	}
+}
+
+void CThreatMap::UpdateFull(SThreatData& threatData)
+{
+	Prepare(threatData);
+
+	const SEnemySnapshot& snapshot = manager->GetCircuit()->GetEnemyManager()->GetSnapshot();
+	const size_t size = snapshot.Size();
+	threatData.stamps.reserve(size);
+
+	for (size_t i = 0; i < size; ++i) {
+		SThreatStamp stamp = MakeStamp(snapshot, i);
+		DrawStamp(stamp, 1.f);
+		if (snapshot.IsFake(i)) {
+			threatData.fakeStamps.push_back(stamp);
+		} else {
+			threatData.stamps.emplace(snapshot.id[i], stamp);
+		}
+	}
+}
+
+void CThreatMap::UpdateDelta(SThreatData& threatData)
+{
+	threatData.numDeltas++;
 
-	CEnemyManager* enemyMgr = manager->GetCircuit()->GetEnemyManager();
+	drawAirThreat = threatData.airThreat.data();
+	drawSurfThreat = threatData.surfThreat.data();
+	drawAmphThreat = threatData.amphThreat.data();
+	drawCloakThreat = threatData.cloakThreat.data();
+	drawShieldArray = threatData.shield.data();
 
-	for (const SEnemyData& e : enemyMgr->GetHostileDatas()) {
-		AddEnemyUnit(e);
+	for (const SThreatStamp& stamp : threatData.fakeStamps) {
+		DrawStamp(stamp, -1.f);
+	}
+	threatData.fakeStamps.clear();
+
+	const SEnemySnapshot& snapshot = manager->GetCircuit()->GetEnemyManager()->GetSnapshot();
+	const size_t size = snapshot.Size();
+
+	nextStamps.clear();
+	nextStamps.reserve(size);
+	for (size_t i = 0; i < size; ++i) {
+		SThreatStamp stamp = MakeStamp(snapshot, i);
+		if (snapshot.IsFake(i)) {
+			DrawStamp(stamp, 1.f);
+			threatData.fakeStamps.push_back(stamp);
+			continue;
+		}
+
+		const ICoreUnit::Id id = snapshot.id[i];
+		auto it = threatData.stamps.find(id);
+		if (it == threatData.stamps.end()) {
+			DrawStamp(stamp, 1.f);
+		} else {
+			if (IsStampChanged(it->second, stamp)) {
+				DrawStamp(it->second, -1.f);
+				DrawStamp(stamp, 1.f);
+			}
+			threatData.stamps.erase(it);
+		}
+		nextStamps.emplace(id, stamp);
 	}
 
-	for (const SEnemyData& e : enemyMgr->GetPeaceDatas()) {
-		AddDecloaker(e);
+	// Erase enemies that are gone since last update of this buffer
+	for (auto& kv : threatData.stamps) {
+		DrawStamp(kv.second, -1.f);
 	}
+	threatData.stamps.swap(nextStamps);
 }
 
 void CThreatMap::Apply()
@@ -536,6 +619,7 @@ void CThreatMap::SwapBuffers()
 	cloakThreat = threatData.cloakThreat.data();
 	shieldArray = threatData.shield.data();
 	threatArray = surfThreat;
+	++updateNum;
 }
 
 #ifdef DEBUG_VIS
@@ -12,12 +12,14 @@
 #include "unit/enemy/EnemyUnit.h"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 namespace circuit {
 
 #define THREAT_UPDATE_RATE	(FRAMES_PER_SEC / 4)
 #define THREAT_BASE			0.f
+#define THREAT_PIN_SKIPS	8  // updates skipped in a row on pinned buffer before warning
 
 class CMapManager;
 class CCircuitUnit;
@@ -29,6 +31,7 @@ public:
 
 	void EnqueueUpdate();
 	bool IsUpdating() const { return isUpdating; }
+	int GetUpdateNum() const { return updateNum; }  // increments on each swap of threat arrays
 
 	void SetEnemyUnitRange(CEnemyUnit* e) const;
 	void SetEnemyUnitThreat(CEnemyUnit* e) const { e->SetThreat(GetEnemyUnitThreat(e)); }
@@ -50,17 +53,52 @@ public:
 	int GetSquareSize() const { return squareSize; }
 	int GetMapSize() const { return mapSize; }
 
+	/*
+	 * Layers of current buffer for CMapQuery. Pinned buffer is not redrawn,
+	 * EnqueueUpdate skips while it is the next one. Pin on main thread, Unpin on any.
+	 */
+	struct SLayers {
+		const float* air;
+		const float* surf;
+		const float* amph;
+		const float* cloak;
+		std::atomic<int>* pins;
+	};
+	SLayers Pin();
+	static void Unpin(const SLayers& layers);
+
 private:
 	/*
 	 * http://stackoverflow.com/questions/872544/precision-of-floating-point
 	 * Single precision: for accuracy of +/-0.5 (or 2^-1) the maximum size that the number can be is 2^23.
 	 */
+	/*
+	 * Enemy's contribution drawn into layers, redrawn with negative sign to erase it
+	 */
+	struct SThreatStamp {
+		CCircuitDef* cdef;
+		float threat;
+		float shieldPower;
+		SEnemyData::RangeArray range;
+		int x, z;  // cell
+		int vsl;  // velocity slack
+		bool isHostile;  // false - decloaker only
+
+		int GetRange(CCircuitDef::ThreatType t) const {
+			return range[static_cast<CCircuitDef::ThreatT>(t)];
+		}
+	};
 	struct SThreatData {
 		FloatVec airThreat;  // air layer
 		FloatVec surfThreat;  // surface (water and land)
 		FloatVec amphThreat;  // under water and surface on land
 		FloatVec cloakThreat;  // decloakers
 		FloatVec shield;  // total shield power that covers tile
+		std::unordered_map<ICoreUnit::Id, SThreatStamp> stamps;  // drawn enemies
+		std::vector<SThreatStamp> fakeStamps;  // fakes have no id, redrawn each update
+		const SAreaData* areaData;  // isWater of sectors used for drawing
+		int numDeltas;  // incremental updates since last full rebuild
+		std::atomic<int> numPins{0};  // CMapQuery readers
 	};
 
 	CMapManager* manager;
@@ -69,13 +107,19 @@ private:
 	inline void PosToXZ(const springai::AIFloat3& pos, int& x, int& z) const;
 	inline springai::AIFloat3 XZToPos(int x, int z) const;
 
-	void AddEnemyUnit(const SEnemyData& e);
-	void AddEnemyUnitAll(const SEnemyData& e);
-	void AddEnemyAir(const SEnemyData& e, const int slack = 0);  // Enemy AntiAir
-	void AddEnemyAmphConst(const SEnemyData& e, const int slack = 0);  // Enemy AntiAmph
-	void AddEnemyAmphGradient(const SEnemyData& e, const int slack = 0);  // Enemy AntiAmph
-	void AddDecloaker(const SEnemyData& e);
-	void AddShield(const SEnemyData& e);
+	// NOTE: sign = -1 erases previously drawn enemy
+	void AddEnemyUnit(const SThreatStamp& e, const float sign = 1.f);
+	void AddEnemyUnitAll(const SThreatStamp& e, const float sign = 1.f);
+	void AddEnemyAir(const SThreatStamp& e, const int slack = 0, const float sign = 1.f);  // Enemy AntiAir
+	void AddEnemyAmphConst(const SThreatStamp& e, const int slack = 0, const float sign = 1.f);  // Enemy AntiAmph
+	void AddEnemyAmphGradient(const SThreatStamp& e, const int slack = 0, const float sign = 1.f);  // Enemy AntiAmph
+	void AddEnemyAmph(const SThreatStamp& e, const int slack, const float sign, const float falloff);
+	void AddDecloaker(const SThreatStamp& e, const float sign = 1.f);
+	void AddShield(const SThreatStamp& e, const float sign = 1.f);
+
+	SThreatStamp MakeStamp(const SEnemySnapshot& snapshot, size_t i) const;
+	bool IsStampChanged(const SThreatStamp& stamp, const SThreatStamp& other) const;
+	void DrawStamp(const SThreatStamp& stamp, const float sign);
 
 	int GetCloakRange(const CCircuitDef* edef) const;
 	int GetShieldRange(const CCircuitDef* edef) const;
@@ -83,6 +127,8 @@ private:
 
 	void Prepare(SThreatData& threatData);
 	void Update();
+	void UpdateFull(SThreatData& threatData);
+	void UpdateDelta(SThreatData& threatData);
 	void Apply();
 	void SwapBuffers();
 	SThreatData* GetNextThreatData() {
@@ -96,6 +142,7 @@ private:
 
 	int rangeDefault;
 	int distCloak;
+	int fullUpdateRate;  // full rebuild every N updates of the same buffer, bounds float drift
 	struct {
 		float allMod;
 		float staticMod;
@@ -104,6 +151,7 @@ private:
 	} slackMod;
 
 	SThreatData threatData0, threatData1;  // Double-buffer for threading
+	std::unordered_map<ICoreUnit::Id, SThreatStamp> nextStamps;  // worker-thread scratch
 	std::atomic<SThreatData*> pThreatData;
 	float* drawAirThreat;
 	float* drawSurfThreat;
@@ -111,6 +159,8 @@ private:
 	float* drawCloakThreat;
 	float* drawShieldArray;
 	bool isUpdating;
+	int updateNum;
+	int numPinSkips;  // updates skipped in a row while next buffer is pinned
 
 	float* airThreat;
 	float* surfThreat;
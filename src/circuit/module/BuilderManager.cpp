@@ -57,7 +57,7 @@ CBuilderManager::CBuilderManager(CCircuitAI* circuit)
 		, buildPower(.0f)
 		, buildIterator(0)
 {
-	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CBuilderManager::Init, this));
+	circuit->GetScheduler()->RunOnInit(MakeTask(&CBuilderManager::Init, this));
 
 	/*
 	 * worker handlers
@@ -197,7 +197,7 @@ CBuilderManager::CBuilderManager(CCircuitAI* circuit)
 			return;
 		}
 		// Check mex position in 20 seconds
-		this->circuit->GetScheduler()->RunTaskAfter(std::make_shared<CGameTask>([this, mexDef, pos, index]() {
+		this->circuit->GetScheduler()->RunTaskAfter(MakeTask([this, mexDef, pos, index]() {
 			if (this->circuit->GetEconomyManager()->IsAllyOpenSpot(index) &&
 				this->circuit->GetBuilderManager()->IsBuilderInArea(mexDef, pos) &&
 				this->circuit->GetTerrainManager()->CanBeBuiltAtSafe(mexDef, pos))  // hostile environment
@@ -365,10 +365,10 @@ void CBuilderManager::Init()
 		CScheduler* scheduler = circuit->GetScheduler().get();
 		const int interval = 8;
 		const int offset = circuit->GetSkirmishAIId() % interval;
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CBuilderManager::UpdateIdle, this), interval, offset + 0);
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CBuilderManager::UpdateBuild, this), 1/*interval*/, offset + 1);
+		scheduler->RunTaskEvery(MakeTask(&CBuilderManager::UpdateIdle, this), interval, offset + 0);
+		scheduler->RunTaskEvery(MakeTask(&CBuilderManager::UpdateBuild, this), 1/*interval*/, offset + 1);
 
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CBuilderManager::Watchdog, this),
+		scheduler->RunTaskEvery(MakeTask(&CBuilderManager::Watchdog, this),
 								FRAMES_PER_SEC * 60,
 								circuit->GetSkirmishAIId() * WATCHDOG_COUNT + 10);
 	};
@@ -879,10 +879,8 @@ IUnitTask* CBuilderManager::DefaultMakeTask(CCircuitUnit* unit)
 		return nullptr;
 	}
 
-	CPathFinder* pathfinder = circuit->GetPathfinder();
-	std::shared_ptr<IPathQuery> q = pathfinder->CreateCostMapQuery(unit, threatMap, frame, pos);
-	costQueries[unit] = q;
-	pathfinder->RunQuery(q);
+	// NOTE: builders of the same type around the same spot share cost map
+	costQueries[unit] = circuit->GetPathfinder()->CreateSharedCostMapQuery(unit, threatMap, frame, pos);
 
 	if (query == nullptr) {
 		return EnqueueWait(FRAMES_PER_SEC);  // 1st run
@@ -1216,17 +1214,16 @@ void CBuilderManager::Watchdog()
 	CEconomyManager* economyMgr = circuit->GetEconomyManager();
 	Resource* metalRes = economyMgr->GetMetalRes();
 	// somehow workers get stuck
+	const int frame = circuit->GetLastFrame();
 	for (CCircuitUnit* worker : workers) {
-		if (worker->GetTask()->GetType() == IUnitTask::Type::PLAYER) {
+		if ((worker->GetTask()->GetType() == IUnitTask::Type::PLAYER) || !worker->IsIdleSuspect(frame)) {
 			continue;
 		}
 		Unit* u = worker->GetUnit();
-		auto commands = u->GetCurrentCommands();
 		// TODO: Ignore workers with idle and wait task? (.. && worker->GetTask()->IsBusy())
-		if (commands.empty() && (u->GetResourceUse(metalRes) == .0f) && (u->GetVel() == ZeroVector)) {
+		if (worker->IsCmdQueueEmpty() && (u->GetResourceUse(metalRes) == .0f) && (u->GetVel() == ZeroVector)) {
 			worker->GetTask()->OnUnitMoveFailed(worker);
 		}
-		utils::free_clear(commands);
 	}
 
 	// find unfinished abandoned buildings
@@ -13,6 +13,7 @@
 #include "setup/SetupManager.h"
 #include "resource/MetalManager.h"
 #include "resource/EnergyGrid.h"
+#include "resource/ReclaimRegistry.h"
 #include "terrain/TerrainManager.h"
 #include "CircuitAI.h"
 #include "util/Scheduler.h"
@@ -25,8 +26,6 @@
 #include "AISCommands.h"
 #include "Resource.h"
 #include "Economy.h"
-#include "Feature.h"
-#include "FeatureDef.h"
 #include "Team.h"
 #include "Log.h"
 
@@ -42,6 +41,7 @@ const char* RES_NAME_ENERGY = "Energy";
 CEconomyManager::CEconomyManager(CCircuitAI* circuit)
 		: IModule(circuit, new CEconomyScript(circuit->GetScriptManager(), this))
 		, energyGrid(nullptr)
+		, reclaimRegistry(nullptr)
 		, pylonDef(nullptr)
 		, mexDef(nullptr)
 		, storeDef(nullptr)
@@ -78,7 +78,7 @@ CEconomyManager::CEconomyManager(CCircuitAI* circuit)
 	// TODO: Use A* ai planning... or sth... STRIPS https://ru.wikipedia.org/wiki/STRIPS
 	//       https://ru.wikipedia.org/wiki/Марковский_процесс_принятия_решений
 
-	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CEconomyManager::Init, this));
+	circuit->GetScheduler()->RunOnInit(MakeTask(&CEconomyManager::Init, this));
 
 	/*
 	 * factory handlers
@@ -130,7 +130,7 @@ CEconomyManager::CEconomyManager(CCircuitAI* circuit)
 		this->circuit->GetSetupManager()->SetCommander(unit);
 
 		ICoreUnit::Id unitId = unit->GetId();
-		this->circuit->GetScheduler()->RunTaskAfter(std::make_shared<CGameTask>([this, unitId]() {
+		this->circuit->GetScheduler()->RunTaskAfter(MakeTask([this, unitId]() {
 			CCircuitUnit* unit = this->circuit->GetTeamUnit(unitId);
 			if (unit == nullptr) {
 				return;
@@ -158,7 +158,7 @@ CEconomyManager::CEconomyManager(CCircuitAI* circuit)
 			}
 			int morphFrame = this->circuit->GetSetupManager()->GetMorphFrame(unit->GetCircuitDef());
 			if (morphFrame >= 0) {
-				this->circuit->GetScheduler()->RunTaskAt(std::make_shared<CGameTask>([this, unitId]() {
+				this->circuit->GetScheduler()->RunTaskAt(MakeTask([this, unitId]() {
 					// Force commander level 0 to morph
 					CCircuitUnit* unit = this->circuit->GetTeamUnit(unitId);
 					if ((unit != nullptr) && (unit->GetTask() != nullptr) &&
@@ -263,6 +263,7 @@ CEconomyManager::~CEconomyManager()
 	delete metalRes;
 	delete energyRes;
 	delete economy;
+	delete reclaimRegistry;
 }
 
 void CEconomyManager::ReadConfig()
@@ -319,6 +320,7 @@ void CEconomyManager::ReadConfig()
 void CEconomyManager::Init()
 {
 	energyGrid = circuit->GetAllyTeam()->GetEnergyGrid().get();
+	reclaimRegistry = new CReclaimRegistry(circuit, metalRes->GetResourceId());
 
 	const size_t clSize = circuit->GetMetalManager()->GetClusters().size();
 	clusterInfos.resize(clSize, {nullptr, -FRAMES_PER_SEC});
@@ -382,18 +384,20 @@ void CEconomyManager::Init()
 			// FIXME: DEBUG
 		}
 
-		scheduler->RunTaskAfter(std::make_shared<CGameTask>([this]() {
+		scheduler->RunTaskAfter(MakeTask([this]() {
 			ecoFactor = (circuit->GetAllyTeam()->GetAliveSize() - 1.0f) * ecoStep + 1.0f;
 		}), FRAMES_PER_SEC * 10);
 
 		const int interval = allyTeam->GetSize() * FRAMES_PER_SEC;
 		auto update = static_cast<IBuilderTask* (CEconomyManager::*)(void)>(&CEconomyManager::UpdateFactoryTasks);
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(update, this),
+		scheduler->RunTaskEvery(MakeTask(update, this),
 								interval, circuit->GetSkirmishAIId() + 0 + 10 * interval);
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CEconomyManager::UpdateStorageTasks, this),
+		scheduler->RunTaskEvery(MakeTask(&CEconomyManager::UpdateStorageTasks, this),
 								interval, circuit->GetSkirmishAIId() + 1 + interval / 2);
 
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CEconomyManager::UpdateResourceIncome, this), TEAM_SLOWUPDATE_RATE);
+		scheduler->RunTaskEvery(MakeTask(&CEconomyManager::UpdateResourceIncome, this), TEAM_SLOWUPDATE_RATE);
+		scheduler->RunTaskEvery(MakeTask(&CReclaimRegistry::Update, reclaimRegistry),
+								FRAMES_PER_SEC, circuit->GetSkirmishAIId() + 2);
 	};
 
 	circuit->GetSetupManager()->ExecOnFindStart(subinit);
@@ -707,46 +711,26 @@ IBuilderTask* CEconomyManager::UpdateReclaimTasks(const AIFloat3& position, CCir
 		return nullptr;
 	}
 
-	std::vector<Feature*> features;
-	if (isNear) {
-		const float distance = unit->GetCircuitDef()->GetSpeed() * ((GetMetalPull() * 0.8f > GetAvgMetalIncome()) ? 300 : 30);
-		features = std::move(circuit->GetCallback()->GetFeaturesIn(position, distance));
-	} else {
-		features = std::move(circuit->GetCallback()->GetFeatures());
-	}
-	if (features.empty()) {
+	if (reclaimRegistry->IsEmpty()) {
 		return nullptr;
 	}
+	float distance = std::numeric_limits<float>::max();
+	if (isNear) {
+		distance = unit->GetCircuitDef()->GetSpeed() * ((GetMetalPull() * 0.8f > GetAvgMetalIncome()) ? 300 : 30);
+	}
 
 	CTerrainManager* terrainMgr = circuit->GetTerrainManager();
-	AIFloat3 pos;
-	float cost = .0f;
-	float minSqDist = std::numeric_limits<float>::max();
-	for (Feature* feature : features) {
-		AIFloat3 featPos = feature->GetPosition();
-		CTerrainManager::CorrectPosition(featPos);  // Impulsed flying feature
-		if (!terrainMgr->CanReachAtSafe(unit, featPos, unit->GetCircuitDef()->GetBuildDistance())) {
-			continue;
-		}
-		FeatureDef* featDef = feature->GetDef();
-		if (!featDef->IsReclaimable()) {
-			delete featDef;
-			continue;
-		}
-		float reclaimValue = featDef->GetContainedResource(metalRes)/* * feature->GetReclaimLeft()*/;
-		delete featDef;
-		if (reclaimValue < 1.0f) {
-			continue;
-		}
-		float sqDist = position.SqDistance2D(featPos);
-		if (sqDist < minSqDist) {
-			pos = featPos;
-			cost = reclaimValue;
-			minSqDist = sqDist;
-		}
+	const float buildDistance = unit->GetCircuitDef()->GetBuildDistance();
+	const CReclaimRegistry::SFeature* feature = reclaimRegistry->FindNearest(position, distance,
+		[terrainMgr, unit, buildDistance](const CReclaimRegistry::SFeature& f) {
+			return terrainMgr->CanReachAtSafe(unit, f.pos, buildDistance);
+		});
+	if (feature != nullptr) {
+		feature = reclaimRegistry->Refresh(feature);  // nullptr: destroyed since last update
 	}
 	IBuilderTask* task = nullptr;
-	if (minSqDist < std::numeric_limits<float>::max()) {
+	if (feature != nullptr) {
+		const AIFloat3& pos = feature->pos;
 		for (IBuilderTask* t : builderMgr->GetTasks(IBuilderTask::BuildType::RECLAIM)) {
 			if (utils::is_equal_pos(pos, t->GetTaskPos())) {
 				task = t;
@@ -754,11 +738,10 @@ IBuilderTask* CEconomyManager::UpdateReclaimTasks(const AIFloat3& position, CCir
 			}
 		}
 		if (task == nullptr) {
-			task = builderMgr->EnqueueReclaim(IBuilderTask::Priority::HIGH, pos, cost, FRAMES_PER_SEC * 300,
+			task = builderMgr->EnqueueReclaim(IBuilderTask::Priority::HIGH, pos, feature->metal, FRAMES_PER_SEC * 300,
 											  8.0f/*unit->GetCircuitDef()->GetBuildDistance()*/);
 		}
 	}
-	utils::free_clear(features);
 
 	return task;
 }
@@ -1120,7 +1103,7 @@ IBuilderTask* CEconomyManager::UpdatePylonTasks()
 		// TODO: Optimize: when invalid link appears start watchdog gametask
 		//       that will traverse invalidLinks vector and enable link on timeout.
 		//       When invalidLinks is empty remove watchdog gametask.
-		circuit->GetScheduler()->RunTaskAfter(std::make_shared<CGameTask>([link](CEnergyGrid* energyGrid) {
+		circuit->GetScheduler()->RunTaskAfter(MakeTask([link](CEnergyGrid* energyGrid) {
 			link->SetValid(true);
 			energyGrid->SetForceRebuild(true);
 		}, energyGrid), FRAMES_PER_SEC * 120);
@@ -1136,7 +1119,7 @@ void CEconomyManager::AddMorphee(CCircuitUnit* unit)
 	}
 	morphees.insert(unit);
 	if (morph == nullptr) {
-		morph = std::make_shared<CGameTask>(&CEconomyManager::UpdateMorph, this);
+		morph = MakeTask(&CEconomyManager::UpdateMorph, this);
 		circuit->GetScheduler()->RunTaskEvery(morph, FRAMES_PER_SEC * 10);
 	}
 }
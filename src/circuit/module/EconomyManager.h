@@ -32,6 +32,7 @@ extern const char* RES_NAME_ENERGY;
 class IBuilderTask;
 class CGameTask;
 class CEnergyGrid;
+class CReclaimRegistry;
 
 class CEconomyManager: public IModule {
 public:
@@ -111,6 +112,7 @@ private:
 	springai::Resource* energyRes;
 	springai::Economy* economy;
 	CEnergyGrid* energyGrid;
+	CReclaimRegistry* reclaimRegistry;
 
 	struct SClusterInfo {
 		CCircuitUnit* factory;
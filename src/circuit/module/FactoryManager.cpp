@@ -43,7 +43,7 @@ CFactoryManager::CFactoryManager(CCircuitAI* circuit)
 		, bpRatio(1.f)
 		, reWeight(.5f)
 {
-	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CFactoryManager::Init, this));
+	circuit->GetScheduler()->RunOnInit(MakeTask(&CFactoryManager::Init, this));
 
 	/*
 	 * factory handlers
@@ -506,10 +506,10 @@ void CFactoryManager::Init()
 		CScheduler* scheduler = circuit->GetScheduler().get();
 		const int interval = 4;
 		const int offset = circuit->GetSkirmishAIId() % interval;
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CFactoryManager::UpdateIdle, this), interval, offset + 0);
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CFactoryManager::UpdateFactory, this), interval, offset + 2);
+		scheduler->RunTaskEvery(MakeTask(&CFactoryManager::UpdateIdle, this), interval, offset + 0);
+		scheduler->RunTaskEvery(MakeTask(&CFactoryManager::UpdateFactory, this), interval, offset + 2);
 
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CFactoryManager::Watchdog, this),
+		scheduler->RunTaskEvery(MakeTask(&CFactoryManager::Watchdog, this),
 								FRAMES_PER_SEC * 60,
 								circuit->GetSkirmishAIId() * WATCHDOG_COUNT + 11);
 	};
@@ -1271,15 +1271,14 @@ IUnitTask* CFactoryManager::CreateAssistTask(CCircuitUnit* unit)
 void CFactoryManager::Watchdog()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
-	auto checkIdler = [this](CCircuitUnit* unit) {
-		if (unit->GetTask()->GetType() == IUnitTask::Type::PLAYER) {
+	const int frame = circuit->GetLastFrame();
+	auto checkIdler = [this, frame](CCircuitUnit* unit) {
+		if ((unit->GetTask()->GetType() == IUnitTask::Type::PLAYER) || !unit->IsIdleSuspect(frame)) {
 			return;
 		}
-		auto commands = unit->GetUnit()->GetCurrentCommands();
-		if (commands.empty()) {
+		if (unit->IsCmdQueueEmpty()) {
 			UnitIdle(unit);
 		}
-		utils::free_clear(commands);
 	};
 
 	for (SFactory& fac : factories) {
@@ -60,7 +60,7 @@ CMilitaryManager::CMilitaryManager(CCircuitAI* circuit)
 		, sonarDef(nullptr)
 		, bigGunDef(nullptr)
 {
-	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CMilitaryManager::Init, this));
+	circuit->GetScheduler()->RunOnInit(MakeTask(&CMilitaryManager::Init, this));
 
 	/*
 	 * Defence handlers
@@ -443,11 +443,11 @@ void CMilitaryManager::Init()
 		CScheduler* scheduler = circuit->GetScheduler().get();
 		const int interval = 4;
 		const int offset = circuit->GetSkirmishAIId() % interval;
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CMilitaryManager::UpdateIdle, this), interval, offset + 0);
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CMilitaryManager::UpdateFight, this), 1/*interval / 2*/, offset + 1);
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CMilitaryManager::UpdateDefenceTasks, this), FRAMES_PER_SEC * 5, offset + 2);
+		scheduler->RunTaskEvery(MakeTask(&CMilitaryManager::UpdateIdle, this), interval, offset + 0);
+		scheduler->RunTaskEvery(MakeTask(&CMilitaryManager::UpdateFight, this), 1/*interval / 2*/, offset + 1);
+		scheduler->RunTaskEvery(MakeTask(&CMilitaryManager::UpdateDefenceTasks, this), FRAMES_PER_SEC * 5, offset + 2);
 
-		scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CMilitaryManager::Watchdog, this),
+		scheduler->RunTaskEvery(MakeTask(&CMilitaryManager::Watchdog, this),
 								FRAMES_PER_SEC * 60,
 								circuit->GetSkirmishAIId() * WATCHDOG_COUNT + 12);
 	};
@@ -1283,7 +1283,7 @@ void CMilitaryManager::MakeBaseDefence(const AIFloat3& pos)
 	}
 	buildDefence.push_back(std::make_pair(pos, baseDefence));
 	if (defend == nullptr) {
-		defend = std::make_shared<CGameTask>(&CMilitaryManager::UpdateDefence, this);
+		defend = MakeTask(&CMilitaryManager::UpdateDefence, this);
 		circuit->GetScheduler()->RunTaskEvery(defend, FRAMES_PER_SEC);
 	}
 }
@@ -1396,15 +1396,14 @@ IUnitTask* CMilitaryManager::DefaultMakeTask(CCircuitUnit* unit)
 void CMilitaryManager::Watchdog()
 {
 	SCOPED_TIME(circuit, __PRETTY_FUNCTION__);
+	const int frame = circuit->GetLastFrame();
 	for (CCircuitUnit* unit : army) {
-		if (unit->GetTask()->GetType() == IUnitTask::Type::PLAYER) {
+		if ((unit->GetTask()->GetType() == IUnitTask::Type::PLAYER) || !unit->IsIdleSuspect(frame)) {
 			continue;
 		}
-		auto commands = unit->GetUnit()->GetCurrentCommands();
-		if (commands.empty()) {
+		if (unit->IsCmdQueueEmpty()) {
 			UnitIdle(unit);
 		}
-		utils::free_clear(commands);
 	}
 }
 
@@ -123,7 +123,7 @@ CEnergyGrid::CEnergyGrid(CCircuitAI* circuit)
 		, toggleFrame(-1)
 #endif
 {
-	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CEnergyGrid::Init, this));
+	circuit->GetScheduler()->RunOnInit(MakeTask(&CEnergyGrid::Init, this));
 
 	for (CCircuitDef& cdef : circuit->GetCircuitDefs()) {
 		const std::map<std::string, std::string>& customParams = cdef.GetDef()->GetCustomParams();
@@ -116,8 +116,11 @@ void CMetalData::Clusterize(float maxDistance, CRagMatrix& distMatrix)
 {
 	// Clusterize metal spots by distance to each other
 	CHierarchCluster clust;
-	const CHierarchCluster::Clusters& iclusters = clust.Clusterize(distMatrix, maxDistance);
+	SetClusters(clust.Clusterize(distMatrix, maxDistance));
+}
 
+void CMetalData::SetClusters(const std::vector<MetalIndices>& iclusters)
+{
 	// Fill cluster structures, calculate centers
 	const int nclusters = iclusters.size();
 	clusterGraph.clear();
@@ -98,6 +98,10 @@ public:
 	 * Hierarchical clusterization. Not reusable. Metric: complete link. Thread-unsafe
 	 */
 	void Clusterize(float maxDistance, CRagMatrix& distmatrix);
+	/*
+	 * Fill clusters from spot indices, i.e. cached clusterization
+	 */
+	void SetClusters(const std::vector<MetalIndices>& iclusters);
 
 	const SMetal& operator[](int idx) const { return spots[idx]; }
 
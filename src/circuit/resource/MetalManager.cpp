@@ -9,19 +9,25 @@
 #include "map/ThreatMap.h"
 #include "module/EconomyManager.h"
 #include "terrain/TerrainManager.h"
+#include "terrain/TerrainData.h"
 #include "CircuitAI.h"
 #include "util/math/RagMatrix.h"
+#include "util/BinaryCache.h"
+#include "util/GameAttribute.h"
 #include "util/Scheduler.h"
 #include "util/Utils.h"
 
 #include "spring/SpringMap.h"
 
 #include "Game.h"
-#include "MoveData.h"
-#include "Pathing.h"
+
+#include <algorithm>
+#include <limits>
 
 namespace circuit {
 
+#define METAL_CACHE_VERSION	1
+
 using namespace springai;
 
 class CMetalManager::SafeCluster : public lemon::MapBase<ClusterGraph::Node, bool> {
@@ -74,7 +80,7 @@ CMetalManager::CMetalManager(CCircuitAI* circuit, CMetalData* metalData)
 		, filteredGraph(nullptr)
 		, shortPath(nullptr)
 {
-	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CMetalManager::Init, this));
+	circuit->GetScheduler()->RunOnInit(MakeTask(&CMetalManager::Init, this));
 
 	if (!metalData->IsInitialized()) {
 		// TODO: Add metal zone and no-metal-spots maps support
@@ -167,6 +173,62 @@ void CMetalManager::ParseMetalSpots()
 	metalData->Init(spots);
 }
 
+/*
+ * Bounded Dijkstra over sectors passable by mobile type, 8-connected, in sector units.
+ * Start sector is expanded even if impassable (spot on a cliff).
+ */
+static void SectorDistances(const std::vector<STerrainMapAreaSector>& sectors, int xSize, int zSize,
+		int startIdx, float maxDist, std::vector<float>& dist, std::vector<int>& touched)
+{
+	using Item = std::pair<float, int>;
+	static thread_local std::vector<Item> open;
+
+	for (int idx : touched) {
+		dist[idx] = std::numeric_limits<float>::max();
+	}
+	touched.clear();
+	if (dist.size() != sectors.size()) {
+		dist.assign(sectors.size(), std::numeric_limits<float>::max());
+	}
+
+	open.clear();
+	dist[startIdx] = 0.f;
+	touched.push_back(startIdx);
+	open.push_back({0.f, startIdx});
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<Item>());
+		const Item item = open.back();
+		open.pop_back();
+		if ((item.first > dist[item.second]) || (item.first > maxDist)) {
+			continue;
+		}
+		const int x = item.second % xSize;
+		const int z = item.second / xSize;
+		for (int dz = -1; dz <= 1; ++dz) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				const int nx = x + dx;
+				const int nz = z + dz;
+				if (((dx == 0) && (dz == 0)) || (nx < 0) || (nx >= xSize) || (nz < 0) || (nz >= zSize)) {
+					continue;
+				}
+				const int idx = nz * xSize + nx;
+				if (sectors[idx].area == nullptr) {
+					continue;
+				}
+				const float d = item.first + (((dx != 0) && (dz != 0)) ? SQRT_2 : 1.f);
+				if (d < dist[idx]) {
+					if (dist[idx] == std::numeric_limits<float>::max()) {
+						touched.push_back(idx);
+					}
+					dist[idx] = d;
+					open.push_back({d, idx});
+					std::push_heap(open.begin(), open.end(), std::greater<Item>());
+				}
+			}
+		}
+	}
+}
+
 void CMetalManager::ClusterizeMetal(CCircuitDef* commDef)
 {
 	metalData->SetClusterizing(true);
@@ -175,32 +237,103 @@ void CMetalManager::ClusterizeMetal(CCircuitDef* commDef)
 	const CMetalData::Metals& spots = metalData->GetSpots();
 	int nrows = spots.size();
 
+	/*
+	 * Cached clusters: key is the terrain, spots and commander's mobile type
+	 */
+	CTerrainManager* terrainMgr = circuit->GetTerrainManager();
+	uint64_t cacheKey = CBinaryCache::HashValue(circuit->GetGameAttribute()->GetTerrainData().GetCacheKey());
+	cacheKey = CBinaryCache::HashValue(maxDistance, cacheKey);
+	cacheKey = CBinaryCache::HashValue(terrainMgr->GetMobileTypeId(commDef->GetId()), cacheKey);
+	for (const CMetalData::SMetal& spot : spots) {
+		cacheKey = CBinaryCache::HashValue(spot.position.x, cacheKey);
+		cacheKey = CBinaryCache::HashValue(spot.position.z, cacheKey);
+	}
+	CBinaryCache cache(METAL_CACHE_VERSION, cacheKey);
+	std::string cachePath = CTerrainData::GetCachePath(circuit, "metal", false);
+	if (!cachePath.empty() && cache.Load(cachePath)) {
+		uint32_t nclusters = 0;
+		bool isValid = cache.Read(nclusters);
+		std::vector<CMetalData::MetalIndices> iclusters(isValid ? nclusters : 0);
+		for (CMetalData::MetalIndices& indices : iclusters) {
+			isValid = isValid && cache.Read(indices) && !indices.empty()
+					&& std::all_of(indices.begin(), indices.end(), [nrows](int idx) { return (idx >= 0) && (idx < nrows); });
+		}
+		if (isValid) {
+			circuit->LOG("Loading metal clusters from cache: %s", cachePath.c_str());
+			metalData->SetClusters(iclusters);
+			return;
+		}
+	}
+
 	CRagMatrix distmatrix(nrows);
-	if (nrows <= 300) {
-		MoveData* moveData = commDef->GetDef()->GetMoveData();
-		int pathType = moveData->GetPathType();
-		delete moveData;
-		Pathing* pathing = circuit->GetPathing();
-		for (int i = 1; i < nrows; i++) {
-			for (int j = 0; j < i; j++) {
-				float geomLength = spots[i].position.distance2D(spots[j].position);
-				if (geomLength > 4 * maxDistance) {
-					distmatrix(i, j) = geomLength;
-				} else {
-					float pathLength = pathing->GetApproximateLength(spots[i].position, spots[j].position, pathType, 0.0f);
-					distmatrix(i, j) = (geomLength * 1.4f < pathLength) ? pathLength : geomLength;
-				}
-			}
+	for (int i = 1; i < nrows; i++) {
+		for (int j = 0; j < i; j++) {
+			distmatrix(i, j) = spots[i].position.distance2D(spots[j].position);
 		}
-	} else {
-		for (int i = 1; i < nrows; i++) {
+	}
+
+	/*
+	 * Path-aware distances of close spots.
+	 * NOTE: Pathing callback is not thread-safe, sectors of commander's mobile type are used instead.
+	 */
+	STerrainMapMobileType* mobileType = terrainMgr->GetMobileType(commDef->GetId());
+	if ((mobileType != nullptr) && (nrows > 1)) {
+		const std::vector<STerrainMapAreaSector>& sectors = mobileType->sector;
+		const int xSize = terrainMgr->GetSectorXSize();
+		const int zSize = terrainMgr->GetSectorZSize();
+		const float convertStoP = terrainMgr->GetConvertStoP();
+		const float maxLength = 4 * maxDistance;
+		std::vector<int> spotSectors(nrows);
+		for (int i = 0; i < nrows; i++) {
+			const int x = utils::clamp(int(spots[i].position.x / convertStoP), 0, xSize - 1);
+			const int z = utils::clamp(int(spots[i].position.z / convertStoP), 0, zSize - 1);
+			spotSectors[i] = z * xSize + x;
+		}
+
+		circuit->GetScheduler()->RunParallelFor(nrows - 1, [&](int index) {
+			static thread_local std::vector<float> dist;
+			static thread_local std::vector<int> touched;
+			const int i = index + 1;
+			SectorDistances(sectors, xSize, zSize, spotSectors[i], maxLength / convertStoP + 2.f, dist, touched);
+
 			for (int j = 0; j < i; j++) {
-				distmatrix(i, j) = spots[i].position.distance2D(spots[j].position);
+				const float geomLength = distmatrix(i, j);
+				if (geomLength > maxLength) {
+					continue;
+				}
+				// Spot's sector may be impassable, take the best neighbour
+				const int x = spotSectors[j] % xSize;
+				const int z = spotSectors[j] / xSize;
+				float pathDist = dist[spotSectors[j]];
+				for (int nz = std::max(z - 1, 0); nz <= std::min(z + 1, zSize - 1); ++nz) {
+					for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, xSize - 1); ++nx) {
+						const float d = dist[nz * xSize + nx];
+						if (d < std::numeric_limits<float>::max()) {
+							pathDist = std::min(pathDist, d + (((nx != x) && (nz != z)) ? SQRT_2 : 1.f));
+						}
+					}
+				}
+				const float pathLength = (pathDist < std::numeric_limits<float>::max())
+						? std::min(pathDist * convertStoP, maxLength)
+						: maxLength;  // unreachable or beyond search bound
+				if (geomLength * 1.4f < pathLength) {
+					distmatrix(i, j) = pathLength;
+				}
 			}
-		}
+		});
 	}
 
 	metalData->Clusterize(maxDistance, distmatrix);
+
+	cachePath = CTerrainData::GetCachePath(circuit, "metal", true);
+	if (!cachePath.empty()) {
+		const CMetalData::Clusters& clusters = metalData->GetClusters();
+		cache.Write<uint32_t>(clusters.size());
+		for (const CMetalData::SCluster& cluster : clusters) {
+			cache.Write(cluster.idxSpots);
+		}
+		cache.Save(cachePath);
+	}
 }
 
 void CMetalManager::SetOpenSpot(int index, bool value)
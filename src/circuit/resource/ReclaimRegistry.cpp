@@ -0,0 +1,170 @@
+/*
+ * ReclaimRegistry.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#include "resource/ReclaimRegistry.h"
+#include "terrain/TerrainManager.h"
+#include "CircuitAI.h"
+#include "util/Profiler.h"
+#include "util/Utils.h"
+
+#include "spring/SpringCallback.h"
+
+namespace circuit {
+
+using namespace springai;
+
+CReclaimRegistry::CReclaimRegistry(CCircuitAI* circuit, int metalResId)
+		: circuit(circuit)
+		, metalResId(metalResId)
+		, updateNum(0)
+		, numFeatures(0)
+{
+	cellXSize = std::max((CTerrainManager::GetTerrainWidth() + RECLAIM_CELL - 1) / RECLAIM_CELL, 1);
+	cellZSize = std::max((CTerrainManager::GetTerrainHeight() + RECLAIM_CELL - 1) / RECLAIM_CELL, 1);
+	cells.resize(cellXSize * cellZSize);
+}
+
+CReclaimRegistry::~CReclaimRegistry()
+{
+}
+
+void CReclaimRegistry::Update()
+{
+	PROFILE_ZONE(__PRETTY_FUNCTION__);
+	COOAICallback* callback = circuit->GetCallback();
+	const int frame = circuit->GetLastFrame();
+	++updateNum;
+
+	// Mark
+	for (int featureId : callback->GetFeatureIds()) {
+		auto it = known.find(featureId);
+		if (it != known.end()) {
+			SKnown& info = it->second;
+			info.updateNum = updateNum;
+			if ((info.slot >= 0) && (frame - features[info.slot].frame < RECLAIM_SETTLE)) {
+				AIFloat3 pos = callback->Feature_GetPosition(featureId);
+				CTerrainManager::CorrectPosition(pos);  // Impulsed flying feature
+				Move(info.slot, pos);
+			}
+			continue;
+		}
+
+		const int defId = callback->Feature_GetDefId(featureId);
+		const float metal = GetDefMetal(defId);
+		int slot = -1;
+		if (metal >= 1.0f) {
+			AIFloat3 pos = callback->Feature_GetPosition(featureId);
+			CTerrainManager::CorrectPosition(pos);
+			slot = Insert(featureId, defId, pos, metal);
+			features[slot].frame = frame;
+		}
+		known[featureId] = {slot, updateNum};
+	}
+
+	// Sweep
+	for (auto it = known.begin(); it != known.end();) {
+		if (it->second.updateNum == updateNum) {
+			++it;
+			continue;
+		}
+		if (it->second.slot >= 0) {
+			Remove(it->second.slot);
+		}
+		it = known.erase(it);
+	}
+}
+
+const CReclaimRegistry::SFeature* CReclaimRegistry::Refresh(const SFeature* feature)
+{
+	COOAICallback* callback = circuit->GetCallback();
+	const int slot = feature - features.data();
+	if (callback->Feature_GetDefId(feature->featureId) != feature->defId) {
+		// Destroyed or id reused since last Update, next Update reads it as new
+		known.erase(feature->featureId);
+		Remove(slot);
+		return nullptr;
+	}
+	AIFloat3 pos = callback->Feature_GetPosition(feature->featureId);
+	CTerrainManager::CorrectPosition(pos);
+	Move(slot, pos);
+	return &features[slot];
+}
+
+float CReclaimRegistry::GetDefMetal(int featureDefId)
+{
+	auto it = defMetals.find(featureDefId);
+	if (it != defMetals.end()) {
+		return it->second;
+	}
+	COOAICallback* callback = circuit->GetCallback();
+	const float metal = callback->FeatureDef_IsReclaimable(featureDefId)
+			? callback->FeatureDef_GetContainedResource(featureDefId, metalResId)
+			: -1.f;
+	defMetals[featureDefId] = metal;
+	return metal;
+}
+
+int CReclaimRegistry::GetCell(const AIFloat3& pos) const
+{
+	const int x = utils::clamp(int(pos.x) / RECLAIM_CELL, 0, cellXSize - 1);
+	const int z = utils::clamp(int(pos.z) / RECLAIM_CELL, 0, cellZSize - 1);
+	return z * cellXSize + x;
+}
+
+int CReclaimRegistry::Insert(int featureId, int defId, const AIFloat3& pos, float metal)
+{
+	int slot;
+	if (freeSlots.empty()) {
+		slot = features.size();
+		features.emplace_back();
+	} else {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	SFeature& feature = features[slot];
+	feature.featureId = featureId;
+	feature.defId = defId;
+	feature.pos = pos;
+	feature.metal = metal;
+	feature.cell = GetCell(pos);
+	std::vector<int>& cell = cells[feature.cell];
+	feature.cellIdx = cell.size();
+	cell.push_back(slot);
+	++numFeatures;
+	return slot;
+}
+
+void CReclaimRegistry::Remove(int slot)
+{
+	SFeature& feature = features[slot];
+	std::vector<int>& cell = cells[feature.cell];
+	features[cell.back()].cellIdx = feature.cellIdx;
+	cell[feature.cellIdx] = cell.back();
+	cell.pop_back();
+	feature.featureId = -1;
+	freeSlots.push_back(slot);
+	--numFeatures;
+}
+
+void CReclaimRegistry::Move(int slot, const AIFloat3& pos)
+{
+	SFeature& feature = features[slot];
+	feature.pos = pos;
+	const int newCell = GetCell(pos);
+	if (newCell == feature.cell) {
+		return;
+	}
+	std::vector<int>& cell = cells[feature.cell];
+	features[cell.back()].cellIdx = feature.cellIdx;
+	cell[feature.cellIdx] = cell.back();
+	cell.pop_back();
+	feature.cell = newCell;
+	feature.cellIdx = cells[newCell].size();
+	cells[newCell].push_back(slot);
+}
+
+} // namespace circuit
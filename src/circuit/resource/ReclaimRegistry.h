@@ -0,0 +1,91 @@
+/*
+ * ReclaimRegistry.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_RESOURCE_RECLAIMREGISTRY_H_
+#define SRC_CIRCUIT_RESOURCE_RECLAIMREGISTRY_H_
+
+#include "AIFloat3.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#define RECLAIM_CELL	512  // elmos
+#define RECLAIM_SETTLE	150  // frames, impulsed wreck may still fly: re-read its position
+
+namespace circuit {
+
+class CCircuitAI;
+
+/*
+ * Reclaimable features with metal, synced incrementally by Update from feature id list.
+ * Def id is read only for new ids (def data cached per def), Refresh validates it before use:
+ * feature destroyed or id reused since last Update is dropped.
+ * Positions are re-read while feature settles and by Refresh, uniform grid of slots serves nearest queries.
+ */
+class CReclaimRegistry {
+public:
+	struct SFeature {
+		int featureId;
+		int defId;
+		springai::AIFloat3 pos;
+		float metal;
+		int frame;  // of discovery
+		int cell;
+		int cellIdx;
+	};
+
+	CReclaimRegistry(CCircuitAI* circuit, int metalResId);
+	virtual ~CReclaimRegistry();
+
+	void Update();
+	bool IsEmpty() const { return numFeatures == 0; }
+
+	/*
+	 * Nearest (2D) feature within maxRange that passes predicate.
+	 * Predicate is checked only for features closer than current best.
+	 */
+	template<typename P>
+	const SFeature* FindNearest(const springai::AIFloat3& pos, float maxRange, P&& pred);
+	/*
+	 * Re-read position of found feature (later impulses move wrecks too).
+	 * Returns nullptr and drops the feature if it's gone or its id got reused.
+	 */
+	const SFeature* Refresh(const SFeature* feature);
+
+private:
+	float GetDefMetal(int featureDefId);
+	int GetCell(const springai::AIFloat3& pos) const;
+	int Insert(int featureId, int defId, const springai::AIFloat3& pos, float metal);
+	void Remove(int slot);
+	void Move(int slot, const springai::AIFloat3& pos);
+
+	CCircuitAI* circuit;
+	int metalResId;
+	int updateNum;
+
+	struct SKnown {
+		int slot;  // -1: nothing to reclaim
+		int updateNum;
+	};
+	std::unordered_map<int, SKnown> known;  // featureId: SKnown
+	std::unordered_map<int, float> defMetals;  // featureDefId: metal, -1 if not reclaimable
+
+	std::vector<SFeature> features;
+	std::vector<int> freeSlots;
+	int numFeatures;
+
+	std::vector<std::vector<int>> cells;  // slots
+	int cellXSize;
+	int cellZSize;
+};
+
+} // namespace circuit
+
+#include "resource/ReclaimRegistry.hpp"
+
+#endif // SRC_CIRCUIT_RESOURCE_RECLAIMREGISTRY_H_
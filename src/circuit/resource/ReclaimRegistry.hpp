@@ -0,0 +1,64 @@
+/*
+ * ReclaimRegistry.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_RESOURCE_RECLAIMREGISTRY_H_
+#	error "Don't include this file directly, include ReclaimRegistry.h instead"
+#endif
+
+#include "resource/ReclaimRegistry.h"
+
+namespace circuit {
+
+template<typename P>
+const CReclaimRegistry::SFeature* CReclaimRegistry::FindNearest(const springai::AIFloat3& pos, float maxRange, P&& pred)
+{
+	if (numFeatures == 0) {
+		return nullptr;
+	}
+
+	const SFeature* best = nullptr;
+	float minSqDist = maxRange * maxRange;
+	const int cx = std::min(std::max(int(pos.x) / RECLAIM_CELL, 0), cellXSize - 1);
+	const int cz = std::min(std::max(int(pos.z) / RECLAIM_CELL, 0), cellZSize - 1);
+	const int maxRing = std::max(std::max(cx, cellXSize - 1 - cx), std::max(cz, cellZSize - 1 - cz));
+
+	auto visitCell = [&](int x, int z) {
+		for (int slot : cells[z * cellXSize + x]) {
+			const SFeature& feature = features[slot];
+			const float sqDist = pos.SqDistance2D(feature.pos);
+			if ((sqDist > minSqDist) || ((best != nullptr) && (sqDist == minSqDist)) || !pred(feature)) {
+				continue;
+			}
+			best = &feature;
+			minSqDist = sqDist;
+		}
+	};
+
+	for (int r = 0; r <= maxRing; ++r) {
+		// NOTE: Clamped coordinates keep the bound valid for positions out of map
+		const float bound = std::max(r - 1, 0) * RECLAIM_CELL;
+		if (bound * bound > minSqDist) {
+			break;
+		}
+		for (int dz = -r; dz <= r; ++dz) {
+			const int z = cz + dz;
+			if ((z < 0) || (z >= cellZSize)) {
+				continue;
+			}
+			const int step = ((dz == -r) || (dz == r)) ? 1 : std::max(2 * r, 1);
+			for (int dx = -r; dx <= r; dx += step) {
+				const int x = cx + dx;
+				if ((x >= 0) && (x < cellXSize)) {
+					visitCell(x, z);
+				}
+			}
+		}
+	}
+	return best;
+}
+
+} // namespace circuit
@@ -7,6 +7,7 @@
 
 #include "script/ScriptManager.h"
 #include "CircuitAI.h"
+#include "util/BinaryCache.h"
 #include "util/FileSystem.h"
 #include "util/Utils.h"
 
@@ -25,10 +26,39 @@
 #include "angelscript/add_on/scriptbuilder/scriptbuilder.h"
 #include "angelscript/add_on/aatc/aatc.hpp"
 
+#include <fstream>
+#include <iterator>
+
+#define SCRIPT_CACHE_VERSION	1
+
 namespace circuit {
 
 using namespace springai;
 
+class CByteCodeStream: public asIBinaryStream {
+public:
+	CByteCodeStream(std::vector<char>& buffer) : buffer(buffer), pos(0) {}
+	virtual ~CByteCodeStream() {}
+
+	virtual int Read(void* ptr, asUINT size) override {
+		if (size > buffer.size() - pos) {
+			return asERROR;
+		}
+		memcpy(ptr, buffer.data() + pos, size);
+		pos += size;
+		return asSUCCESS;
+	}
+	virtual int Write(const void* ptr, asUINT size) override {
+		const char* src = static_cast<const char*>(ptr);
+		buffer.insert(buffer.end(), src, src + size);
+		return asSUCCESS;
+	}
+
+private:
+	std::vector<char>& buffer;
+	size_t pos;
+};
+
 CScriptManager::CScriptManager(CCircuitAI* circuit)
 		: circuit(circuit)
 		, engine(nullptr)
@@ -120,37 +150,37 @@ void CScriptManager::Release()
 
 bool CScriptManager::Load(const char* modname, const char* filename)
 {
-	// The CScriptBuilder helper is an add-on that loads the file,
-	// performs a pre-processing pass if necessary, and then tells
-	// the engine to build a script module.
-	CScriptBuilder builder;
-	int r = builder.StartNewModule(engine, modname);
-	if (r < 0) {
-		// If the code fails here it is usually because there
-		// is no more memory to allocate the module
-		circuit->LOG("Script: Unrecoverable error while starting a new module!");
+	std::string dirname = "script" SLASH;
+	if (!LocatePath(dirname)) {
 		return false;
 	}
+	const std::string path = dirname + filename;
 
-	std::string dirname = "script" SLASH;
-	if (!LocatePath(dirname)) {
+	CScriptBuilder builder;
+	if (!AddSections(builder, modname, path)) {
 		return false;
 	}
 
-	r = builder.AddSectionFromFile((dirname + filename).c_str());
-	if (r < 0) {
-		// The builder wasn't able to load the string. Maybe some
-		// preprocessing commands are incorrectly written.
-		circuit->LOG("Script: Unable to add section!");
+	/*
+	 * Bytecode cache: key is the content of all included sections.
+	 * Every next AI instance (and game) with the same scripts skips compilation.
+	 */
+	const uint64_t cacheKey = GetCacheKey(builder);
+	if (LoadByteCode(modname, cacheKey)) {
+		return true;
+	}
+	if (!AddSections(builder, modname, path)) {  // module could be discarded by failed load
 		return false;
 	}
-	r = builder.BuildModule();
+
+	int r = builder.BuildModule();
 	if (r < 0) {
 		// An error occurred. Instruct the script writer to fix the
 		// compilation errors that were listed in the output stream.
 		circuit->LOG("Script: Fix compilation errors!");
 		return false;
 	}
+	SaveByteCode(builder.GetModule(), cacheKey);
 	return true;
 }
 
@@ -181,7 +211,7 @@ void CScriptManager::ReturnContext(asIScriptContext* ctx)
 
 bool CScriptManager::Exec(asIScriptContext* ctx)
 {
-	SCOPED_TIME(circuit, std::string(ctx->GetFunction()->GetNamespace()) + "::" + ctx->GetFunction()->GetName());
+	SCOPED_TIME_NT(st, circuit, std::string(ctx->GetFunction()->GetNamespace()) + "::" + ctx->GetFunction()->GetName(), 10);
 
 	int r = ctx->Execute();
 	if (r != asEXECUTION_FINISHED) {
@@ -244,4 +274,88 @@ bool CScriptManager::LocatePath(std::string& dirname)
 	return located;
 }
 
+bool CScriptManager::AddSections(CScriptBuilder& builder, const char* modname, const std::string& filename)
+{
+	// The CScriptBuilder helper is an add-on that loads the file,
+	// performs a pre-processing pass if necessary, and then tells
+	// the engine to build a script module.
+	int r = builder.StartNewModule(engine, modname);
+	if (r < 0) {
+		// If the code fails here it is usually because there
+		// is no more memory to allocate the module
+		circuit->LOG("Script: Unrecoverable error while starting a new module!");
+		return false;
+	}
+	r = builder.AddSectionFromFile(filename.c_str());
+	if (r < 0) {
+		// The builder wasn't able to load the string. Maybe some
+		// preprocessing commands are incorrectly written.
+		circuit->LOG("Script: Unable to add section!");
+		return false;
+	}
+	return true;
+}
+
+uint64_t CScriptManager::GetCacheKey(CScriptBuilder& builder) const
+{
+	uint64_t cacheKey = CBinaryCache::HashValue(ANGELSCRIPT_VERSION);
+	cacheKey = CBinaryCache::HashValue(sizeof(void*), cacheKey);
+	cacheKey = CBinaryCache::HashValue(jit != nullptr, cacheKey);
+	std::vector<char> content;
+	for (unsigned i = 0; i < builder.GetSectionCount(); ++i) {
+		std::ifstream is(builder.GetSectionName(i), std::ios::binary);
+		content.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+		cacheKey = CBinaryCache::HashVector(content, cacheKey);
+	}
+	return cacheKey;
+}
+
+std::string CScriptManager::GetCachePath(const char* modname, bool writable) const
+{
+	std::string filename = std::string("cache" SLASH "script_") + modname + ".bin";
+	DataDirs* datadirs = circuit->GetCallback()->GetDataDirs();
+	const bool located = utils::LocatePath(datadirs, filename, writable);
+	delete datadirs;
+	return located ? filename : "";
+}
+
+bool CScriptManager::LoadByteCode(const char* modname, uint64_t cacheKey)
+{
+	CBinaryCache cache(SCRIPT_CACHE_VERSION, cacheKey);
+	const std::string cachePath = GetCachePath(modname, false);
+	std::vector<char> byteCode;
+	if (cachePath.empty() || !cache.Load(cachePath) || !cache.Read(byteCode)) {
+		return false;
+	}
+
+	// NOTE: Registered interface is checked by engine, mismatch fails the load
+	asIScriptModule* mod = engine->GetModule(modname, asGM_ALWAYS_CREATE);
+	CByteCodeStream stream(byteCode);
+	if (mod->LoadByteCode(&stream) < 0) {
+		circuit->LOG("Script: Stale bytecode cache: %s", cachePath.c_str());
+		mod->Discard();
+		return false;
+	}
+	circuit->LOG("Script: Loading '%s' from cache: %s", modname, cachePath.c_str());
+	return true;
+}
+
+void CScriptManager::SaveByteCode(asIScriptModule* mod, uint64_t cacheKey)
+{
+	const std::string cachePath = GetCachePath(mod->GetName(), true);
+	if (cachePath.empty()) {
+		return;
+	}
+	std::vector<char> byteCode;
+	CByteCodeStream stream(byteCode);
+	if (mod->SaveByteCode(&stream) < 0) {  // with debug info: line numbers of exceptions
+		return;
+	}
+	CBinaryCache cache(SCRIPT_CACHE_VERSION, cacheKey);
+	cache.Write(byteCode);
+	if (!cache.Save(cachePath)) {
+		circuit->LOG("Script: Failed to save bytecode cache: %s", cachePath.c_str());
+	}
+}
+
 } // namespace circuit
@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 class asIScriptEngine;
 class asIScriptModule;
@@ -17,6 +18,7 @@ class asIScriptFunction;
 class asIScriptContext;
 class asSMessageInfo;
 class asCJITCompiler;
+class CScriptBuilder;
 
 namespace circuit {
 
@@ -53,6 +55,12 @@ private:
 	void MessageCallback(const asSMessageInfo *msg, void *param);
 
 	bool LocatePath(std::string& filename);
+
+	bool AddSections(CScriptBuilder& builder, const char* modname, const std::string& filename);
+	uint64_t GetCacheKey(CScriptBuilder& builder) const;
+	std::string GetCachePath(const char* modname, bool writable) const;
+	bool LoadByteCode(const char* modname, uint64_t cacheKey);
+	void SaveByteCode(asIScriptModule* mod, uint64_t cacheKey);
 };
 
 } // namespace circuit
@@ -27,7 +27,7 @@ using namespace springai;
 CDefenceMatrix::CDefenceMatrix(CCircuitAI* circuit)
 		: metalManager(nullptr)
 {
-	circuit->GetScheduler()->RunOnInit(std::make_shared<CGameTask>(&CDefenceMatrix::Init, this, circuit));
+	circuit->GetScheduler()->RunOnInit(MakeTask(&CDefenceMatrix::Init, this, circuit));
 
 	ReadConfig(circuit);
 }
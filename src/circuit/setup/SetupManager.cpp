@@ -52,7 +52,7 @@ CSetupManager::CSetupManager(CCircuitAI* circuit, CSetupData* setupData)
 	}
 	DisabledUnits(setupScript);
 
-	findStart = std::make_shared<CGameTask>(&CSetupManager::FindStart, this);
+	findStart = MakeTask(&CSetupManager::FindStart, this);
 	circuit->GetScheduler()->RunTaskEvery(findStart, 1);
 }
 
@@ -508,7 +508,7 @@ void CSetupManager::FindStart()
 			func(startPos);
 		}
 
-		circuit->GetScheduler()->RunTaskAfter(std::make_shared<CGameTask>(&CSetupManager::CalcLanePos, this), FRAMES_PER_SEC);
+		circuit->GetScheduler()->RunTaskAfter(MakeTask(&CSetupManager::CalcLanePos, this), FRAMES_PER_SEC);
 		return;
 	}
 
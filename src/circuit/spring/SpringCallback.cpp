@@ -47,6 +47,14 @@ std::vector<Unit*> COOAICallback::GetFriendlyUnits()
 	return units;
 }
 
+const std::vector<int>& COOAICallback::GetFriendlyUnitIds()
+{
+	unitIds.resize(MAX_UNITS);
+	int size = sAICallback->getFriendlyUnits(skirmishAIId, unitIds.data(), MAX_UNITS);
+	unitIds.resize(size);
+	return unitIds;
+}
+
 std::vector<Unit*> COOAICallback::GetFriendlyUnitsIn(const AIFloat3& pos, float radius, bool spherical)
 {
 	float pos_posF3[3];
@@ -118,6 +126,14 @@ std::vector<int> COOAICallback::GetEnemyUnitIdsIn(const AIFloat3& pos, float rad
 	return unitIds;
 }
 
+const std::vector<int>& COOAICallback::GetFeatureIds()
+{
+	featureIds.resize(sAICallback->getFeatures(skirmishAIId, nullptr, -1));
+	int size = sAICallback->getFeatures(skirmishAIId, featureIds.data(), featureIds.size());
+	featureIds.resize(size);
+	return featureIds;
+}
+
 bool COOAICallback::IsFeatures() const
 {
 	int size = sAICallback->getFeatures(skirmishAIId, nullptr, -1);
@@ -132,14 +148,46 @@ bool COOAICallback::IsFeaturesIn(const AIFloat3& pos, float radius, bool spheric
 	return size > 0;
 }
 
+Unit* COOAICallback::GetUnit(int unitId) const
+{
+	return WrappUnit::GetInstance(skirmishAIId, unitId);
+}
+
 int COOAICallback::Unit_GetDefId(int unitId) const
 {
 	return sAICallback->Unit_getDef(skirmishAIId, unitId);
 }
 
+int COOAICallback::Unit_GetCommandCount(int unitId) const
+{
+	return sAICallback->Unit_getCurrentCommands(skirmishAIId, unitId);
+}
+
 bool COOAICallback::UnitDef_HasYardMap(int unitDefId) const
 {
 	return sAICallback->UnitDef_getYardMap(skirmishAIId, unitDefId, UNIT_FACING_SOUTH, nullptr, -1) > 0;
 }
 
+AIFloat3 COOAICallback::Feature_GetPosition(int featureId) const
+{
+	float pos_posF3[3];
+	sAICallback->Feature_getPosition(skirmishAIId, featureId, pos_posF3);
+	return AIFloat3(pos_posF3[0], pos_posF3[1], pos_posF3[2]);
+}
+
+int COOAICallback::Feature_GetDefId(int featureId) const
+{
+	return sAICallback->Feature_getDef(skirmishAIId, featureId);
+}
+
+bool COOAICallback::FeatureDef_IsReclaimable(int featureDefId) const
+{
+	return sAICallback->FeatureDef_isReclaimable(skirmishAIId, featureDefId);
+}
+
+float COOAICallback::FeatureDef_GetContainedResource(int featureDefId, int resourceId) const
+{
+	return sAICallback->FeatureDef_getContainedResource(skirmishAIId, featureDefId, resourceId);
+}
+
 } // namespace circuit
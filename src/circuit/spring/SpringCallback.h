@@ -37,6 +37,7 @@ public:
 	std::vector<springai::Unit*> GetTeamUnits() const { return callback->GetTeamUnits(); }
 
 	std::vector<springai::Unit*> GetFriendlyUnits();
+	const std::vector<int>& GetFriendlyUnitIds();  // valid until next call
 	std::vector<springai::Unit*> GetFriendlyUnitsIn(const springai::AIFloat3& pos, float radius, bool spherical = true);
 	bool IsFriendlyUnitsIn(const springai::AIFloat3& pos, float radius, bool spherical = true) const;
 	std::vector<int> GetFriendlyUnitIdsIn(const springai::AIFloat3& pos, float radius, bool spherical = true);
@@ -54,13 +55,21 @@ public:
 	std::vector<springai::Feature*> GetFeaturesIn(const springai::AIFloat3& pos, float radius, bool spherical = true) const {
 		return callback->GetFeaturesIn(pos, radius, spherical);
 	}
+	const std::vector<int>& GetFeatureIds();  // valid until next call
 	bool IsFeatures() const;
 	bool IsFeaturesIn(const springai::AIFloat3& pos, float radius, bool spherical = true) const;
 
+	springai::Unit* GetUnit(int unitId) const;
 	int Unit_GetDefId(int unitId) const;
+	int Unit_GetCommandCount(int unitId) const;
 
 	bool UnitDef_HasYardMap(int unitDefId) const;
 
+	springai::AIFloat3 Feature_GetPosition(int featureId) const;
+	int Feature_GetDefId(int featureId) const;
+	bool FeatureDef_IsReclaimable(int featureDefId) const;
+	float FeatureDef_GetContainedResource(int featureDefId, int resourceId) const;
+
 private:
 	const struct SSkirmishAICallback* sAICallback;
 	springai::OOAICallback* callback;
@@ -68,6 +77,7 @@ private:
 
 	std::vector<int> unitIds;
 	std::vector<springai::Unit*> units;
+	std::vector<int> featureIds;
 };
 
 } // namespace circuit
@@ -238,7 +238,7 @@ void CRetreatTask::OnUnitIdle(CCircuitUnit* unit)
 		pos = terrainMgr->FindBuildSite(cdef, pos, maxDist, UNIT_COMMAND_BUILD_NO_FACING, predicate);
 		TRY_UNIT(circuit, unit,
 //			unit->CmdPriority(0);
-			unit->GetUnit()->PatrolTo(pos);
+			unit->CmdPatrolTo(pos);
 		)
 
 		if (unit->GetTravelAct() != nullptr) {
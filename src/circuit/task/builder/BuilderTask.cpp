@@ -191,7 +191,7 @@ void IBuilderTask::Execute(CCircuitUnit* unit)
 	const int frame = circuit->GetLastFrame();
 	if (target != nullptr) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Repair(target->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
+			unit->CmdRepair(target->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
 		)
 		return;
 	}
@@ -200,7 +200,7 @@ void IBuilderTask::Execute(CCircuitUnit* unit)
 	if (utils::is_valid(buildPos)) {
 		if (circuit->GetMap()->IsPossibleToBuildAt(buildUDef, buildPos, facing)) {
 			TRY_UNIT(circuit, unit,
-				unit->GetUnit()->Build(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
+				unit->CmdBuild(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
 			)
 			return;
 		}
@@ -216,7 +216,7 @@ void IBuilderTask::Execute(CCircuitUnit* unit)
 		utils::free_clear(friendlies);
 		if (alu != nullptr) {
 			TRY_UNIT(circuit, unit,
-				unit->GetUnit()->Repair(alu->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
+				unit->CmdRepair(alu->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
 			)
 			return;
 		}
@@ -231,7 +231,7 @@ void IBuilderTask::Execute(CCircuitUnit* unit)
 
 	if (utils::is_valid(buildPos)) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Build(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
+			unit->CmdBuild(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
 		)
 	} else {
 		// TODO: Select new proper BasePos, like near metal cluster.
@@ -342,7 +342,7 @@ void IBuilderTask::UpdateTarget(CCircuitUnit* unit)
 	int frame = circuit->GetLastFrame() + FRAMES_PER_SEC * 60;
 	for (CCircuitUnit* ass : units) {
 		TRY_UNIT(circuit, ass,
-			ass->GetUnit()->Repair(unit->GetUnit(), UNIT_CMD_OPTION, frame);
+			ass->CmdRepair(unit->GetUnit(), UNIT_CMD_OPTION, frame);
 		)
 	}
 }
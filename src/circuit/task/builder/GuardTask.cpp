@@ -62,7 +62,7 @@ void CBGuardTask::Execute(CCircuitUnit* unit)
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
 			unit->CmdPriority(ClampPriority());
-			unit->GetUnit()->Guard(vip->GetUnit());
+			unit->CmdGuard(vip->GetUnit());
 		)
 	} else {
 		manager->AbortTask(this);
@@ -75,7 +75,7 @@ void CBGuardTask::OnUnitIdle(CCircuitUnit* unit)
 	CCircuitUnit* vip = circuit->GetTeamUnit(vipId);
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Guard(vip->GetUnit());
+			unit->CmdGuard(vip->GetUnit());
 		)
 	} else {
 		manager->AbortTask(this);
@@ -76,7 +76,7 @@ void CBMexTask::Execute(CCircuitUnit* unit)
 	const int frame = circuit->GetLastFrame();
 	if (target != nullptr) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Repair(target->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
+			unit->CmdRepair(target->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
 		)
 		return;
 	}
@@ -91,7 +91,7 @@ void CBMexTask::Execute(CCircuitUnit* unit)
 					state = State::ENGAGE;  // isFirstTry = false
 					metalMgr->SetOpenSpot(index, false);
 					TRY_UNIT(circuit, unit,
-						unit->GetUnit()->Build(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
+						unit->CmdBuild(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
 					)
 					return;
 				} else {
@@ -122,7 +122,7 @@ void CBMexTask::Execute(CCircuitUnit* unit)
 		SetBuildPos(spots[index].position);
 		economyMgr->SetOpenSpot(index, false);
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Build(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
+			unit->CmdBuild(buildUDef, buildPos, facing, 0, frame + FRAMES_PER_SEC * 60);
 		)
 	} else {
 //		buildPos = -RgtVector;
@@ -82,7 +82,7 @@ void CBPatrolTask::Execute(CCircuitUnit* unit)
 		AIFloat3 pos = position;
 		pos.x += (pos.x > terrainMgr->GetTerrainWidth() / 2) ? -size : size;
 		pos.z += (pos.z > terrainMgr->GetTerrainHeight() / 2) ? -size : size;
-		unit->GetUnit()->PatrolTo(pos);
+		unit->CmdPatrolTo(pos);
 	)
 }
 
@@ -70,7 +70,7 @@ bool CBReclaimTask::Reevaluate(CCircuitUnit* unit)
 			for (Unit* enemy : enemies) {
 				if ((enemy != nullptr) && enemy->IsBeingBuilt()) {
 					TRY_UNIT(circuit, unit,
-						unit->GetUnit()->ReclaimUnit(enemy, UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
+						unit->CmdReclaimUnit(enemy, UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
 					)
 					utils::free_clear(enemies);
 					return false;
@@ -72,7 +72,7 @@ void IReclaimTask::Execute(CCircuitUnit* unit)
 	const int frame = circuit->GetLastFrame();
 	if (target != nullptr) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->ReclaimUnit(target->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
+			unit->CmdReclaimUnit(target->GetUnit(), UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
 		)
 		return;
 	}
@@ -90,7 +90,7 @@ void IReclaimTask::Execute(CCircuitUnit* unit)
 		reclRadius = radius;
 	}
 	TRY_UNIT(circuit, unit,
-		unit->GetUnit()->ReclaimInArea(pos, reclRadius, UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
+		unit->CmdReclaimInArea(pos, reclRadius, UNIT_CMD_OPTION, frame + FRAMES_PER_SEC * 60);
 	)
 }
 
@@ -15,6 +15,7 @@
 #include "terrain/path/QueryPathSingle.h"
 #include "terrain/path/QueryPathMulti.h"
 #include "unit/action/MoveAction.h"
+#include "unit/enemy/EnemyIndex.h"
 #include "unit/enemy/EnemyUnit.h"
 #include "unit/CircuitUnit.h"
 #include "CircuitAI.h"
@@ -132,7 +133,7 @@ void CAntiAirTask::Update()
 			int frame = circuit->GetLastFrame() + FRAMES_PER_SEC * 60;
 			for (CCircuitUnit* unit : units) {
 				TRY_UNIT(circuit, unit,
-					unit->GetUnit()->Fight(groupPos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame);
+					unit->CmdFight(groupPos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame);
 				)
 				unit->GetTravelAct()->StateWait();
 			}
@@ -260,35 +261,25 @@ void CAntiAirTask::FindTarget()
 	const int noChaseCat = cdef->GetNoChaseCategory();
 	const float maxPower = attackPower * powerMod;
 
-	CEnemyInfo* bestTarget = nullptr;
-	float minSqDist = std::numeric_limits<float>::max();
-
 	threatMap->SetThreatType(leader);
-	const CCircuitAI::EnemyInfos& enemies = circuit->GetEnemyInfos();
-	for (auto& kv : enemies) {
-		CEnemyInfo* enemy = kv.second;
-		if (enemy->IsHidden() ||
-			(maxPower <= threatMap->GetThreatAt(enemy->GetPos()) - enemy->GetThreat()) ||
-			!terrainMgr->CanMoveToPos(area, enemy->GetPos()))
-		{
-			continue;
+	const CEnemyIndex::SEntry* best = circuit->GetEnemyIndex()->FindNearest(pos, std::numeric_limits<float>::max(),
+			[&](const CEnemyIndex::SEntry& entry) {
+		CEnemyInfo* enemy = entry.enemy;
+		if (enemy->IsHidden()) {
+			return false;
 		}
-
 		CCircuitDef* edef = enemy->GetCircuitDef();
 		if (edef != nullptr) {
 			if (((edef->GetCategory() & canTargetCat) == 0)
 				|| ((edef->GetCategory() & noChaseCat) != 0))
 			{
-				continue;
+				return false;
 			}
 		}
-
-		const float sqDist = pos.SqDistance2D(enemy->GetPos());
-		if (minSqDist > sqDist) {
-			minSqDist = sqDist;
-			bestTarget = enemy;
-		}
-	}
+		return (maxPower > threatMap->GetThreatAt(entry.pos) - enemy->GetThreat())
+			&& terrainMgr->CanMoveToPos(area, entry.pos);
+	});
+	CEnemyInfo* bestTarget = (best != nullptr) ? best->enemy : nullptr;
 
 	SetTarget(bestTarget);
 	if (bestTarget != nullptr) {
@@ -414,7 +405,7 @@ void CAntiAirTask::Fallback()
 	const int frame = circuit->GetLastFrame();
 	for (CCircuitUnit* unit : units) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+			unit->CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 		)
 		unit->GetTravelAct()->StateWait();
 	}
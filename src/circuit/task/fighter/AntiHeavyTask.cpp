@@ -17,6 +17,7 @@
 #include "unit/action/DGunAction.h"
 #include "unit/action/MoveAction.h"
 #include "unit/action/FightAction.h"
+#include "unit/enemy/EnemyIndex.h"
 #include "unit/enemy/EnemyUnit.h"
 #include "unit/CircuitUnit.h"
 #include "CircuitAI.h"
@@ -151,7 +152,7 @@ void CAntiHeavyTask::Update()
 			int frame = circuit->GetLastFrame() + FRAMES_PER_SEC * 60;
 			for (CCircuitUnit* unit : units) {
 				TRY_UNIT(circuit, unit,
-					unit->GetUnit()->Fight(groupPos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame);
+					unit->CmdFight(groupPos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame);
 				)
 				unit->GetTravelAct()->StateWait();
 			}
@@ -292,7 +293,6 @@ void CAntiHeavyTask::OnUnitDamaged(CCircuitUnit* unit, CEnemyInfo* attacker)
 bool CAntiHeavyTask::FindTarget()
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CMap* map = circuit->GetMap();
 	CTerrainManager* terrainMgr = circuit->GetTerrainManager();
 	CThreatMap* threatMap = circuit->GetThreatMap();
 	const AIFloat3& pos = leader->GetPos(circuit->GetLastFrame());
@@ -304,46 +304,46 @@ bool CAntiHeavyTask::FindTarget()
 	const float weaponRange = cdef->GetMaxRange();
 	const float range = std::max(highestRange, threatMap->GetSquareSize() * 2.0f);
 	const float losSqDist = SQUARE(range);
-	float minSqDist = losSqDist;
 
-	CEnemyInfo* bestTarget = nullptr;
 	enemyPositions.clear();
 	threatMap->SetThreatType(leader);
-	const CCircuitAI::EnemyInfos& enemies = circuit->GetEnemyInfos();
-	for (auto& kv : enemies) {
-		CEnemyInfo* enemy = kv.second;
+	auto isValid = [&](const CEnemyIndex::SEntry& entry) {
+		CEnemyInfo* enemy = entry.enemy;
 		if (enemy->IsHidden()) {
-			continue;
+			return false;
 		}
 		const AIFloat3& ePos = enemy->GetPos();
 		if ((maxPower <= threatMap->GetThreatAt(ePos) - enemy->GetThreat())
 			|| !terrainMgr->CanMoveToPos(area, ePos))
 		{
-			continue;
+			return false;
 		}
 
 		CCircuitDef* edef = enemy->GetCircuitDef();
 		if ((edef == nullptr) || !edef->IsEnemyRoleAny(CCircuitDef::RoleMask::HEAVY | CCircuitDef::RoleMask::COMM)
 			|| ((edef->GetCategory() & canTargetCat) == 0)
 			|| (edef->IsAbleToFly() && notAA)
-			|| (ePos.y - map->GetElevationAt(ePos.x, ePos.z) > weaponRange))
+			|| (ePos.y - entry.elevation > weaponRange))
 		{
-			continue;
+			return false;
 		}
+		return true;
+	};
 
-		const float sqDist = pos.SqDistance2D(ePos);
-		if (minSqDist > sqDist) {
-			minSqDist = sqDist;
-			bestTarget = enemy;
-		} else if (losSqDist <= sqDist) {
-			enemyPositions.push_back(ePos);
-		}
-	}
-
-	SetTarget(bestTarget);
-	if (bestTarget != nullptr) {
+	// Target is the nearest within range, positions matter only without target
+	CEnemyIndex* enemyIndex = circuit->GetEnemyIndex();
+	const CEnemyIndex::SEntry* nearest = enemyIndex->FindNearest(pos, range, isValid);
+	if ((nearest != nullptr) && (pos.SqDistance2D(nearest->pos) < losSqDist)) {
+		SetTarget(nearest->enemy);
 		return true;
 	}
+	SetTarget(nullptr);
+
+	enemyIndex->ForEach([&](const CEnemyIndex::SEntry& entry) {
+		if ((losSqDist <= pos.SqDistance2D(entry.pos)) && isValid(entry)) {
+			enemyPositions.push_back(entry.pos);
+		}
+	});
 	if (enemyPositions.empty()) {
 		return false;
 	}
@@ -514,7 +514,7 @@ void CAntiHeavyTask::FallbackCommPos()
 	position = circuit->GetSetupManager()->GetBasePos();
 	for (CCircuitUnit* unit : units) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+			unit->CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 		)
 		unit->GetTravelAct()->StateWait();
 	}
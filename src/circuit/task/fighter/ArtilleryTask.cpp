@@ -97,7 +97,7 @@ void CArtilleryTask::Execute(CCircuitUnit* unit, bool isUpdating)
 
 	if (bestTarget != nullptr) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Attack(bestTarget->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+			unit->CmdAttack(bestTarget->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 			unit->CmdSetTarget(bestTarget);
 		)
 		unit->GetTravelAct()->StateWait();
@@ -369,7 +369,7 @@ void CArtilleryTask::Fallback(CCircuitUnit* unit, bool proceed)
 	position = AIFloat3(x, circuit->GetMap()->GetElevationAt(x, z), z);
 	position = terrainMgr->GetMovePosition(unit->GetArea(), position);
 	TRY_UNIT(circuit, unit,
-		unit->GetUnit()->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+		unit->CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 	)
 	unit->GetTravelAct()->StateWait();
 }
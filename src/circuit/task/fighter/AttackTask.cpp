@@ -18,6 +18,7 @@
 #include "unit/action/FightAction.h"
 #include "unit/action/MoveAction.h"
 #include "unit/action/SupportAction.h"
+#include "unit/enemy/EnemyIndex.h"
 #include "unit/enemy/EnemyUnit.h"
 #include "unit/CircuitUnit.h"
 #include "CircuitAI.h"
@@ -241,7 +242,6 @@ void CAttackTask::OnUnitIdle(CCircuitUnit* unit)
 void CAttackTask::FindTarget()
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CMap* map = circuit->GetMap();
 	CTerrainManager* terrainMgr = circuit->GetTerrainManager();
 	CThreatMap* threatMap = circuit->GetThreatMap();
 	const AIFloat3& basePos = circuit->GetSetupManager()->GetBasePos();
@@ -256,29 +256,23 @@ void CAttackTask::FindTarget()
 	const int canTargetCat = cdef->GetTargetCategory();
 	const int noChaseCat = cdef->GetNoChaseCategory();
 
-	CEnemyInfo* bestTarget = nullptr;
 	const float sqOBDist = pos.SqDistance2D(basePos);  // Own to Base distance
-	float minSqDist = std::numeric_limits<float>::max();
 
 	SetTarget(nullptr);  // make adequate enemy->GetTasks().size()
 	threatMap->SetThreatType(leader);
-	const CCircuitAI::EnemyInfos& enemies = circuit->GetEnemyInfos();
-	for (auto& kv : enemies) {
-		CEnemyInfo* enemy = kv.second;
-		if (enemy->IsHidden() || (enemy->GetTasks().size() > 2)) {
-			continue;
-		}
-		const AIFloat3& ePos = enemy->GetPos();
+	auto getScale = [&basePos, sqOBDist](const AIFloat3& ePos) {
 		const float sqBEDist = ePos.SqDistance2D(basePos);  // Base to Enemy distance
-		const float scale = std::min(sqBEDist / sqOBDist, 1.f);
-		if ((maxPower <= threatMap->GetThreatAt(ePos) * scale)
-			|| !terrainMgr->CanMobileReachAt(area, ePos, highestRange))
-		{
-			continue;
+		return std::min(sqBEDist / sqOBDist, 1.f);
+	};
+	auto filter = [&](const CEnemyIndex::SEntry& entry) {
+		CEnemyInfo* enemy = entry.enemy;
+		if (enemy->IsHidden() || (enemy->GetTasks().size() > 2)) {
+			return false;
 		}
+		const AIFloat3& ePos = entry.pos;
 		const AIFloat3& eVel = enemy->GetVel();
 		if ((eVel.SqLength2D() >= maxSpeed) && (eVel.dot2D(pos - ePos) < 0)) {
-			continue;
+			return false;
 		}
 
 		CCircuitDef* edef = enemy->GetCircuitDef();
@@ -287,27 +281,34 @@ void CAttackTask::FindTarget()
 				|| ((edef->GetCategory() & noChaseCat) != 0)
 				|| (edef->IsAbleToFly() && notAA))
 			{
-				continue;
+				return false;
 			}
-			float elevation = map->GetElevationAt(ePos.x, ePos.z);
-			if ((notAW && !edef->IsYTargetable(elevation, ePos.y))
-				|| (ePos.y - elevation > weaponRange)
+			if ((notAW && !edef->IsYTargetable(entry.elevation, ePos.y))
+				|| (ePos.y - entry.elevation > weaponRange)
 				/*|| enemy->IsBeingBuilt()*/)
 			{
-				continue;
+				return false;
 			}
 		} else {
 			if (notAW && (ePos.y < -SQUARE_SIZE * 5)) {
-				continue;
+				return false;
 			}
 		}
-
-		const float sqOEDist = pos.SqDistance2D(ePos) * scale;  // Own to Enemy distance
-		if (minSqDist > sqOEDist) {
-			minSqDist = sqOEDist;
-			bestTarget = enemy;
-		}
-	}
+		return true;
+	};
+	auto score = [&](const CEnemyIndex::SEntry& entry) {
+		return pos.SqDistance2D(entry.pos) * getScale(entry.pos);  // Own to Enemy distance
+	};
+	auto check = [&](const CEnemyIndex::SEntry& entry) {
+		return (maxPower > threatMap->GetThreatAt(entry.pos) * getScale(entry.pos))
+			&& terrainMgr->CanMobileReachAt(area, entry.pos, highestRange);
+	};
+	auto cellScore = [&](const CEnemyIndex::SCellRect& rect) {
+		const float sqBEDist = rect.SqDistance2D(basePos);
+		return rect.SqDistance2D(pos) * std::min(sqBEDist / sqOBDist, 1.f);
+	};
+	const CEnemyIndex::SEntry* best = circuit->GetEnemyIndex()->FindBest(filter, score, cellScore, check);
+	CEnemyInfo* bestTarget = (best != nullptr) ? best->enemy : nullptr;
 
 	if (bestTarget != nullptr) {
 		SetTarget(bestTarget);
@@ -411,7 +412,7 @@ void CAttackTask::Fallback()
 	const int frame = circuit->GetLastFrame();
 	for (CCircuitUnit* unit : units) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+			unit->CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 			unit->CmdWantedSpeed(lowestSpeed);
 		)
 		unit->GetTravelAct()->StateWait();
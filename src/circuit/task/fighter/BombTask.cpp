@@ -106,7 +106,7 @@ void CBombTask::Execute(CCircuitUnit* unit, bool isUpdating)
 			if (target->GetUnit()->IsCloaked()) {
 				unit->CmdAttackGround(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 			} else if (lastTarget != target) {
-				unit->GetUnit()->Attack(target->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+				unit->CmdAttack(target->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 			}
 		)
 		unit->GetTravelAct()->StateWait();
@@ -471,7 +471,7 @@ void CBombTask::Fallback(CCircuitUnit* unit, bool proceed)
 	float z = rand() % terrainMgr->GetTerrainHeight();
 	position = AIFloat3(x, circuit->GetMap()->GetElevationAt(x, z), z);
 	TRY_UNIT(circuit, unit,
-		unit->GetUnit()->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+		unit->CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 	)
 	unit->GetTravelAct()->StateWait();
 }
@@ -18,6 +18,7 @@
 #include "unit/action/FightAction.h"
 #include "unit/action/MoveAction.h"
 #include "unit/action/SupportAction.h"
+#include "unit/enemy/EnemyIndex.h"
 #include "unit/enemy/EnemyUnit.h"
 #include "unit/CircuitUnit.h"
 #include "CircuitAI.h"
@@ -89,7 +90,7 @@ void CDefendTask::Start(CCircuitUnit* unit)
 	pos = terrainMgr->FindBuildSite(unit->GetCircuitDef(), pos, 300.0f, UNIT_COMMAND_BUILD_NO_FACING);
 
 	TRY_UNIT(circuit, unit,
-		unit->GetUnit()->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, circuit->GetLastFrame() + FRAMES_PER_SEC * 60);
+		unit->CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, circuit->GetLastFrame() + FRAMES_PER_SEC * 60);
 		unit->CmdWantedSpeed(NO_SPEED_LIMIT);
 	)
 }
@@ -204,7 +205,6 @@ void CDefendTask::Merge(ISquadTask* task)
 bool CDefendTask::FindTarget()
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CMap* map = circuit->GetMap();
 	CTerrainManager* terrainMgr = circuit->GetTerrainManager();
 	CThreatMap* threatMap = circuit->GetThreatMap();
 	CInfluenceMap* inflMap = circuit->GetInflMap();
@@ -228,18 +228,17 @@ bool CDefendTask::FindTarget()
 	SetTarget(nullptr);  // make adequate enemy->GetTasks().size()
 	enemyPositions.clear();
 	threatMap->SetThreatType(leader);
-	const CCircuitAI::EnemyInfos& enemies = circuit->GetEnemyInfos();
-	for (auto& kv : enemies) {
-		CEnemyInfo* enemy = kv.second;
+	auto isValid = [&](const CEnemyIndex::SEntry& entry) {
+		CEnemyInfo* enemy = entry.enemy;
 		if (enemy->IsHidden() || (enemy->GetTasks().size() > 2)) {
-			continue;
+			return false;
 		}
 
 		const AIFloat3& ePos = enemy->GetPos();
 		if ((inflMap->GetAllyDefendInflAt(ePos) < INFL_EPS)
 			|| !terrainMgr->CanMoveToPos(area, ePos))
 		{
-			continue;
+			return false;
 		}
 
 		const float sqEBDist = basePos.SqDistance2D(ePos);
@@ -248,7 +247,7 @@ bool CDefendTask::FindTarget()
 			checkPower *= 2.0f - 1.0f / baseRange * sqrtf(sqEBDist);  // 200% near base
 		}
 		if (checkPower <= threatMap->GetThreatAt(ePos)) {
-			continue;
+			return false;
 		}
 
 		CCircuitDef* edef = enemy->GetCircuitDef();
@@ -257,28 +256,49 @@ bool CDefendTask::FindTarget()
 				|| ((edef->GetCategory() & noChaseCat) != 0)
 				|| (edef->IsAbleToFly() && notAA))
 			{
-				continue;
+				return false;
 			}
-			float elevation = map->GetElevationAt(ePos.x, ePos.z);
+			float elevation = entry.elevation;
 			if ((notAW && !edef->IsYTargetable(elevation, ePos.y))
 				|| (ePos.y - elevation > weaponRange)
 				/*|| enemy->IsBeingBuilt()*/)
 			{
-				continue;
+				return false;
 			}
 		} else {
 			if (notAW && (ePos.y < -SQUARE_SIZE * 5)) {
-				continue;
+				return false;
 			}
 		}
 
+		return true;
+	};
+
+	/*
+	 * Nearest target close enough to engage doesn't need enemyPositions,
+	 * see Update: 300.f ~ slack
+	 */
+	CEnemyIndex* enemyIndex = circuit->GetEnemyIndex();
+	const float engageRange = highestRange + 300.f;
+	const CEnemyIndex::SEntry* nearest = enemyIndex->FindNearest(pos, engageRange, isValid);
+	if ((nearest != nullptr) && (pos.SqDistance2D(nearest->pos) < SQUARE(engageRange))) {
+		SetTarget(nearest->enemy);
+		position = target->GetPos();
+		return true;
+	}
+
+	enemyIndex->ForEach([&](const CEnemyIndex::SEntry& entry) {
+		if (!isValid(entry)) {
+			return;
+		}
+		const AIFloat3& ePos = entry.pos;
 		float sqDist = pos.SqDistance2D(ePos);
 		if (minSqDist > sqDist) {
 			minSqDist = sqDist;
-			bestTarget = enemy;
+			bestTarget = entry.enemy;
 		}
 		enemyPositions.push_back(ePos);
-	}
+	});
 
 	if (bestTarget != nullptr) {
 		SetTarget(bestTarget);
@@ -387,7 +407,7 @@ void CDefendTask::Fallback()
 	const int frame = circuit->GetLastFrame();
 	for (CCircuitUnit* unit : units) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+			unit->CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 			unit->CmdWantedSpeed(lowestSpeed);
 		)
 		unit->GetTravelAct()->StateWait();
@@ -36,7 +36,7 @@ void CFGuardTask::Start(CCircuitUnit* unit)
 	CCircuitUnit* vip = circuit->GetTeamUnit(vipId);
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Guard(vip->GetUnit());
+			unit->CmdGuard(vip->GetUnit());
 			unit->CmdWantedSpeed(NO_SPEED_LIMIT);
 		)
 	} else {
@@ -50,7 +50,7 @@ void CFGuardTask::OnUnitIdle(CCircuitUnit* unit)
 	CCircuitUnit* vip = circuit->GetTeamUnit(vipId);
 	if (vip != nullptr) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Guard(vip->GetUnit());
+			unit->CmdGuard(vip->GetUnit());
 		)
 	} else {
 		manager->AbortTask(this);
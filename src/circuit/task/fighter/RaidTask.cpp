@@ -17,6 +17,7 @@
 #include "terrain/path/QueryPathMulti.h"
 #include "unit/action/MoveAction.h"
 #include "unit/action/FightAction.h"
+#include "unit/enemy/EnemyIndex.h"
 #include "unit/enemy/EnemyUnit.h"
 #include "unit/CircuitUnit.h"
 #include "CircuitAI.h"
@@ -129,7 +130,7 @@ void CRaidTask::Update()
 				const AIFloat3& pos = utils::get_radial_pos(groupPos, SQUARE_SIZE * 8);
 				TRY_UNIT(circuit, unit,
 					unit->CmdMoveTo(groupPos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame);
-					unit->GetUnit()->PatrolTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, frame);
+					unit->CmdPatrolTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, frame);
 				)
 				unit->GetTravelAct()->StateWait();
 			}
@@ -174,7 +175,7 @@ void CRaidTask::Update()
 			} else {
 				for (CCircuitUnit* unit : units) {
 					TRY_UNIT(circuit, unit,
-						unit->GetUnit()->Attack(target->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+						unit->CmdAttack(target->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 						unit->CmdSetTarget(target);
 					)
 					unit->GetTravelAct()->StateWait();
@@ -239,7 +240,6 @@ void CRaidTask::OnUnitIdle(CCircuitUnit* unit)
 bool CRaidTask::FindTarget()
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CMap* map = circuit->GetMap();
 	CTerrainManager* terrainMgr = circuit->GetTerrainManager();
 	CThreatMap* threatMap = circuit->GetThreatMap();
 	CInfluenceMap* inflMap = circuit->GetInflMap();
@@ -270,11 +270,10 @@ bool CRaidTask::FindTarget()
 	urgentPositions.clear();
 	enemyPositions.clear();
 	threatMap->SetThreatType(leader);
-	const CCircuitAI::EnemyInfos& enemies = circuit->GetEnemyInfos();
-	for (auto& kv : enemies) {
-		CEnemyInfo* enemy = kv.second;
+	auto visit = [&](const CEnemyIndex::SEntry& entry) {
+		CEnemyInfo* enemy = entry.enemy;
 		if (enemy->IsHidden() || (enemy->GetTasks().size() > 2)) {
-			continue;
+			return;
 		}
 
 		const AIFloat3& ePos = enemy->GetPos();
@@ -282,7 +281,7 @@ bool CRaidTask::FindTarget()
 		if ((!isEnemyUrgent && !urgentPositions.empty())
 			|| !terrainMgr->CanMobileReachAt(area, ePos, highestRange))
 		{
-			continue;
+			return;
 		}
 
 		const float sqEBDist = basePos.SqDistance2D(ePos);
@@ -294,11 +293,11 @@ bool CRaidTask::FindTarget()
 		}
 		const float power = threatMap->GetThreatAt(ePos);
 		if (checkPower <= power) {
-			continue;
+			return;
 		}
 		const AIFloat3& eVel = enemy->GetVel();
 		if ((eVel.SqLength2D() >= checkSpeed) && (eVel.dot2D(pos - ePos) < 0)) {
-			continue;
+			return;
 		}
 
 		int targetCat;
@@ -310,19 +309,19 @@ bool CRaidTask::FindTarget()
 			if (((targetCat & canTargetCat) == 0)
 				|| (edef->IsAbleToFly() && notAA))
 			{
-				continue;
+				return;
 			}
-			float elevation = map->GetElevationAt(ePos.x, ePos.z);
+			float elevation = entry.elevation;
 			if ((notAW && !edef->IsYTargetable(elevation, ePos.y))
 				|| (ePos.y - elevation > weaponRange))
 			{
-				continue;
+				return;
 			}
 			defThreat = edef->GetPower();
 			isBuilder = edef->IsEnemyRoleAny(CCircuitDef::RoleMask::BUILDER | CCircuitDef::RoleMask::COMM);
 		} else {
 			if (notAW && (ePos.y < -SQUARE_SIZE * 5)) {
-				continue;
+				return;
 			}
 			targetCat = UNKNOWN_CATEGORY;
 			defThreat = enemy->GetThreat();
@@ -347,7 +346,7 @@ bool CRaidTask::FindTarget()
 					worstTarget = enemy;
 				}
 			}
-			continue;
+			return;
 		}
 
 		if (isEnemyUrgent) {
@@ -355,6 +354,18 @@ bool CRaidTask::FindTarget()
 		} else {
 			enemyPositions.push_back(ePos);
 		}
+	};
+	/*
+	 * Target is within range, positions matter only without target.
+	 * NOTE: Urgent enemies out of range filter the rest, defenders scan all.
+	 */
+	CEnemyIndex* enemyIndex = circuit->GetEnemyIndex();
+	if (!isDefender) {
+		enemyIndex->ForEachInRange(pos, range, visit);
+	}
+	if ((bestTarget == nullptr) && (worstTarget == nullptr)) {
+		enemyPositions.clear();
+		enemyIndex->ForEach(visit);
 	}
 	if (bestTarget == nullptr) {
 		bestTarget = worstTarget;
@@ -432,7 +443,7 @@ void CRaidTask::ApplyRaidPath(const CQueryPathSingle* query)
 	const int frame = circuit->GetLastFrame();
 	for (CCircuitUnit* unit : units) {
 		TRY_UNIT(circuit, unit,
-			unit->GetUnit()->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+			unit->CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 		)
 		unit->GetTravelAct()->StateWait();
 	}
@@ -15,6 +15,7 @@
 #include "terrain/path/QueryPathMulti.h"
 #include "unit/action/MoveAction.h"
 #include "unit/action/FightAction.h"
+#include "unit/enemy/EnemyIndex.h"
 #include "unit/enemy/EnemyUnit.h"
 #include "unit/CircuitUnit.h"
 #include "CircuitAI.h"
@@ -150,7 +151,6 @@ void CScoutTask::Execute(CCircuitUnit* unit, bool isUpdating)
 bool CScoutTask::FindTarget(CCircuitUnit* unit, const AIFloat3& pos)
 {
 	CCircuitAI* circuit = manager->GetCircuit();
-	CMap* map = circuit->GetMap();
 	CTerrainManager* terrainMgr = circuit->GetTerrainManager();
 	CThreatMap* threatMap = circuit->GetThreatMap();
 	STerrainMapArea* area = unit->GetArea();
@@ -173,11 +173,11 @@ bool CScoutTask::FindTarget(CCircuitUnit* unit, const AIFloat3& pos)
 	CEnemyInfo* worstTarget = nullptr;
 	enemyPositions.clear();
 	threatMap->SetThreatType(unit);
-	const CCircuitAI::EnemyInfos& enemies = circuit->GetEnemyInfos();
-	for (auto& kv : enemies) {
-		CEnemyInfo* enemy = kv.second;
+	// NOTE: Enemies beyond range and maxSqDist affect nothing
+	circuit->GetEnemyIndex()->ForEachInRange(pos, std::max(range, 1000.f), [&](const CEnemyIndex::SEntry& entry) {
+		CEnemyInfo* enemy = entry.enemy;
 		if (enemy->IsHidden() || (enemy->GetTasks().size() > 2)) {
-			continue;
+			return;
 		}
 		const AIFloat3& ePos = enemy->GetPos();
 		const float power = threatMap->GetThreatAt(ePos);
@@ -185,7 +185,7 @@ bool CScoutTask::FindTarget(CCircuitUnit* unit, const AIFloat3& pos)
 			|| !terrainMgr->CanMoveToPos(area, ePos)
 			|| (enemy->GetVel().SqLength2D() >= speed))
 		{
-			continue;
+			return;
 		}
 
 		int targetCat;
@@ -197,19 +197,19 @@ bool CScoutTask::FindTarget(CCircuitUnit* unit, const AIFloat3& pos)
 			if (((targetCat & canTargetCat) == 0)
 				|| (edef->IsAbleToFly() && notAA))
 			{
-				continue;
+				return;
 			}
-			float elevation = map->GetElevationAt(ePos.x, ePos.z);
+			float elevation = entry.elevation;
 			if ((notAW && !edef->IsYTargetable(elevation, ePos.y))
 				|| (ePos.y - elevation > weaponRange))
 			{
-				continue;
+				return;
 			}
 			defThreat = edef->GetPower();
 			isBuilder = edef->IsEnemyRoleAny(CCircuitDef::RoleMask::BUILDER);
 		} else {
 			if (notAW && (ePos.y < -SQUARE_SIZE * 5)) {
-				continue;
+				return;
 			}
 			targetCat = UNKNOWN_CATEGORY;
 			defThreat = enemy->GetThreat();
@@ -239,12 +239,12 @@ bool CScoutTask::FindTarget(CCircuitUnit* unit, const AIFloat3& pos)
 					}
 //				}
 			}
-			continue;
+			return;
 		}
 		if (sqDist < SQUARE(1000.f)) {  // maxSqDist
 			enemyPositions.push_back(ePos);
 		}
-	}
+	});
 	if (bestTarget == nullptr) {
 		bestTarget = worstTarget;
 	}
@@ -19,6 +19,8 @@ IBlockMask::IBlockMask(SBlockingMap::StructType structType, int ignoreMask)
 		, offsetEast(0, 0)
 		, offsetNorth(0, 0)
 		, offsetWest(0, 0)
+		, structS1(0, 0)
+		, structS2(0, 0)
 		, structType(structType)
 		, ignoreMask(ignoreMask)
 {
@@ -70,6 +72,9 @@ IBlockMask::BlockRects IBlockMask::Init(const int2& offset, const int2& bsize, c
 	offsetWest.x  = offsetNorth.y;
 	offsetWest.y  = offsetSouth.x;
 
+	structS1 = s1;
+	structS2 = s2;
+
 	mask.resize(xsize * zsize, BlockType::OPEN);
 
 	return {b1, b2, s1, s2};
@@ -104,4 +109,28 @@ const int2& IBlockMask::GetStructOffset(int facing)
 	}
 }
 
+void IBlockMask::GetStructRect(int facing, int2& r1, int2& r2)
+{
+	// @see GetTypeEast, GetTypeNorth, GetTypeWest
+	switch (facing) {
+		default:
+		case UNIT_FACING_SOUTH: {
+			r1 = structS1;
+			r2 = structS2;
+		} break;
+		case UNIT_FACING_EAST: {
+			r1 = int2(structS1.y, xsize - structS2.x);
+			r2 = int2(structS2.y, xsize - structS1.x);
+		} break;
+		case UNIT_FACING_NORTH: {
+			r1 = int2(xsize - structS2.x, zsize - structS2.y);
+			r2 = int2(xsize - structS1.x, zsize - structS1.y);
+		} break;
+		case UNIT_FACING_WEST: {
+			r1 = int2(zsize - structS2.y, structS1.x);
+			r2 = int2(zsize - structS1.y, structS2.x);
+		} break;
+	}
+}
+
 } // namespace circuit
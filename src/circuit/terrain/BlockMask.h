@@ -25,6 +25,8 @@ public:
 	int GetXSize();
 	int GetZSize();
 	const int2& GetStructOffset(int facing);
+	// Rect [r1, r2) of STRUCT cells within facing mask
+	void GetStructRect(int facing, int2& r1, int2& r2);
 
 	inline BlockType GetTypeSouth(int x, int z);
 	inline BlockType GetTypeEast(int x, int z);
@@ -50,6 +52,7 @@ protected:
 	int2 offsetEast;
 	int2 offsetNorth;
 	int2 offsetWest;
+	int2 structS1, structS2;  // STRUCT rect within South mask
 	SBlockingMap::StructType structType;
 	int ignoreMask;
 };
@@ -43,4 +43,45 @@ SBlockingMap::StructMasks SBlockingMap::structMasks = {
 	{"all",       SBlockingMap::StructMask::ALL},
 };
 
+SBlockingMap::SSumTable& SBlockingMap::GetSumTable(SSumTable::Type type, SM mask)
+{
+	for (SSumTable& table : sumTables) {
+		if ((table.type == type) && (table.mask == mask)) {
+			return table;
+		}
+	}
+	sumTables.emplace_back();
+	SSumTable& table = sumTables.back();
+	table.type = type;
+	table.mask = mask;
+	table.dirty = int2(0, 0);
+	table.sum.assign((columns + 1) * (rows + 1), 0);
+	return table;
+}
+
+void SBlockingMap::UpdateSumTable(SSumTable& table)
+{
+	const int stride = columns + 1;
+	const int x0 = table.dirty.x;
+	std::vector<int>& sum = table.sum;
+	for (int z = table.dirty.y; z < rows; ++z) {
+		const int* above = &sum[z * stride];
+		int* row = &sum[(z + 1) * stride];
+		int rowSum = row[x0] - above[x0];  // cells of [0, x0) at row z
+		const SBlockCell* cell = &grid[z * columns];
+		if (table.type == SSumTable::Type::STRUCTED) {
+			for (int x = x0; x < columns; ++x) {
+				rowSum += (cell[x].notIgnoreMask & table.mask) ? 1 : 0;
+				row[x + 1] = above[x + 1] + rowSum;
+			}
+		} else {
+			for (int x = x0; x < columns; ++x) {
+				rowSum += ((cell[x].blockerMask & table.mask) || static_cast<SM>(cell[x].structMask)) ? 1 : 0;
+				row[x + 1] = above[x + 1] + rowSum;
+			}
+		}
+	}
+	table.dirty = int2(columns, rows);
+}
+
 } // namespace circuit
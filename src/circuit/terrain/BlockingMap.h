@@ -40,6 +40,9 @@ struct SBlockingMap {
 	inline bool IsBlocked(int x, int z, SM notIgnoreMask) const;  // IsBlocked for struct
 	inline bool IsBlockedLow(int xLow, int zLow, SM notIgnoreMask) const;
 	inline bool IsStruct(int x, int z) const;  // Is blocked by any struct
+	// O(1) rect [r1, r2) tests over summed-area tables
+	inline bool IsStructedArea(const int2& r1, const int2& r2, StructMask structMask);  // IsStructed for any cell
+	inline bool IsBlockedArea(const int2& r1, const int2& r2, SM notIgnoreMask);  // IsBlocked for any cell
 	inline void MarkBlocker(int x, int z, StructType structType, SM notIgnoreMask);
 	inline void AddBlocker(int x, int z, StructType structType);
 	inline void DelBlocker(int x, int z, StructType structType);
@@ -69,10 +72,27 @@ struct SBlockingMap {
 		SM blockerMask;
 		unsigned short blockerCounts[static_cast<ST>(StructType::_SIZE_)];
 	};
-	// TODO: Replace with QuadTree
 	std::vector<SBlockCellLow> gridLow;  // granularity Map::GetWidth / 16, Map::GetHeight / 16
 	int columnsLow;
 	int rowsLow;
+
+	/*
+	 * Summed-area table of cells matching IsStructed or IsBlocked with certain mask.
+	 * Created on first request, marks only move dirty corner,
+	 * table is recalculated from that corner on next request.
+	 */
+	struct SSumTable {
+		enum class Type: char {STRUCTED, BLOCKED};
+		Type type;
+		SM mask;
+		int2 dirty;  // top-left corner of changed cells, (columns, rows) if clean
+		std::vector<int> sum;  // (columns + 1) x (rows + 1), sum[(z + 1) * (columns + 1) + x + 1] = cells of [0, x] x [0, z]
+	};
+	std::vector<SSumTable> sumTables;
+	SSumTable& GetSumTable(SSumTable::Type type, SM mask);
+	void UpdateSumTable(SSumTable& table);
+	inline int GetSumArea(SSumTable& table, const int2& r1, const int2& r2);
+	inline void MarkDirty(int x, int z);
 };
 
 } // namespace circuit
@@ -37,6 +37,37 @@ inline bool SBlockingMap::IsStruct(int x, int z) const
 	return static_cast<SM>(grid[z * columns + x].structMask);
 }
 
+inline bool SBlockingMap::IsStructedArea(const int2& r1, const int2& r2, StructMask structMask)
+{
+	return GetSumArea(GetSumTable(SSumTable::Type::STRUCTED, static_cast<SM>(structMask)), r1, r2) > 0;
+}
+
+inline bool SBlockingMap::IsBlockedArea(const int2& r1, const int2& r2, SM notIgnoreMask)
+{
+	return GetSumArea(GetSumTable(SSumTable::Type::BLOCKED, notIgnoreMask), r1, r2) > 0;
+}
+
+inline int SBlockingMap::GetSumArea(SSumTable& table, const int2& r1, const int2& r2)
+{
+	if ((r1.x >= r2.x) || (r1.y >= r2.y)) {
+		return 0;
+	}
+	if ((table.dirty.x < columns) && (table.dirty.y < rows)) {
+		UpdateSumTable(table);
+	}
+	const int stride = columns + 1;
+	const std::vector<int>& sum = table.sum;
+	return sum[r2.y * stride + r2.x] - sum[r1.y * stride + r2.x] - sum[r2.y * stride + r1.x] + sum[r1.y * stride + r1.x];
+}
+
+inline void SBlockingMap::MarkDirty(int x, int z)
+{
+	for (SSumTable& table : sumTables) {
+		table.dirty.x = std::min(table.dirty.x, x);
+		table.dirty.y = std::min(table.dirty.y, z);
+	}
+}
+
 inline void SBlockingMap::MarkBlocker(int x, int z, StructType structType, SM notIgnoreMask)
 {
 	SBlockCell& cell = grid[z * columns + x];
@@ -45,6 +76,7 @@ inline void SBlockingMap::MarkBlocker(int x, int z, StructType structType, SM no
 //	cell.structMask = GetStructMask(structType);
 	const SM structMask = static_cast<SM>(GetStructMask(structType));
 	cell.blockerMask |= structMask;
+	MarkDirty(x, z);
 
 	SBlockCellLow& cellLow = gridLow[z / GRID_RATIO_LOW * columnsLow + x / GRID_RATIO_LOW];
 	if (cellLow.blockerCounts[static_cast<ST>(structType)]++ == BLOCK_THRESHOLD) {
@@ -58,6 +90,7 @@ inline void SBlockingMap::AddBlocker(int x, int z, StructType structType)
 	if (cell.blockerCounts[static_cast<ST>(structType)]++ == 0) {
 		const SM structMask = static_cast<SM>(GetStructMask(structType));
 		cell.blockerMask |= structMask;
+		MarkDirty(x, z);
 
 		SBlockCellLow& cellLow = gridLow[z / GRID_RATIO_LOW * columnsLow + x / GRID_RATIO_LOW];
 		if (++cellLow.blockerCounts[static_cast<ST>(structType)] == BLOCK_THRESHOLD) {
@@ -72,6 +105,7 @@ inline void SBlockingMap::DelBlocker(int x, int z, StructType structType)
 	if (--cell.blockerCounts[static_cast<ST>(structType)] == 0) {
 		const int notStructMask = ~static_cast<SM>(GetStructMask(structType));
 		cell.blockerMask &= notStructMask;
+		MarkDirty(x, z);
 
 		SBlockCellLow& cellLow = gridLow[z / GRID_RATIO_LOW * columnsLow + x / GRID_RATIO_LOW];
 		if (cellLow.blockerCounts[static_cast<ST>(structType)]-- == BLOCK_THRESHOLD) {
@@ -91,6 +125,7 @@ inline void SBlockingMap::AddStruct(int x, int z, StructType structType, SM notI
 	}
 	cell.notIgnoreMask = notIgnoreMask;
 	cell.structMask = GetStructMask(structType);
+	MarkDirty(x, z);
 }
 
 inline void SBlockingMap::DelStruct(int x, int z, StructType structType, SM notIgnoreMask)
@@ -98,6 +133,7 @@ inline void SBlockingMap::DelStruct(int x, int z, StructType structType, SM notI
 	SBlockCell& cell = grid[z * columns + x];
 	cell.notIgnoreMask = 0;
 	cell.structMask = StructMask::NONE;
+	MarkDirty(x, z);
 	if (cell.blockerCounts[static_cast<ST>(structType)] == 0) {
 		SBlockCellLow& cellLow = gridLow[z / GRID_RATIO_LOW * columnsLow + x / GRID_RATIO_LOW];
 		if (cellLow.blockerCounts[static_cast<ST>(structType)]-- == BLOCK_THRESHOLD) {
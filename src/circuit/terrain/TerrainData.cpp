@@ -8,6 +8,8 @@
 #include "terrain/TerrainData.h"
 #include "terrain/TerrainManager.h"
 #include "CircuitAI.h"
+#include "util/BinaryCache.h"
+#include "util/FileSystem.h"
 #include "util/GameAttribute.h"
 #include "util/Scheduler.h"
 #include "util/math/HierarchCluster.h"
@@ -33,6 +35,7 @@ namespace circuit {
 using namespace springai;
 
 #define AREA_UPDATE_RATE	(FRAMES_PER_SEC * 10)
+#define AREA_CACHE_VERSION	1
 // FIXME: Make Engine consts available to AI. @see rts/Sim/MoveTypes/MoveDefHandler.cpp
 #define MAX_ALLOWED_WATER_DAMAGE_GMM	1e3f
 #define MAX_ALLOWED_WATER_DAMAGE_HMM	1e4f
@@ -48,6 +51,7 @@ CTerrainData::CTerrainData()
 		, waterIsAVoid(false)
 		, sectorXSize(0)
 		, sectorZSize(0)
+		, cacheKey(0)
 		, gameAttribute(nullptr)
 		, isUpdating(false)
 		, aiToUpdate(0)
@@ -363,6 +367,27 @@ void CTerrainData::Init(CCircuitAI* circuit)
 		circuit->LOG(itText.c_str(), it.udCount);
 	}
 
+	/*
+	 *  Areas cache: key is the map and mobile types
+	 */
+	cacheKey = CBinaryCache::HashVector(areaData.heightMap, CBinaryCache::HashVector(slopeMap));
+	cacheKey = CBinaryCache::HashValue(convertStoP, cacheKey);
+	cacheKey = CBinaryCache::HashValue(waterIsHarmful, cacheKey);
+	cacheKey = CBinaryCache::HashValue(waterIsAVoid, cacheKey);
+	for (auto& mt : mobileType) {
+		cacheKey = CBinaryCache::HashValue(mt.maxSlope, cacheKey);
+		cacheKey = CBinaryCache::HashValue(mt.minElevation, cacheKey);
+		cacheKey = CBinaryCache::HashValue(mt.maxElevation, cacheKey);
+		cacheKey = CBinaryCache::HashValue(mt.canHover, cacheKey);
+		cacheKey = CBinaryCache::HashValue(mt.canFloat, cacheKey);
+	}
+	CBinaryCache areaCache(AREA_CACHE_VERSION, cacheKey);
+	std::string cachePath = GetCachePath(circuit, "areas", false);
+	bool isCacheHit = !cachePath.empty() && areaCache.Load(cachePath);
+	if (isCacheHit) {
+		circuit->LOG("  Loading Map-Areas from cache: %s", cachePath.c_str());
+	}
+
 	/*
 	 *  Determine areas per mobileType
 	 */
@@ -390,76 +415,86 @@ void CTerrainData::Init(CCircuitAI* circuit)
 		mtText << ")  \tMax Slope=(" << mt.maxSlope << ")";
 		mtText << ")  \tMove-Data used:'" << mt.moveData->GetName() << "'";
 
-		std::deque<int> sectorSearch;
-		std::set<int> sectorsRemaining;
-		for (int iS = 0; iS < sectorZSize * sectorXSize; iS++) {
-			if ((mt.canHover && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsAVoid && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
-				(mt.canFloat && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsHarmful && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
-				((mt.maxSlope >= sector[iS].maxSlope) && (mt.minElevation <= sector[iS].minElevation) && (mt.maxElevation >= sector[iS].maxElevation) && (!waterIsHarmful || (sector[iS].minElevation >= 0))))
-			{
-				sectorsRemaining.insert(iS);
-			}
+		int areaSize = 0;
+		if (isCacheHit && !ReadAreas(areaCache, mt)) {
+			isCacheHit = false;
+			mt.area.clear();
 		}
+		if (isCacheHit) {
+			areaSize = mt.area.size();
+		} else {
 
-		// Group sectors into areas
-		int i, iX, iZ, areaSize = 0;  // Temp Var.
-		while (!sectorsRemaining.empty() || !sectorSearch.empty()) {
-
-			if (!sectorSearch.empty()) {
-				i = sectorSearch.front();
-				mt.area.back().sector[i] = &mt.sector[i];
-				iX = i % sectorXSize;
-				iZ = i / sectorXSize;
-				if ((sectorsRemaining.find(i - 1) != sectorsRemaining.end()) && (iX > 0)) {  // Search left
-					sectorSearch.push_back(i - 1);
-					sectorsRemaining.erase(i - 1);
-				}
-				if ((sectorsRemaining.find(i + 1) != sectorsRemaining.end()) && (iX < sectorXSize - 1)) {  // Search right
-					sectorSearch.push_back(i + 1);
-					sectorsRemaining.erase(i + 1);
-				}
-				if ((sectorsRemaining.find(i - sectorXSize) != sectorsRemaining.end()) && (iZ > 0)) {  // Search up
-					sectorSearch.push_back(i - sectorXSize);
-					sectorsRemaining.erase(i - sectorXSize);
-				}
-				if ((sectorsRemaining.find(i + sectorXSize) != sectorsRemaining.end()) && (iZ < sectorZSize - 1)) {  // Search down
-					sectorSearch.push_back(i + sectorXSize);
-					sectorsRemaining.erase(i + sectorXSize);
+			std::deque<int> sectorSearch;
+			std::set<int> sectorsRemaining;
+			for (int iS = 0; iS < sectorZSize * sectorXSize; iS++) {
+				if ((mt.canHover && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsAVoid && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
+					(mt.canFloat && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsHarmful && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
+					((mt.maxSlope >= sector[iS].maxSlope) && (mt.minElevation <= sector[iS].minElevation) && (mt.maxElevation >= sector[iS].maxElevation) && (!waterIsHarmful || (sector[iS].minElevation >= 0))))
+				{
+					sectorsRemaining.insert(iS);
 				}
-				sectorSearch.pop_front();
+			}
 
-			} else {
+			// Group sectors into areas
+			int i, iX, iZ;  // Temp Var.
+			while (!sectorsRemaining.empty() || !sectorSearch.empty()) {
 
-				if ((areaSize > 0) && ((areaSize == MAP_AREA_LIST_SIZE) || (mt.area.back().sector.size() <= MAMinimalSectors) ||
-					(100. * float(mt.area.back().sector.size()) / float(sectorXSize * sectorZSize) <= MAMinimalSectorPercent)))
-				{
-					// Too many areas detected. Find, erase & ignore the smallest one that was found so far
-					if (areaSize == MAP_AREA_LIST_SIZE) {
-						mtText << "\nWARNING: The MapArea limit has been reached (possible error).";
+				if (!sectorSearch.empty()) {
+					i = sectorSearch.front();
+					mt.area.back().sector[i] = &mt.sector[i];
+					iX = i % sectorXSize;
+					iZ = i / sectorXSize;
+					if ((sectorsRemaining.find(i - 1) != sectorsRemaining.end()) && (iX > 0)) {  // Search left
+						sectorSearch.push_back(i - 1);
+						sectorsRemaining.erase(i - 1);
 					}
-					decltype(mt.area)::iterator it, itArea;
-					it = itArea = mt.area.begin();
-					for (++it; it != mt.area.end(); ++it) {
-						if (it->sector.size() < itArea->sector.size()) {
-							itArea = it;
+					if ((sectorsRemaining.find(i + 1) != sectorsRemaining.end()) && (iX < sectorXSize - 1)) {  // Search right
+						sectorSearch.push_back(i + 1);
+						sectorsRemaining.erase(i + 1);
+					}
+					if ((sectorsRemaining.find(i - sectorXSize) != sectorsRemaining.end()) && (iZ > 0)) {  // Search up
+						sectorSearch.push_back(i - sectorXSize);
+						sectorsRemaining.erase(i - sectorXSize);
+					}
+					if ((sectorsRemaining.find(i + sectorXSize) != sectorsRemaining.end()) && (iZ < sectorZSize - 1)) {  // Search down
+						sectorSearch.push_back(i + sectorXSize);
+						sectorsRemaining.erase(i + sectorXSize);
+					}
+					sectorSearch.pop_front();
+
+				} else {
+
+					if ((areaSize > 0) && ((areaSize == MAP_AREA_LIST_SIZE) || (mt.area.back().sector.size() <= MAMinimalSectors) ||
+						(100. * float(mt.area.back().sector.size()) / float(sectorXSize * sectorZSize) <= MAMinimalSectorPercent)))
+					{
+						// Too many areas detected. Find, erase & ignore the smallest one that was found so far
+						if (areaSize == MAP_AREA_LIST_SIZE) {
+							mtText << "\nWARNING: The MapArea limit has been reached (possible error).";
+						}
+						decltype(mt.area)::iterator it, itArea;
+						it = itArea = mt.area.begin();
+						for (++it; it != mt.area.end(); ++it) {
+							if (it->sector.size() < itArea->sector.size()) {
+								itArea = it;
+							}
 						}
+						mt.area.erase(itArea);
+						areaSize--;
 					}
-					mt.area.erase(itArea);
-					areaSize--;
-				}
 
-				i = *sectorsRemaining.begin();
-				sectorSearch.push_back(i);
-				sectorsRemaining.erase(i);
-				mt.area.emplace_back(&mt);
-				areaSize++;
+					i = *sectorsRemaining.begin();
+					sectorSearch.push_back(i);
+					sectorsRemaining.erase(i);
+					mt.area.emplace_back(&mt);
+					areaSize++;
+				}
+			}
+			if ((areaSize > 0) && ((mt.area.back().sector.size() <= MAMinimalSectors) ||
+				(100.0 * float(mt.area.back().sector.size()) / float(sectorXSize * sectorZSize) <= MAMinimalSectorPercent)))
+			{
+				areaSize--;
+				mt.area.pop_back();
 			}
-		}
-		if ((areaSize > 0) && ((mt.area.back().sector.size() <= MAMinimalSectors) ||
-			(100.0 * float(mt.area.back().sector.size()) / float(sectorXSize * sectorZSize) <= MAMinimalSectorPercent)))
-		{
-			areaSize--;
-			mt.area.pop_back();
 		}
 
 		// Calculations
@@ -485,6 +520,17 @@ void CTerrainData::Init(CCircuitAI* circuit)
 		circuit->LOG(mtText.str().c_str());
 	}
 
+	if (!isCacheHit) {
+		WriteAreas(circuit);
+	}
+
+	for (auto& mt : mobileType) {
+		MakeClosestSectors(sector, mt);
+	}
+	for (auto& it : immobileType) {
+		MakeClosestSectors(it);
+	}
+
 	/*
 	 *  Duplicate areaData
 	 */
@@ -524,8 +570,8 @@ void CTerrainData::Init(CCircuitAI* circuit)
 		}
 	}
 
-	scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CTerrainData::EnqueueUpdate, this), AREA_UPDATE_RATE);
-	scheduler->RunOnRelease(std::make_shared<CGameTask>(&CTerrainData::DelegateAuthority, this, circuit));
+	scheduler->RunTaskEvery(MakeTask(&CTerrainData::EnqueueUpdate, this), AREA_UPDATE_RATE);
+	scheduler->RunOnRelease(MakeTask(&CTerrainData::DelegateAuthority, this, circuit));
 
 #ifdef DEBUG_VIS
 	debugDrawer = circuit->GetDebugDrawer();
@@ -565,6 +611,62 @@ void CTerrainData::Init(CCircuitAI* circuit)
 	isInitialized = true;
 }
 
+std::string CTerrainData::GetCachePath(CCircuitAI* circuit, const std::string& ext, bool writable)
+{
+	std::string filename = "cache" SLASH + utils::MakeFileSystemCompatible(map->GetName()) + "." + ext;
+	DataDirs* datadirs = circuit->GetCallback()->GetDataDirs();
+	const bool located = utils::LocatePath(datadirs, filename, writable);
+	delete datadirs;
+	return located ? filename : "";
+}
+
+bool CTerrainData::ReadAreas(CBinaryCache& cache, STerrainMapMobileType& mt)
+{
+	const int numSectors = sectorXSize * sectorZSize;
+	uint32_t numAreas;
+	if (!cache.Read(numAreas)) {
+		return false;
+	}
+	std::vector<int> sectors;
+	for (uint32_t k = 0; k < numAreas; ++k) {
+		if (!cache.Read(sectors)) {
+			return false;
+		}
+		mt.area.emplace_back(&mt);
+		std::map<int, STerrainMapAreaSector*>& areaSector = mt.area.back().sector;
+		for (int iS : sectors) {
+			if ((iS < 0) || (iS >= numSectors)) {
+				return false;
+			}
+			areaSector.emplace_hint(areaSector.end(), iS, &mt.sector[iS]);
+		}
+	}
+	return true;
+}
+
+void CTerrainData::WriteAreas(CCircuitAI* circuit)
+{
+	const std::string cachePath = GetCachePath(circuit, "areas", true);
+	if (cachePath.empty()) {
+		return;
+	}
+	CBinaryCache cache(AREA_CACHE_VERSION, cacheKey);
+	std::vector<int> sectors;
+	for (const STerrainMapMobileType& mt : pAreaData.load()->mobileType) {
+		cache.Write<uint32_t>(mt.area.size());
+		for (const STerrainMapArea& area : mt.area) {
+			sectors.clear();
+			for (auto& kv : area.sector) {
+				sectors.push_back(kv.first);
+			}
+			cache.Write(sectors);
+		}
+	}
+	if (!cache.Save(cachePath)) {
+		circuit->LOG("  Failed to save Map-Areas cache: %s", cachePath.c_str());
+	}
+}
+
 void CTerrainData::CorrectPosition(AIFloat3& position)
 {
 	if (position.x < 1) {
@@ -640,9 +742,9 @@ void CTerrainData::DelegateAuthority(CCircuitAI* curOwner)
 		if (circuit->IsInitialized() && (circuit != curOwner)) {
 			map = circuit->GetMap();
 			scheduler = circuit->GetScheduler();
-			scheduler->RunTaskEvery(std::make_shared<CGameTask>(&CTerrainData::EnqueueUpdate, this), AREA_UPDATE_RATE);
-			scheduler->RunTaskAfter(std::make_shared<CGameTask>(&CTerrainData::EnqueueUpdate, this), FRAMES_PER_SEC);
-			scheduler->RunOnRelease(std::make_shared<CGameTask>(&CTerrainData::DelegateAuthority, this, circuit));
+			scheduler->RunTaskEvery(MakeTask(&CTerrainData::EnqueueUpdate, this), AREA_UPDATE_RATE);
+			scheduler->RunTaskAfter(MakeTask(&CTerrainData::EnqueueUpdate, this), FRAMES_PER_SEC);
+			scheduler->RunOnRelease(MakeTask(&CTerrainData::DelegateAuthority, this, circuit));
 			break;
 		}
 	}
@@ -659,8 +761,8 @@ void CTerrainData::EnqueueUpdate()
 	map->GetHeightMap(GetNextAreaData()->heightMap);
 	map->GetSlopeMap(slopeMap);
 
-	scheduler->RunParallelTask(std::make_shared<CGameTask>(&CTerrainData::UpdateAreas, this),
-							   std::make_shared<CGameTask>(&CTerrainData::ScheduleUsersUpdate, this));
+	scheduler->RunParallelTask(MakeTask(&CTerrainData::UpdateAreas, this),
+							   MakeTask(&CTerrainData::ScheduleUsersUpdate, this));
 }
 
 void CTerrainData::UpdateAreas()
@@ -689,9 +791,6 @@ void CTerrainData::UpdateAreas()
 		itmt->areaLargest = nullptr;
 		for (auto& as : itmt->sector) {
 			as.area = nullptr;
-			// TODO: Use previous sectorAlternativeM/I and update it?
-			as.sectorAlternativeM.clear();
-			as.sectorAlternativeI.clear();
 		}
 		itmt->area.clear();
 		++itmt;
@@ -702,8 +801,7 @@ void CTerrainData::UpdateAreas()
 		for (auto& kv : it.sector) {
 			itit->sector[kv.first] = &sector[kv.first];
 		}
-		// TODO: Use previous sectorClosest and update it (replace STerrainMapSector* by index)?
-		itit->sectorClosest.clear();
+		itit->sectorClosest = it.sectorClosest;
 		++itit;
 	}
 	minElevation = prevAreaData.minElevation;
@@ -733,7 +831,7 @@ void CTerrainData::UpdateAreas()
 		}
 		return false;
 	};
-	std::set<int> changedSectors;
+	std::vector<int> changedSectors;  // sorted
 
 	for (int z = 0; z < sectorZSize; z++) {
 		for (int x = 0; x < sectorXSize; x++) {
@@ -743,7 +841,7 @@ void CTerrainData::UpdateAreas()
 			}
 
 			int i = (z * sectorXSize) + x;
-			changedSectors.insert(i);
+			changedSectors.push_back(i);
 
 			int xi = sector[i].position.x / SQUARE_SIZE;
 			int zi = sector[i].position.z / SQUARE_SIZE;
@@ -807,6 +905,9 @@ void CTerrainData::UpdateAreas()
 
 	for (auto& it : immobileType) {
 		it.typeUsable = (((100.0 * it.sector.size()) / float(sectorXSize * sectorZSize) >= 20.0) || ((double)convertStoP * convertStoP * it.sector.size() >= 1.8e7));
+		if (!changedSectors.empty()) {
+			MakeClosestSectors(it);
+		}
 	}
 
 	/*
@@ -814,93 +915,18 @@ void CTerrainData::UpdateAreas()
 	 */
 	auto shouldRebuild = [this, &changedSectors, &sector](STerrainMapMobileType& mt) {
 		for (auto iS : changedSectors) {
-			if ((mt.canHover && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsAVoid && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
-				(mt.canFloat && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsHarmful && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
-				((mt.maxSlope >= sector[iS].maxSlope) && (mt.minElevation <= sector[iS].minElevation) && (mt.maxElevation >= sector[iS].maxElevation) && (!waterIsHarmful || (sector[iS].minElevation >= 0))))
-			{
-				if (mt.sector[iS].area == nullptr) {
-					return true;
-				}
-			} else {
-				if (mt.sector[iS].area != nullptr) {
-					return true;
-				}
+			if (IsSectorPassable(mt, sector[iS]) != (mt.sector[iS].area != nullptr)) {
+				return true;
 			}
 		}
 		return false;
 	};
-	const size_t MAMinimalSectors = 8;         // Minimal # of sector for a valid MapArea
-	const float MAMinimalSectorPercent = 0.5;  // Minimal % of map for a valid MapArea
 	itmt = prevAreaData.mobileType.begin();
 	for (auto& mt : mobileType) {
-		if (shouldRebuild(*itmt)) {
-
-			std::deque<int> sectorSearch;
-			std::set<int> sectorsRemaining;
-			for (int iS = 0; iS < sectorZSize * sectorXSize; iS++) {
-				if ((mt.canHover && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsAVoid && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
-					(mt.canFloat && (mt.maxElevation >= sector[iS].maxElevation) && !waterIsHarmful && ((sector[iS].maxElevation <= 0) || (mt.maxSlope >= sector[iS].maxSlope))) ||
-					((mt.maxSlope >= sector[iS].maxSlope) && (mt.minElevation <= sector[iS].minElevation) && (mt.maxElevation >= sector[iS].maxElevation) && (!waterIsHarmful || (sector[iS].minElevation >= 0))))
-				{
-					sectorsRemaining.insert(iS);
-				}
-			}
-
-			// Group sectors into areas
-			int i, iX, iZ, areaSize = 0;  // Temp Var.
-			while (!sectorsRemaining.empty() || !sectorSearch.empty()) {
-
-				if (!sectorSearch.empty()) {
-					i = sectorSearch.front();
-					mt.area.back().sector[i] = &mt.sector[i];
-					iX = i % sectorXSize;
-					iZ = i / sectorXSize;
-					if ((sectorsRemaining.find(i - 1) != sectorsRemaining.end()) && (iX > 0)) {  // Search left
-						sectorSearch.push_back(i - 1);
-						sectorsRemaining.erase(i - 1);
-					}
-					if ((sectorsRemaining.find(i + 1) != sectorsRemaining.end()) && (iX < sectorXSize - 1)) {  // Search right
-						sectorSearch.push_back(i + 1);
-						sectorsRemaining.erase(i + 1);
-					}
-					if ((sectorsRemaining.find(i - sectorXSize) != sectorsRemaining.end()) && (iZ > 0)) {  // Search up
-						sectorSearch.push_back(i - sectorXSize);
-						sectorsRemaining.erase(i - sectorXSize);
-					}
-					if ((sectorsRemaining.find(i + sectorXSize) != sectorsRemaining.end()) && (iZ < sectorZSize - 1)) {  // Search down
-						sectorSearch.push_back(i + sectorXSize);
-						sectorsRemaining.erase(i + sectorXSize);
-					}
-					sectorSearch.pop_front();
+		const bool isRebuild = shouldRebuild(*itmt);
+		if (isRebuild) {
 
-				} else {
-
-					if ((areaSize > 0) && ((areaSize == MAP_AREA_LIST_SIZE) || (mt.area.back().sector.size() <= MAMinimalSectors) ||
-						(100. * float(mt.area.back().sector.size()) / float(sectorXSize * sectorZSize) <= MAMinimalSectorPercent)))
-					{
-						decltype(mt.area)::iterator it, itArea;
-						it = itArea = mt.area.begin();
-						for (++it; it != mt.area.end(); ++it) {
-							if (it->sector.size() < itArea->sector.size()) {
-								itArea = it;
-							}
-						}
-						mt.area.erase(itArea);
-						areaSize--;
-					}
-
-					i = *sectorsRemaining.begin();
-					sectorSearch.push_back(i);
-					sectorsRemaining.erase(i);
-					mt.area.emplace_back(&mt);
-					areaSize++;
-				}
-			}
-			if ((areaSize > 0) && ((mt.area.back().sector.size() <= MAMinimalSectors) ||
-				(100.0 * float(mt.area.back().sector.size()) / float(sectorXSize * sectorZSize) <= MAMinimalSectorPercent)))
-			{
-				mt.area.pop_back();
-			}
+			RefloodAreas(mt, *itmt, changedSectors);
 
 		} else {  // should not rebuild
 
@@ -909,8 +935,9 @@ void CTerrainData::UpdateAreas()
 				mt.area.emplace_back(&mt);
 				std::map<int, STerrainMapAreaSector*>& sector = mt.area.back().sector;
 				for (auto& kv : area.sector) {
-					sector[kv.first] = &mt.sector[kv.first];
+					sector.emplace_hint(sector.end(), kv.first, &mt.sector[kv.first]);
 				}
+				mt.area.back().sectorClosest = area.sectorClosest;
 			}
 		}
 
@@ -931,10 +958,248 @@ void CTerrainData::UpdateAreas()
 			}
 		}
 
+		if (isRebuild) {
+			MakeClosestSectors(sector, mt);
+		} else {
+			mt.sectorAlternative = itmt->sectorAlternative;
+		}
+
 		++itmt;
 	}
 }
 
+void CTerrainData::MakeClosestSectors(const std::vector<STerrainMapSector>& sector, STerrainMapMobileType& mt)
+{
+	const int numSectors = sectorXSize * sectorZSize;
+	for (STerrainMapArea& area : mt.area) {
+		area.sectorClosest.assign(numSectors, -1);
+		for (auto& kv : area.sector) {
+			area.sectorClosest[kv.first] = kv.first;
+		}
+		PropagateClosest(area.sectorClosest);
+	}
+
+	// @see CTerrainManager::GetAlternativeSector, source area is unknown
+	mt.sectorAlternative.assign(numSectors, -1);
+	if (mt.areaLargest == nullptr) {
+		return;
+	}
+	for (int iS = 0; iS < numSectors; ++iS) {
+		const AIFloat3& position = sector[iS].position;
+		const STerrainMapArea* bestArea = nullptr;
+		float bestDistance = -1.0;
+		for (const STerrainMapArea& area : mt.area) {
+			if (!area.areaUsable && mt.areaLargest->areaUsable) {
+				continue;
+			}
+			const int iCAS = area.sectorClosest[iS];
+			const float distance = position.distance2D(sector[iCAS].position);
+			if ((bestArea == nullptr) || (distance * area.percentOfMap < bestDistance * bestArea->percentOfMap)) {
+				mt.sectorAlternative[iS] = iCAS;
+				bestArea = &area;
+				bestDistance = distance;
+			}
+		}
+	}
+}
+
+void CTerrainData::MakeClosestSectors(STerrainMapImmobileType& it)
+{
+	it.sectorClosest.assign(sectorXSize * sectorZSize, -1);
+	for (auto& kv : it.sector) {
+		it.sectorClosest[kv.first] = kv.first;
+	}
+	PropagateClosest(it.sectorClosest);
+}
+
+/*
+ * Exact Euclidean feature transform, two separable passes (Felzenszwalb & Huttenlocher):
+ * nearest seed of the column, then lower envelope of parabolas (x - q)^2 + dz(q)^2 per row.
+ * Seeds are sectors with closest[i] == i, others must be -1.
+ */
+void CTerrainData::PropagateClosest(std::vector<int>& closest) const
+{
+	static thread_local std::vector<int> colSeed;  // nearest seed within column, -1 if none
+	static thread_local std::vector<int> v;  // columns of parabolas in lower envelope
+	static thread_local std::vector<float> bound;  // envelope ranges
+	colSeed.assign(closest.size(), -1);
+	v.resize(sectorXSize);
+	bound.resize(sectorXSize + 1);
+
+	for (int x = 0; x < sectorXSize; ++x) {
+		int seed = -1;
+		for (int z = 0; z < sectorZSize; ++z) {
+			const int i = z * sectorXSize + x;
+			if (closest[i] == i) {
+				seed = i;
+			}
+			colSeed[i] = seed;
+		}
+		seed = -1;
+		for (int z = sectorZSize - 1; z >= 0; --z) {
+			const int i = z * sectorXSize + x;
+			if (closest[i] == i) {
+				seed = i;
+			}
+			if ((seed >= 0) && ((colSeed[i] < 0) || (seed / sectorXSize - z < z - colSeed[i] / sectorXSize))) {
+				colSeed[i] = seed;
+			}
+		}
+	}
+
+	for (int z = 0; z < sectorZSize; ++z) {
+		const int row = z * sectorXSize;
+		auto f = [this, row, z](int q) {  // (q, 0) to nearest seed of column q, plus q^2
+			const int dz = colSeed[row + q] / sectorXSize - z;
+			return float(dz * dz + q * q);
+		};
+		int k = -1;
+		for (int q = 0; q < sectorXSize; ++q) {
+			if (colSeed[row + q] < 0) {
+				continue;
+			}
+			float s = -std::numeric_limits<float>::max();
+			while (k >= 0) {
+				s = (f(q) - f(v[k])) / (2 * (q - v[k]));
+				if (s > bound[k]) {
+					break;
+				}
+				--k;
+				s = -std::numeric_limits<float>::max();
+			}
+			++k;
+			v[k] = q;
+			bound[k] = s;
+		}
+		if (k < 0) {
+			continue;  // no seeds at all
+		}
+		bound[k + 1] = std::numeric_limits<float>::max();
+		for (int x = 0, j = 0; x < sectorXSize; ++x) {
+			while (bound[j + 1] < x) {
+				++j;
+			}
+			closest[row + x] = colSeed[row + v[j]];
+		}
+	}
+}
+
+bool CTerrainData::IsSectorPassable(const STerrainMapMobileType& mt, const STerrainMapSector& s) const
+{
+	return (mt.canHover && (mt.maxElevation >= s.maxElevation) && !waterIsAVoid && ((s.maxElevation <= 0) || (mt.maxSlope >= s.maxSlope))) ||
+		(mt.canFloat && (mt.maxElevation >= s.maxElevation) && !waterIsHarmful && ((s.maxElevation <= 0) || (mt.maxSlope >= s.maxSlope))) ||
+		((mt.maxSlope >= s.maxSlope) && (mt.minElevation <= s.minElevation) && (mt.maxElevation >= s.maxElevation) && (!waterIsHarmful || (s.minElevation >= 0)));
+}
+
+/*
+ * Dirty-region update of areas: previous areas that contain changed sectors are dropped
+ * and re-flooded together with changed passable sectors. Flood may reach other previous areas
+ * (merge), those are re-flooded as well. Untouched areas are copied.
+ */
+void CTerrainData::RefloodAreas(STerrainMapMobileType& mt, const STerrainMapMobileType& prevMt,
+		const std::vector<int>& changedSectors)
+{
+	const std::vector<STerrainMapSector>& sector = GetNextAreaData()->sector;
+	const int numSectors = sectorXSize * sectorZSize;
+	const size_t MAMinimalSectors = 8;         // Minimal # of sector for a valid MapArea
+	const float MAMinimalSectorPercent = 0.5;  // Minimal % of map for a valid MapArea
+
+	std::vector<int> prevLabels(numSectors, -1);
+	for (unsigned k = 0; k < prevMt.area.size(); ++k) {
+		for (auto& kv : prevMt.area[k].sector) {
+			prevLabels[kv.first] = k;
+		}
+	}
+	std::vector<bool> isConsumed(prevMt.area.size(), false);
+
+	std::vector<int> seeds;
+	for (int iS : changedSectors) {
+		if (prevLabels[iS] >= 0) {
+			isConsumed[prevLabels[iS]] = true;
+		}
+		if (IsSectorPassable(mt, sector[iS])) {
+			seeds.push_back(iS);
+		}
+	}
+	for (unsigned k = 0; k < prevMt.area.size(); ++k) {
+		if (isConsumed[k]) {
+			for (auto& kv : prevMt.area[k].sector) {
+				seeds.push_back(kv.first);  // passability of unchanged sectors is the same
+			}
+		}
+	}
+
+	// Group dirty sectors into components
+	std::vector<bool> isVisited(numSectors, false);
+	std::vector<std::vector<int>> components;
+	std::vector<int> sectorSearch;
+	for (int iSeed : seeds) {
+		if (isVisited[iSeed] || !IsSectorPassable(mt, sector[iSeed])) {
+			continue;
+		}
+		components.emplace_back();
+		std::vector<int>& component = components.back();
+		isVisited[iSeed] = true;
+		sectorSearch.push_back(iSeed);
+		while (!sectorSearch.empty()) {
+			const int i = sectorSearch.back();
+			sectorSearch.pop_back();
+			component.push_back(i);
+			if (prevLabels[i] >= 0) {
+				isConsumed[prevLabels[i]] = true;  // merged with previous area
+			}
+			const int iX = i % sectorXSize;
+			const int iZ = i / sectorXSize;
+			const int neighbours[] = {
+				(iX > 0) ? i - 1 : -1,                           // left
+				(iX < sectorXSize - 1) ? i + 1 : -1,             // right
+				(iZ > 0) ? i - sectorXSize : -1,                 // up
+				(iZ < sectorZSize - 1) ? i + sectorXSize : -1    // down
+			};
+			for (int n : neighbours) {
+				if ((n >= 0) && !isVisited[n] && IsSectorPassable(mt, sector[n])) {
+					isVisited[n] = true;
+					sectorSearch.push_back(n);
+				}
+			}
+		}
+	}
+
+	// Untouched previous areas
+	for (unsigned k = 0; k < prevMt.area.size(); ++k) {
+		if (isConsumed[k]) {
+			continue;
+		}
+		mt.area.emplace_back(&mt);
+		std::map<int, STerrainMapAreaSector*>& areaSector = mt.area.back().sector;
+		for (auto& kv : prevMt.area[k].sector) {
+			areaSector.emplace_hint(areaSector.end(), kv.first, &mt.sector[kv.first]);
+		}
+	}
+	// Re-flooded areas
+	for (std::vector<int>& component : components) {
+		if ((component.size() <= MAMinimalSectors) ||
+			(100.0 * float(component.size()) / float(numSectors) <= MAMinimalSectorPercent))
+		{
+			continue;
+		}
+		std::sort(component.begin(), component.end());
+		mt.area.emplace_back(&mt);
+		std::map<int, STerrainMapAreaSector*>& areaSector = mt.area.back().sector;
+		for (int i : component) {
+			areaSector.emplace_hint(areaSector.end(), i, &mt.sector[i]);
+		}
+	}
+
+	// Keep the largest areas
+	while (mt.area.size() > MAP_AREA_LIST_SIZE) {
+		auto itArea = std::min_element(mt.area.begin(), mt.area.end(), [](const STerrainMapArea& a, const STerrainMapArea& b) {
+			return a.sector.size() < b.sector.size();
+		});
+		mt.area.erase(itArea);
+	}
+}
+
 void CTerrainData::ScheduleUsersUpdate()
 {
 	aiToUpdate = 0;
@@ -942,7 +1207,7 @@ void CTerrainData::ScheduleUsersUpdate()
 	for (CCircuitAI* circuit : gameAttribute->GetCircuits()) {
 		if (circuit->IsInitialized()) {
 			// Chain update: CTerrainManager -> CBuilderManager -> CPathFinder
-			auto task = std::make_shared<CGameTask>(&CTerrainManager::UpdateAreaUsers,
+			auto task = MakeTask(&CTerrainManager::UpdateAreaUsers,
 													circuit->GetTerrainManager(),
 													interval);
 			circuit->GetScheduler()->RunTaskAfter(task, ++aiToUpdate);
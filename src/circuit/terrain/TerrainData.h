@@ -27,6 +27,8 @@
 #include <vector>
 #include <atomic>
 #include <memory>
+#include <string>
+#include <cstdint>
 
 struct SSkirmishAICallback;
 
@@ -41,6 +43,7 @@ class CCircuitAI;
 class CScheduler;
 class CGameAttribute;
 class CMap;
+class CBinaryCache;
 #ifdef DEBUG_VIS
 class CDebugDrawer;
 #endif
@@ -60,9 +63,6 @@ struct STerrainMapAreaSector {
 	// NOTE: some of these values are loaded as they become needed, use GlobalTerrainMap functions
 	STerrainMapSector* S;  // always valid
 	STerrainMapArea* area;  // The TerrainMapArea this sector belongs to, otherwise = 0 until
-	// Use this to find the closest sector useable by a unit with a different MoveType, the 0 pointer may be valid as a key index
-	std::map<STerrainMapMobileType*, STerrainMapAreaSector*> sectorAlternativeM;  // uninitialized
-	std::map<STerrainMapImmobileType*, STerrainMapSector*> sectorAlternativeI;  // uninitialized
 };
 
 struct STerrainMapArea {
@@ -75,8 +75,7 @@ struct STerrainMapArea {
 	bool areaUsable;  // Should units of this type be used in this area
 	STerrainMapMobileType* mobileType;
 	std::map<int, STerrainMapAreaSector*> sector;         // key = sector index, a list of all sectors belonging to it
-	std::map<int, STerrainMapAreaSector*> sectorClosest;  // key = sector indexes not in "sector", indicates the sector belonging to this map-area with the closest distance
-	// NOTE: use TerrainData::GetClosestSector: these values are not initialized but are instead loaded as they become needed
+	std::vector<int> sectorClosest;  // [sector index] sector of this map-area with the closest distance, see CTerrainData::MakeClosestSectors
 	float percentOfMap;  // 0-100
 };
 
@@ -101,6 +100,7 @@ struct STerrainMapMobileType {
 	std::vector<STerrainMapAreaSector> sector;  // Each MoveType has it's own sector list, GlobalTerrainMap->GetSectorIndex() gives an index
 	std::vector<STerrainMapArea> area;  // Each MoveType has it's own MapArea list
 	STerrainMapArea* areaLargest;  // Largest area usable by this type, otherwise = 0
+	std::vector<int> sectorAlternative;  // [sector index] closest sector of usable areas for unit outside of any area, -1 if none
 
 	float maxSlope;      // = MoveData*->maxSlope
 	float maxElevation;  // = -ud->minWaterDepth
@@ -144,7 +144,7 @@ struct STerrainMapImmobileType {
 
 	bool typeUsable;  // Should units of this type be used on this map
 	std::map<int, STerrainMapSector*> sector;         // a list of sectors useable by these units
-	std::map<int, STerrainMapSector*> sectorClosest;  // key = sector indexes not in "sector", indicates the closest sector in "sector"
+	std::vector<int> sectorClosest;  // [sector index] closest sector in "sector", -1 if none
 	float minElevation;
 	float maxElevation;
 	bool canHover;
@@ -209,16 +209,32 @@ public:
 	int sectorZSize;
 	static int convertStoP;  // Sector to Position: times this value for convertion, divide for the reverse
 
+	// Hash of the map and mobile types, key of analysis caches
+	uint64_t GetCacheKey() const { return cacheKey; }
+	// Empty if not located
+	static std::string GetCachePath(CCircuitAI* circuit, const std::string& ext, bool writable);
+
 private:
 //	int GetFileValue(int& fileSize, char*& file, std::string entry);
 // ---- RAI's GlobalTerrainMap ---- END
 
 	void DelegateAuthority(CCircuitAI* curOwner);
+	bool ReadAreas(CBinaryCache& cache, STerrainMapMobileType& mt);
+	// Dense lookup tables of closest and alternative sectors
+	void MakeClosestSectors(const std::vector<STerrainMapSector>& sector, STerrainMapMobileType& mt);
+	void MakeClosestSectors(STerrainMapImmobileType& it);
+	void PropagateClosest(std::vector<int>& closest) const;
+	void WriteAreas(CCircuitAI* circuit);
+
+	uint64_t cacheKey;
 
 // ---- Threaded areas updater ---- BEGIN
 private:
 	void EnqueueUpdate();
 	void UpdateAreas();
+	bool IsSectorPassable(const STerrainMapMobileType& mt, const STerrainMapSector& s) const;
+	void RefloodAreas(STerrainMapMobileType& mt, const STerrainMapMobileType& prevMt,
+			const std::vector<int>& changedSectors);
 	void ScheduleUsersUpdate();
 public:
 	void OnAreaUsersUpdated();
@@ -378,14 +378,7 @@ AIFloat3 CTerrainManager::FindBuildSite(CCircuitDef* cdef, const AIFloat3& pos,
 
 	auto isOpenSite = [this](const int2& s1, const int2& s2) {
 		const SBlockingMap::SM notIgnore = static_cast<SBlockingMap::SM>(SBlockingMap::StructMask::ALL);
-		for (int z = s1.y; z < s2.y; ++z) {
-			for (int x = s1.x; x < s2.x; ++x) {
-				if (blockingMap.IsBlocked(x, z, notIgnore)) {
-					return false;
-				}
-			}
-		}
-		return true;
+		return !blockingMap.IsBlockedArea(s1, s2, notIgnore);
 	};
 
 	const int endr = (int)(searchRadius / (SQUARE_SIZE * 2));
@@ -595,14 +588,7 @@ AIFloat3 CTerrainManager::FindBuildSiteLow(CCircuitDef* cdef, const AIFloat3& po
 
 	auto isOpenSite = [this](const int2& s1, const int2& s2) {
 		const SBlockingMap::SM notIgnore = static_cast<SBlockingMap::SM>(SBlockingMap::StructMask::ALL);
-		for (int z = s1.y; z < s2.y; z++) {
-			for (int x = s1.x; x < s2.x; x++) {
-				if (blockingMap.IsBlocked(x, z, notIgnore)) {
-					return false;
-				}
-			}
-		}
-		return true;
+		return !blockingMap.IsBlockedArea(s1, s2, notIgnore);
 	};
 
 	const int endr = (int)(searchRadius / (SQUARE_SIZE * 2));
@@ -684,7 +670,15 @@ AIFloat3 CTerrainManager::FindBuildSiteByMask(CCircuitDef* cdef, const AIFloat3&
 	}
 
 #define DECLARE_TEST(testName, facingType)																	\
-	auto testName = [this, mask, notIgnore, structMask](const int2& m1, const int2& m2, const int2& om) {	\
+	auto testName = [this, mask, notIgnore, structMask, &sr1, &sr2](const int2& m1, const int2& m2, const int2& om) {	\
+		if (!blockingMap.IsBlockedArea(m1, m2, notIgnore) && !blockingMap.IsStructedArea(m1, m2, structMask)) {	\
+			return true;																					\
+		}																									\
+		const int2 s1(std::max(m1.x - om.x + sr1.x, m1.x), std::max(m1.y - om.y + sr1.y, m1.y));			\
+		const int2 s2(std::min(m1.x - om.x + sr2.x, m2.x), std::min(m1.y - om.y + sr2.y, m2.y));			\
+		if (blockingMap.IsBlockedArea(s1, s2, notIgnore)) {													\
+			return false;																					\
+		}																									\
 		for (int z = m1.y, zm = om.y; z < m2.y; z++, zm++) {												\
 			for (int x = m1.x, xm = om.x; x < m2.x; x++, xm++) {											\
 				switch (mask->facingType(xm, zm)) {															\
@@ -719,6 +713,8 @@ AIFloat3 CTerrainManager::FindBuildSiteByMask(CCircuitDef* cdef, const AIFloat3&
 
 	const int notIgnore = ~mask->GetIgnoreMask();
 	SBlockingMap::StructMask structMask = SBlockingMap::GetStructMask(mask->GetStructType());
+	int2 sr1, sr2;  // STRUCT cells of the mask
+	mask->GetStructRect(facing, sr1, sr2);
 
 	AIFloat3 probePos(ZeroVector);
 	CMap* map = circuit->GetMap();
@@ -808,7 +804,15 @@ AIFloat3 CTerrainManager::FindBuildSiteByMaskLow(CCircuitDef* cdef, const AIFloa
 	}
 
 #define DECLARE_TEST_LOW(testName, facingType)																\
-	auto testName = [this, mask, notIgnore, structMask](const int2& m1, const int2& m2, const int2& om) {	\
+	auto testName = [this, mask, notIgnore, structMask, &sr1, &sr2](const int2& m1, const int2& m2, const int2& om) {	\
+		if (!blockingMap.IsBlockedArea(m1, m2, notIgnore) && !blockingMap.IsStructedArea(m1, m2, structMask)) {	\
+			return true;																					\
+		}																									\
+		const int2 s1(std::max(m1.x - om.x + sr1.x, m1.x), std::max(m1.y - om.y + sr1.y, m1.y));			\
+		const int2 s2(std::min(m1.x - om.x + sr2.x, m2.x), std::min(m1.y - om.y + sr2.y, m2.y));			\
+		if (blockingMap.IsBlockedArea(s1, s2, notIgnore)) {													\
+			return false;																					\
+		}																									\
 		for (int z = m1.y, zm = om.y; z < m2.y; z++, zm++) {												\
 			for (int x = m1.x, xm = om.x; x < m2.x; x++, xm++) {											\
 				switch (mask->facingType(xm, zm)) {															\
@@ -848,6 +852,8 @@ AIFloat3 CTerrainManager::FindBuildSiteByMaskLow(CCircuitDef* cdef, const AIFloa
 
 	const int notIgnore = ~mask->GetIgnoreMask();
 	SBlockingMap::StructMask structMask = SBlockingMap::GetStructMask(mask->GetStructType());
+	int2 sr1, sr2;  // STRUCT cells of the mask
+	mask->GetStructRect(facing, sr1, sr2);
 
 	AIFloat3 probePos(ZeroVector);
 	CMap* map = circuit->GetMap();
@@ -1138,72 +1144,29 @@ std::vector<STerrainMapAreaSector>& CTerrainManager::GetSectorList(STerrainMapAr
 
 STerrainMapAreaSector* CTerrainManager::GetClosestSector(STerrainMapArea* sourceArea, const int destinationSIndex)
 {
-	auto iAS = sourceArea->sectorClosest.find(destinationSIndex);
-	if (iAS != sourceArea->sectorClosest.end()) {  // It's already been determined
-		return iAS->second;
-	}
-
-	std::vector<STerrainMapAreaSector>& TMSectors = GetSectorList(sourceArea);
-	if (sourceArea == TMSectors[destinationSIndex].area) {
-		sourceArea->sectorClosest[destinationSIndex] = &TMSectors[destinationSIndex];
-		return &TMSectors[destinationSIndex];
-	}
-
-	AIFloat3* destination = &TMSectors[destinationSIndex].S->position;
-	STerrainMapAreaSector* SClosest = nullptr;
-	float sqDisClosest = std::numeric_limits<float>::max();
-	for (auto& iS : sourceArea->sector) {
-		float sqDist = iS.second->S->position.SqDistance2D(*destination);  // TODO: Consider SqDistance() instead of 2D
-		if (sqDist < sqDisClosest) {
-			SClosest = iS.second;
-			sqDisClosest = sqDist;
-		}
-	}
-	sourceArea->sectorClosest[destinationSIndex] = SClosest;
-	return SClosest;
+	return &GetSectorList(sourceArea)[sourceArea->sectorClosest[destinationSIndex]];
 }
 
 STerrainMapSector* CTerrainManager::GetClosestSector(STerrainMapImmobileType* sourceIT, const int destinationSIndex)
 {
-	auto iS = sourceIT->sectorClosest.find(destinationSIndex);
-	if (iS != sourceIT->sectorClosest.end()) {  // It's already been determined
-		return iS->second;
-	}
-
-	if (sourceIT->sector.find(destinationSIndex) != sourceIT->sector.end()) {
-		STerrainMapSector* SClosest = &areaData->sector[destinationSIndex];
-		sourceIT->sectorClosest[destinationSIndex] = SClosest;
-		return SClosest;
-	}
-
-	const AIFloat3* destination = &areaData->sector[destinationSIndex].position;
-	STerrainMapSector* SClosest = nullptr;
-	float sqDisClosest = std::numeric_limits<float>::max();
-	for (auto& iS : sourceIT->sector) {
-		float sqDist = iS.second->position.SqDistance2D(*destination);  // TODO: Consider SqDistance() instead of 2D
-		if (sqDist < sqDisClosest) {
-			SClosest = iS.second;
-			sqDisClosest = sqDist;
-		}
-	}
-	sourceIT->sectorClosest[destinationSIndex] = SClosest;
-	return SClosest;
+	const int iS = sourceIT->sectorClosest[destinationSIndex];
+	return (iS < 0) ? nullptr : &areaData->sector[iS];
 }
 
 STerrainMapAreaSector* CTerrainManager::GetAlternativeSector(STerrainMapArea* sourceArea, const int sourceSIndex, STerrainMapMobileType* destinationMT)
 {
 	std::vector<STerrainMapAreaSector>& TMSectors = GetSectorList(sourceArea);
-	auto iMS = TMSectors[sourceSIndex].sectorAlternativeM.find(destinationMT);
-	if (iMS != TMSectors[sourceSIndex].sectorAlternativeM.end()) {  // It's already been determined
-		return iMS->second;
-	}
-
 	if (destinationMT == nullptr) {  // flying unit movetype
 		return &TMSectors[sourceSIndex];
 	}
 
-	if ((sourceArea != nullptr) && (sourceArea != TMSectors[sourceSIndex].area)) {
-		return GetAlternativeSector(sourceArea, GetSectorIndex(GetClosestSector(sourceArea, sourceSIndex)->S->position), destinationMT);
+	if (sourceArea == nullptr) {  // precomputed, @see CTerrainData::MakeClosestSectors
+		const int iS = destinationMT->sectorAlternative[sourceSIndex];
+		return (iS < 0) ? nullptr : &destinationMT->sector[iS];
+	}
+
+	if (sourceArea != TMSectors[sourceSIndex].area) {
+		return GetAlternativeSector(sourceArea, sourceArea->sectorClosest[sourceSIndex], destinationMT);
 	}
 
 	const AIFloat3& position = TMSectors[sourceSIndex].S->position;
@@ -1211,15 +1174,16 @@ STerrainMapAreaSector* CTerrainManager::GetAlternativeSector(STerrainMapArea* so
 	STerrainMapArea* largestArea = destinationMT->areaLargest;
 	float bestDistance = -1.0;
 	float bestMidDistance = -1.0;
-	const std::vector<STerrainMapArea>& TMAreas = destinationMT->area;
+	std::vector<STerrainMapArea>& TMAreas = destinationMT->area;
 	for (auto& area : TMAreas) {
 		if (area.areaUsable || !largestArea->areaUsable) {
-			STerrainMapAreaSector* CAS = GetClosestSector(const_cast<STerrainMapArea*>(&area), sourceSIndex);
+			STerrainMapAreaSector* CAS = GetClosestSector(&area, sourceSIndex);
+			const int iCAS = area.sectorClosest[sourceSIndex];
 			float midDistance; // how much of a gap exists between the two areas (source & destination)
-			if ((sourceArea == nullptr) || (sourceArea == TMSectors[GetSectorIndex(CAS->S->position)].area)) {
+			if (sourceArea == TMSectors[iCAS].area) {
 				midDistance = 0.0;
 			} else {
-				midDistance = CAS->S->position.distance2D(GetClosestSector(sourceArea, GetSectorIndex(CAS->S->position))->S->position);
+				midDistance = CAS->S->position.distance2D(GetClosestSector(sourceArea, iCAS)->S->position);
 			}
 			if ((bestMidDistance < 0) || (midDistance < bestMidDistance)) {
 				bestMidDistance = midDistance;
@@ -1235,38 +1199,13 @@ STerrainMapAreaSector* CTerrainManager::GetAlternativeSector(STerrainMapArea* so
 			}
 		}
 	}
-
-	TMSectors[sourceSIndex].sectorAlternativeM[destinationMT] = bestAS;
 	return bestAS;
 }
 
 STerrainMapSector* CTerrainManager::GetAlternativeSector(STerrainMapArea* destinationArea, const int sourceSIndex, STerrainMapImmobileType* destinationIT)
 {
-	std::vector<STerrainMapAreaSector>& TMSectors = GetSectorList(destinationArea);
-	auto iMS = TMSectors[sourceSIndex].sectorAlternativeI.find(destinationIT);
-	if (iMS != TMSectors[sourceSIndex].sectorAlternativeI.end()) {  // It's already been determined
-		return iMS->second;
-	}
-
-	STerrainMapSector* closestS = nullptr;
-	if (destinationArea != nullptr) {
-		if (destinationArea != TMSectors[sourceSIndex].area) {
-			closestS = GetAlternativeSector(destinationArea, GetSectorIndex(GetClosestSector(destinationArea, sourceSIndex)->S->position), destinationIT);
-		} else {
-			const AIFloat3& position = areaData->sector[sourceSIndex].position;
-			float closestDistance = std::numeric_limits<float>::max();
-			for (auto& iS : destinationArea->sector) {
-				float sqDist = iS.second->S->position.SqDistance2D(position);  // TODO: Consider SqDistance() instead of 2D
-				if (sqDist < closestDistance) {
-					closestS = iS.second->S;
-					closestDistance = sqDist;
-				}
-			}
-		}
-	}
-
-	TMSectors[sourceSIndex].sectorAlternativeI[destinationIT] = closestS;
-	return closestS;
+	// NOTE: Closest sector of destinationArea, destinationIT doesn't affect result
+	return (destinationArea == nullptr) ? nullptr : &areaData->sector[destinationArea->sectorClosest[sourceSIndex]];
 }
 
 // NOTE: Slow after terra-update with many calls in single frame
@@ -1415,7 +1354,7 @@ void CTerrainManager::UpdateAreaUsers(int interval)
 	circuit->GetBuilderManager()->UpdateAreaUsers();
 
 	// stagger area update
-	circuit->GetScheduler()->RunTaskAfter(std::make_shared<CGameTask>([this]() {
+	circuit->GetScheduler()->RunTaskAfter(MakeTask([this]() {
 		circuit->GetPathfinder()->UpdateAreaUsers(this);
 
 		OnAreaUsersUpdated();
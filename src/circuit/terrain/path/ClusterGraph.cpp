@@ -0,0 +1,514 @@
+/*
+ * ClusterGraph.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#include "terrain/path/ClusterGraph.h"
+#include "terrain/path/MicroPather.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <cstring>
+
+namespace circuit {
+
+#define PORTAL_RUN		6  // longer border runs get 2 portals at the ends
+#define LONG_PATH		(CLUSTER_SIZE * 3)  // shorter paths don't use hierarchy
+#define MAX_HEURISTIC_GOALS	8
+
+static inline float OctileDistance(int dx, int dy)
+{
+	dx = std::abs(dx);
+	dy = std::abs(dy);
+	return (dx + dy) - 0.5858f * std::min(dx, dy);
+}
+
+/*
+ * Per-thread state of coarse search, shared by all graphs
+ */
+struct SCoarseScratch {
+	std::vector<float> g;
+	std::vector<int> parent;
+	std::vector<unsigned> nodeStamp;  // open or closed in current search
+	std::vector<bool> isClosed;
+	std::vector<float> clusterCost;
+	std::vector<unsigned> costStamp;
+	std::vector<unsigned> goalStamp;
+	std::vector<unsigned> corridorStamp;
+	std::vector<std::pair<float, int>> open;
+	std::unique_ptr<bool[]> mask;
+	size_t maskSize = 0;
+	unsigned stamp = 0;
+};
+static thread_local SCoarseScratch scratch;
+
+CClusterGraph::CClusterGraph(int moveMapXSize, int moveMapYSize, const bool* moveArray)
+		: moveMapXSize(moveMapXSize)
+		, moveMapYSize(moveMapYSize)
+{
+	pathMapXSize = moveMapXSize - 2;
+	pathMapYSize = moveMapYSize - 2;
+	clusterXSize = (pathMapXSize + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	clusterYSize = (pathMapYSize + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+
+	const int clusterCount = GetClusterCount();
+	rightPortals.resize(clusterCount);
+	bottomPortals.resize(clusterCount);
+	clusters.resize(clusterCount);
+	offsets.resize(clusterCount + 1);
+
+	moveCells.assign(moveArray, moveArray + moveMapXSize * moveMapYSize);
+	for (int cy = 0; cy < clusterYSize; ++cy) {
+		for (int cx = 0; cx < clusterXSize; ++cx) {
+			MakeBorders(moveArray, cx, cy);
+		}
+	}
+	for (int cy = 0; cy < clusterYSize; ++cy) {
+		for (int cx = 0; cx < clusterXSize; ++cx) {
+			MakeCluster(moveArray, cx, cy);
+		}
+	}
+	Link();
+}
+
+CClusterGraph::CClusterGraph(const CClusterGraph& prev, const bool* moveArray)
+		: CClusterGraph(prev)
+{
+	std::vector<bool> dirty(GetClusterCount(), false);
+	for (int y = 1; y < moveMapYSize - 1; ++y) {
+		for (int x = 1; x < moveMapXSize - 1; ++x) {
+			const int index = y * moveMapXSize + x;
+			if (moveCells[index] != moveArray[index]) {
+				moveCells[index] = moveArray[index];
+				dirty[MoveXY2Cluster(x, y)] = true;
+			}
+		}
+	}
+	Update(moveArray, dirty);
+}
+
+CClusterGraph::~CClusterGraph()
+{
+}
+
+void CClusterGraph::Update(const bool* moveArray, const std::vector<bool>& dirty)
+{
+	std::vector<bool> rebuild(GetClusterCount(), false);
+	bool isDirty = false;
+	for (int cy = 0; cy < clusterYSize; ++cy) {
+		for (int cx = 0; cx < clusterXSize; ++cx) {
+			if (!dirty[cy * clusterXSize + cx]) {
+				continue;
+			}
+			isDirty = true;
+			// Borders are owned by the left/top cluster
+			MakeBorders(moveArray, cx, cy);
+			rebuild[cy * clusterXSize + cx] = true;
+			if (cx > 0) {
+				MakeBorders(moveArray, cx - 1, cy);
+				rebuild[cy * clusterXSize + cx - 1] = true;
+			}
+			if (cy > 0) {
+				MakeBorders(moveArray, cx, cy - 1);
+				rebuild[(cy - 1) * clusterXSize + cx] = true;
+			}
+			if (cx < clusterXSize - 1) {
+				rebuild[cy * clusterXSize + cx + 1] = true;
+			}
+			if (cy < clusterYSize - 1) {
+				rebuild[(cy + 1) * clusterXSize + cx] = true;
+			}
+		}
+	}
+	if (!isDirty) {
+		return;
+	}
+
+	for (int cy = 0; cy < clusterYSize; ++cy) {
+		for (int cx = 0; cx < clusterXSize; ++cx) {
+			if (rebuild[cy * clusterXSize + cx]) {
+				MakeCluster(moveArray, cx, cy);
+			}
+		}
+	}
+	Link();
+}
+
+const bool* CClusterGraph::MakeCorridor(const bool* moveArray, const float* costArray,
+		void* startNode, const VoidVec& goalNodes) const
+{
+	if (goalNodes.empty()) {
+		return nullptr;
+	}
+
+	const int startCell = (size_t)startNode;
+	const int sy = startCell / moveMapXSize;
+	const int sx = startCell - sy * moveMapXSize;
+	if ((sx < 1) || (sx > pathMapXSize) || (sy < 1) || (sy > pathMapYSize)) {
+		return nullptr;
+	}
+	const int startCluster = MoveXY2Cluster(sx, sy);
+
+	const int numNodes = twins.size();
+	const int clusterCount = GetClusterCount();
+	SCoarseScratch& s = scratch;
+	if (s.g.size() < (size_t)numNodes) {
+		s.g.resize(numNodes);
+		s.parent.resize(numNodes);
+		s.nodeStamp.resize(numNodes, 0);
+		s.isClosed.resize(numNodes);
+	}
+	if (s.clusterCost.size() < (size_t)clusterCount) {
+		s.clusterCost.resize(clusterCount);
+		s.costStamp.resize(clusterCount, 0);
+		s.goalStamp.resize(clusterCount, 0);
+		s.corridorStamp.resize(clusterCount, 0);
+	}
+	const unsigned stamp = ++s.stamp;
+
+	// Goals and short path check
+	std::vector<int> goalXY;  // NOTE: few goals, heuristic only
+	float minDist = std::numeric_limits<float>::max();
+	for (void* node : goalNodes) {
+		const int cell = (size_t)node;
+		const int y = std::min(std::max(cell / moveMapXSize, 1), pathMapYSize);
+		const int x = std::min(std::max(cell - (cell / moveMapXSize) * moveMapXSize, 1), pathMapXSize);
+		s.goalStamp[MoveXY2Cluster(x, y)] = stamp;
+		minDist = std::min(minDist, OctileDistance(x - sx, y - sy));
+		if (goalNodes.size() <= MAX_HEURISTIC_GOALS) {
+			goalXY.push_back(x);
+			goalXY.push_back(y);
+		}
+	}
+	if ((minDist < LONG_PATH) || (s.goalStamp[startCluster] == stamp)) {
+		return nullptr;
+	}
+
+	// Mean cell cost of cluster, lazy
+	auto clusterCost = [this, costArray, &s, stamp](int c) {
+		if (s.costStamp[c] != stamp) {
+			const int cy = c / clusterXSize;
+			const int cx = c - cy * clusterXSize;
+			const int x0 = cx * CLUSTER_SIZE;
+			const int x1 = std::min(x0 + CLUSTER_SIZE, pathMapXSize);
+			const int y0 = cy * CLUSTER_SIZE;
+			const int y1 = std::min(y0 + CLUSTER_SIZE, pathMapYSize);
+			float sum = 0.f;
+			for (int y = y0; y < y1; ++y) {
+				const float* row = &costArray[y * pathMapXSize];
+				for (int x = x0; x < x1; ++x) {
+					sum += row[x];
+				}
+			}
+			s.clusterCost[c] = COST_BASE + sum / ((x1 - x0) * (y1 - y0));
+			s.costStamp[c] = stamp;
+		}
+		return s.clusterCost[c];
+	};
+	auto heuristic = [this, &goalXY](int cell) {
+		const int y = cell / moveMapXSize;
+		const int x = cell - y * moveMapXSize;
+		float h = std::numeric_limits<float>::max();
+		for (unsigned i = 0; i < goalXY.size(); i += 2) {
+			h = std::min(h, OctileDistance(goalXY[i] - x, goalXY[i + 1] - y));
+		}
+		return goalXY.empty() ? 0.f : h * COST_BASE;
+	};
+
+	std::vector<std::pair<float, int>>& open = s.open;
+	open.clear();
+	auto push = [this, &s, &open, stamp, &heuristic](int node, float g, int parent) {
+		if ((s.nodeStamp[node] == stamp) && (s.isClosed[node] || (s.g[node] <= g))) {
+			return;
+		}
+		s.nodeStamp[node] = stamp;
+		s.isClosed[node] = false;
+		s.g[node] = g;
+		s.parent[node] = parent;
+		open.push_back(std::make_pair(g + heuristic(nodeCells[node]), node));
+		std::push_heap(open.begin(), open.end(), std::greater<std::pair<float, int>>());
+	};
+
+	// Connect start to nodes of its cluster
+	{
+		const int cy = startCluster / clusterXSize;
+		const int cx = startCluster - cy * clusterXSize;
+		float dist[CLUSTER_SIZE * CLUSTER_SIZE];
+		CellDistances(moveArray, cx, cy, startCell, dist);
+		const SCluster& cluster = clusters[startCluster];
+		const float cost = clusterCost(startCluster);
+		const int x0 = cx * CLUSTER_SIZE + 1;
+		const int y0 = cy * CLUSTER_SIZE + 1;
+		for (unsigned i = 0; i < cluster.nodes.size(); ++i) {
+			const int y = cluster.nodes[i] / moveMapXSize;
+			const int x = cluster.nodes[i] - y * moveMapXSize;
+			const float d = dist[(y - y0) * CLUSTER_SIZE + (x - x0)];
+			if (d >= 0.f) {
+				push(offsets[startCluster] + i, d * cost, -1);
+			}
+		}
+	}
+
+	int found = -1;
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<std::pair<float, int>>());
+		const int node = open.back().second;
+		open.pop_back();
+		if (s.isClosed[node]) {
+			continue;
+		}
+		s.isClosed[node] = true;
+
+		const int c = nodeClusters[node];
+		if (s.goalStamp[c] == stamp) {
+			found = node;
+			break;
+		}
+
+		const float g = s.g[node];
+		const float cost = clusterCost(c);
+		const SCluster& cluster = clusters[c];
+		const int n = cluster.nodes.size();
+		const int i = node - offsets[c];
+		for (int j = 0; j < n; ++j) {
+			const float d = cluster.dist[i * n + j];
+			if ((j != i) && (d >= 0.f)) {
+				push(offsets[c] + j, g + d * cost, node);
+			}
+		}
+		const int twin = twins[node];
+		push(twin, g + 0.5f * (cost + clusterCost(nodeClusters[twin])), node);
+	}
+	if (found < 0) {
+		return nullptr;
+	}
+
+	// Corridor: clusters of the coarse path, dilated by 1
+	s.corridorStamp[startCluster] = stamp;
+	for (int node = found; node >= 0; node = s.parent[node]) {
+		s.corridorStamp[nodeClusters[node]] = stamp;
+	}
+
+	const size_t maskSize = moveMapXSize * moveMapYSize;
+	if (s.maskSize < maskSize) {
+		s.mask.reset(new bool[maskSize]);
+		s.maskSize = maskSize;
+	}
+	bool* mask = s.mask.get();
+	memset(mask, 0, maskSize * sizeof(bool));
+	for (int cy = 0; cy < clusterYSize; ++cy) {
+		for (int cx = 0; cx < clusterXSize; ++cx) {
+			bool isCorridor = false;
+			for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, clusterYSize - 1); ++ny) {
+				for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, clusterXSize - 1); ++nx) {
+					isCorridor |= (s.corridorStamp[ny * clusterXSize + nx] == stamp);
+				}
+			}
+			if (!isCorridor) {
+				continue;
+			}
+			const int x0 = cx * CLUSTER_SIZE + 1;
+			const int x1 = std::min(x0 + CLUSTER_SIZE, pathMapXSize + 1);
+			const int y0 = cy * CLUSTER_SIZE + 1;
+			const int y1 = std::min(y0 + CLUSTER_SIZE, pathMapYSize + 1);
+			for (int y = y0; y < y1; ++y) {
+				const int index = y * moveMapXSize + x0;
+				memcpy(&mask[index], &moveArray[index], (x1 - x0) * sizeof(bool));
+			}
+		}
+	}
+	return mask;
+}
+
+void CClusterGraph::MakeBorders(const bool* moveArray, int cx, int cy)
+{
+	const int c = cy * clusterXSize + cx;
+	const int x0 = cx * CLUSTER_SIZE + 1;
+	const int x1 = std::min(x0 + CLUSTER_SIZE, pathMapXSize + 1);
+	const int y0 = cy * CLUSTER_SIZE + 1;
+	const int y1 = std::min(y0 + CLUSTER_SIZE, pathMapYSize + 1);
+
+	auto addRun = [](std::vector<int>& portals, int begin, int end) {
+		const int len = end - begin;
+		if (len < PORTAL_RUN) {
+			portals.push_back(begin + len / 2);
+		} else {
+			portals.push_back(begin);
+			portals.push_back(end - 1);
+		}
+	};
+
+	std::vector<int>& right = rightPortals[c];
+	right.clear();
+	if (cx < clusterXSize - 1) {
+		const int xl = x1 - 1;
+		int begin = -1;
+		for (int y = y0; y < y1; ++y) {
+			const bool isOpen = moveArray[y * moveMapXSize + xl] && moveArray[y * moveMapXSize + xl + 1];
+			if (isOpen && (begin < 0)) {
+				begin = y;
+			} else if (!isOpen && (begin >= 0)) {
+				addRun(right, begin, y);
+				begin = -1;
+			}
+		}
+		if (begin >= 0) {
+			addRun(right, begin, y1);
+		}
+	}
+
+	std::vector<int>& bottom = bottomPortals[c];
+	bottom.clear();
+	if (cy < clusterYSize - 1) {
+		const int yt = y1 - 1;
+		int begin = -1;
+		for (int x = x0; x < x1; ++x) {
+			const bool isOpen = moveArray[yt * moveMapXSize + x] && moveArray[(yt + 1) * moveMapXSize + x];
+			if (isOpen && (begin < 0)) {
+				begin = x;
+			} else if (!isOpen && (begin >= 0)) {
+				addRun(bottom, begin, x);
+				begin = -1;
+			}
+		}
+		if (begin >= 0) {
+			addRun(bottom, begin, x1);
+		}
+	}
+}
+
+void CClusterGraph::MakeCluster(const bool* moveArray, int cx, int cy)
+{
+	const int c = cy * clusterXSize + cx;
+	const int x0 = cx * CLUSTER_SIZE + 1;
+	const int x1 = std::min(x0 + CLUSTER_SIZE, pathMapXSize + 1);
+	const int y0 = cy * CLUSTER_SIZE + 1;
+	const int y1 = std::min(y0 + CLUSTER_SIZE, pathMapYSize + 1);
+
+	SCluster& cluster = clusters[c];
+	std::vector<int>& nodes = cluster.nodes;
+	nodes.clear();
+	cluster.border[0] = nodes.size();
+	if (cx > 0) {
+		for (int y : rightPortals[c - 1]) {
+			nodes.push_back(y * moveMapXSize + x0);
+		}
+	}
+	cluster.border[1] = nodes.size();
+	for (int y : rightPortals[c]) {
+		nodes.push_back(y * moveMapXSize + x1 - 1);
+	}
+	cluster.border[2] = nodes.size();
+	if (cy > 0) {
+		for (int x : bottomPortals[c - clusterXSize]) {
+			nodes.push_back(y0 * moveMapXSize + x);
+		}
+	}
+	cluster.border[3] = nodes.size();
+	for (int x : bottomPortals[c]) {
+		nodes.push_back((y1 - 1) * moveMapXSize + x);
+	}
+	cluster.border[4] = nodes.size();
+
+	const int n = nodes.size();
+	cluster.dist.resize(n * n);
+	float dist[CLUSTER_SIZE * CLUSTER_SIZE];
+	for (int i = 0; i < n; ++i) {
+		CellDistances(moveArray, cx, cy, nodes[i], dist);
+		for (int j = 0; j < n; ++j) {
+			const int y = nodes[j] / moveMapXSize;
+			const int x = nodes[j] - y * moveMapXSize;
+			cluster.dist[i * n + j] = dist[(y - y0) * CLUSTER_SIZE + (x - x0)];
+		}
+	}
+}
+
+void CClusterGraph::Link()
+{
+	const int clusterCount = GetClusterCount();
+	offsets[0] = 0;
+	for (int c = 0; c < clusterCount; ++c) {
+		offsets[c + 1] = offsets[c] + clusters[c].nodes.size();
+	}
+	const int numNodes = offsets[clusterCount];
+	nodeClusters.resize(numNodes);
+	nodeCells.resize(numNodes);
+	twins.resize(numNodes);
+	for (int c = 0; c < clusterCount; ++c) {
+		std::fill(nodeClusters.begin() + offsets[c], nodeClusters.begin() + offsets[c + 1], c);
+		std::copy(clusters[c].nodes.begin(), clusters[c].nodes.end(), nodeCells.begin() + offsets[c]);
+	}
+
+	for (int c = 0; c < clusterCount; ++c) {
+		const int right = offsets[c] + clusters[c].border[1];
+		for (unsigned k = 0; k < rightPortals[c].size(); ++k) {
+			const int other = offsets[c + 1] + clusters[c + 1].border[0] + k;
+			twins[right + k] = other;
+			twins[other] = right + k;
+		}
+		const int bottom = offsets[c] + clusters[c].border[3];
+		for (unsigned k = 0; k < bottomPortals[c].size(); ++k) {
+			const int b = c + clusterXSize;
+			const int other = offsets[b] + clusters[b].border[2] + k;
+			twins[bottom + k] = other;
+			twins[other] = bottom + k;
+		}
+	}
+}
+
+/*
+ * In-cluster Dijkstra from startCell, dist is CLUSTER_SIZE^2 local grid, < 0 if unreachable.
+ * Start may be blocked (same as CMicroPather), diagonal moves don't check corners (same as CMicroPather).
+ */
+void CClusterGraph::CellDistances(const bool* moveArray, int cx, int cy, int startCell, float* dist) const
+{
+	const int x0 = cx * CLUSTER_SIZE + 1;
+	const int x1 = std::min(x0 + CLUSTER_SIZE, pathMapXSize + 1);
+	const int y0 = cy * CLUSTER_SIZE + 1;
+	const int y1 = std::min(y0 + CLUSTER_SIZE, pathMapYSize + 1);
+	std::fill(dist, dist + CLUSTER_SIZE * CLUSTER_SIZE, -1.f);
+
+	static thread_local std::vector<std::pair<float, int>> open;
+	open.clear();
+	const int sy = startCell / moveMapXSize;
+	const int sx = startCell - sy * moveMapXSize;
+	dist[(sy - y0) * CLUSTER_SIZE + (sx - x0)] = 0.f;
+	open.push_back(std::make_pair(0.f, startCell));
+
+	constexpr int dx[8] = {-1, 1, 0, 0, -1, 1, -1, 1};
+	constexpr int dy[8] = {0, 0, 1, -1, -1, -1, 1, 1};
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<std::pair<float, int>>());
+		const float d = open.back().first;
+		const int cell = open.back().second;
+		open.pop_back();
+		const int y = cell / moveMapXSize;
+		const int x = cell - y * moveMapXSize;
+		if (d > dist[(y - y0) * CLUSTER_SIZE + (x - x0)]) {
+			continue;
+		}
+		for (int i = 0; i < 8; ++i) {
+			const int nx = x + dx[i];
+			const int ny = y + dy[i];
+			if ((nx < x0) || (nx >= x1) || (ny < y0) || (ny >= y1)) {
+				continue;
+			}
+			const int next = ny * moveMapXSize + nx;
+			if (!moveArray[next]) {
+				continue;
+			}
+			const float nd = d + ((i > 3) ? SQRT_2 : 1.f);
+			float& old = dist[(ny - y0) * CLUSTER_SIZE + (nx - x0)];
+			if ((old < 0.f) || (nd < old)) {
+				old = nd;
+				open.push_back(std::make_pair(nd, next));
+				std::push_heap(open.begin(), open.end(), std::greater<std::pair<float, int>>());
+			}
+		}
+	}
+}
+
+} // namespace circuit
@@ -0,0 +1,86 @@
+/*
+ * ClusterGraph.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_TERRAIN_PATH_CLUSTERGRAPH_H_
+#define SRC_CIRCUIT_TERRAIN_PATH_CLUSTERGRAPH_H_
+
+#include "util/Defines.h"
+
+#include <vector>
+
+namespace circuit {
+
+#define CLUSTER_SIZE	16  // path-map cells per cluster side
+
+/*
+ * Abstract graph for hierarchical A* (HPA*).
+ * Path-map is split into CLUSTER_SIZE^2 clusters, every passable run along a cluster border
+ * gives portals: pair of nodes, one at each side. Nodes of a cluster are linked by in-cluster distances.
+ * Coarse search over the graph selects a corridor of clusters, full-res A* runs inside of it.
+ * Cells are move-map indices (+2 edges), same as CPathFinder's moveArrays.
+ * Graph is built off main thread and never changed afterwards: area update makes a new graph
+ * from the previous one, queries hold shared_ptr<const CClusterGraph> of their own.
+ */
+class CClusterGraph {
+public:
+	// Full build
+	CClusterGraph(int moveMapXSize, int moveMapYSize, const bool* moveArray);
+	// Copy of prev with changed clusters (and borders with neighbours) rebuilt
+	CClusterGraph(const CClusterGraph& prev, const bool* moveArray);
+	~CClusterGraph();
+
+	int GetClusterCount() const { return clusterXSize * clusterYSize; }
+	int MoveXY2Cluster(int x, int y) const {
+		return ((y - 1) / CLUSTER_SIZE) * clusterXSize + (x - 1) / CLUSTER_SIZE;
+	}
+
+	/*
+	 * Thread-safe.
+	 * Returns moveArray restricted to corridor clusters (thread-local buffer, valid until next call),
+	 * nullptr if path is short or coarse search failed: full-res search over moveArray should be used.
+	 * costArray is per path-map cell, same as CMicroPather's.
+	 */
+	const bool* MakeCorridor(const bool* moveArray, const float* costArray,
+			void* startNode, const VoidVec& goalNodes) const;
+
+private:
+	struct SCluster {
+		std::vector<int> nodes;  // move-map cell of each node
+		std::vector<float> dist;  // nodes x nodes in-cluster distance, < 0 if unreachable
+		int border[5];  // start of left, right, top, bottom portals in nodes; end
+	};
+
+	CClusterGraph(const CClusterGraph&) = default;
+
+	void Update(const bool* moveArray, const std::vector<bool>& dirty);
+	void MakeBorders(const bool* moveArray, int cx, int cy);
+	void MakeCluster(const bool* moveArray, int cx, int cy);
+	void Link();
+	void CellDistances(const bool* moveArray, int cx, int cy, int startCell, float* dist) const;
+
+	int moveMapXSize;  // +2 for edges
+	int moveMapYSize;  // +2 for edges
+	int pathMapXSize;
+	int pathMapYSize;
+	int clusterXSize;
+	int clusterYSize;
+
+	BoolVec moveCells;  // moveArray the graph is built of
+	std::vector<std::vector<int>> rightPortals;  // y of portals at border with right neighbour
+	std::vector<std::vector<int>> bottomPortals;  // x of portals at border with bottom neighbour
+	std::vector<SCluster> clusters;
+
+	// Global node id = offsets[cluster] + local node
+	std::vector<int> offsets;
+	std::vector<int> nodeClusters;
+	std::vector<int> nodeCells;
+	std::vector<int> twins;  // node on the other side of border
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_TERRAIN_PATH_CLUSTERGRAPH_H_
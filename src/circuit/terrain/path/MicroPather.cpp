@@ -44,6 +44,7 @@
  */
 
 #include "terrain/path/MicroPather.h"
+#include "terrain/path/OpenQueue.h"
 #include "terrain/path/PathFinder.h"
 #include "util/Defines.h"
 
@@ -52,6 +53,8 @@
 #include <cstdint>
 #include <limits>
 #include <array>
+#include <vector>
+#include <algorithm>
 #include <functional>
 //#undef NDEBUG
 #include <cassert>
@@ -64,123 +67,15 @@
 
 using namespace NSMicroPather;
 
-class OpenQueueBH {
-public:
-	OpenQueueBH(PathNode** heapArray)
-		: heapArray(heapArray)
-		, size(0)
-	{}
+constexpr size_t NSMicroPather::OpenQueueBucket::NUM_BUCKETS;
+constexpr size_t NSMicroPather::OpenQueueBucket::BUCKET_MASK;
 
-	~OpenQueueBH() {}
-
-	void Push(PathNode* pNode) {
-		pNode->inOpen = 1;
-
-		if (size > 0) {
-			size++;
-			heapArray[size] = pNode;
-			pNode->myIndex =  size;
-
-			int i = size;
-
-			while((i > 1) && (heapArray[i >> 1]->totalCost > heapArray[i]->totalCost)) {
-				// L("Swap them: " << i);
-				PathNode* temp = heapArray[i >> 1];
-				heapArray[i >> 1] = heapArray[i];
-				heapArray[i] = temp;
-
-				temp->myIndex = i;
-				heapArray[i >> 1]->myIndex = i >> 1;
-
-				i >>= 1;
-			}
-		} else {
-			// tree was empty
-			size++;
-			heapArray[1] = pNode;
-			pNode->myIndex = size;
-		}
-	}
-
-	void Update(PathNode* pNode) {
-		if (size > 1) {
-			// heapify now
-			int i = pNode->myIndex;
-
-			while (i > 1 && ((heapArray[i >> 1]->totalCost) > (heapArray[i]->totalCost))) {
-				// swap them
-				PathNode* temp = heapArray[i >> 1];
-				heapArray[i >> 1] = heapArray[i];
-				heapArray[i] = temp;
-
-				temp->myIndex = i;
-				heapArray[i >> 1]->myIndex = i >> 1;
-				i >>= 1;
-			}
-		}
-	}
-
-	PathNode* Pop() {
-		// get the first one
-		PathNode* min = heapArray[1];
-		min->inOpen = 0;
-		heapArray[1] = heapArray[size];
-		size--;
-
-		if (size == 0) {
-			return min;
-		}
-
-		heapArray[1]->myIndex = 1;
-		# define Parent(x) (x >> 1)
-		# define Left(x)  (x << 1)
-		# define Right(x) ((x << 1) + 1)
-
-		// fix the heap
-		int index = 1;
-		int smalest = 1;
-
-		bool heapFixed = false;
-
-		while (!heapFixed) {
-			index = smalest;
-
-			const int left = Left(index);
-			const int right = Right(index);
-
-			if (left <= size && ((heapArray[left]->totalCost) < (heapArray[index]->totalCost)))
-				smalest = left;
-			else
-				smalest = index;
-
-			if (right <= size && ((heapArray[right]->totalCost) < (heapArray[smalest]->totalCost)))
-				smalest = right;
-
-			if (smalest != index) {
-				// swap them
-				PathNode* temp = heapArray[index];
-				heapArray[index] = heapArray[smalest];
-				heapArray[smalest] = temp;
-
-				temp->myIndex = smalest;
-				heapArray[index]->myIndex = index;
-			} else {
-				heapFixed = true;
-			}
-		}
-
-		return min;
-	}
-
-	int Size() const { return size; }
-	bool Empty() {
-		return (size == 0);
-	}
-
-private:
-	PathNode** heapArray;
-	int size;
-};
+/*
+ * Open list policy per query type:
+ * A* total cost isn't monotone - heap, cost map Dijkstra is monotone - buckets.
+ */
+using OpenQueueAStar = OpenQueue4H;
+using OpenQueueDijkstra = OpenQueueBucket;
 
 
 CMicroPather::CMicroPather(const circuit::CPathFinder& pf, int sizeX, int sizeY, int heightSizeX)
@@ -234,20 +129,22 @@ CMicroPather::~CMicroPather()
 {
 	free(pathNodeMemForFree);
 	free(heapArrayMem);
+	free(heapPosMem);
+	delete bucketQueue;
 }
 
 /*
  * Old: make sure that costArray doesn't contain values below 1.0 (for speed), and below 0.0 (for eternal loop)
- * New: make sure that moveThreatFun doesn't return values below 0.0
+ * New: make sure that costArray doesn't contain values below 0.0
  */
-void CMicroPather::SetMapData(const bool* canMoveArray, const float* threatArray,
-		const CostFunc& moveFun, const CostFunc& threatFun, const FloatVec& heightMap)
+void CMicroPather::SetMapData(const bool* canMoveArray, const float* threatArray, const float* costArray,
+		const float* moveCostArray, const FloatVec& heightMap)
 {
-	this->canMoveArray = canMoveArray;
-	this->threatArray  = threatArray;
-	this->moveFun      = moveFun;
-	this->threatFun    = threatFun;
-	this->heightMap    = &heightMap;
+	this->canMoveArray  = canMoveArray;
+	this->threatArray   = threatArray;
+	this->costArray     = costArray;
+	this->moveCostArray = moveCostArray;
+	this->heightMap     = &heightMap;
 }
 
 void CMicroPather::Reset()
@@ -285,7 +182,9 @@ PathNode* CMicroPather::AllocatePathNode()
 		}
 
 		result = newBlock;
-		heapArrayMem = (PathNode**) malloc(sizeof(PathNode*) * ALLOCATE);
+		heapArrayMem = malloc(sizeof(OpenQueue4H::Entry) * ALLOCATE);
+		heapPosMem = (int*) malloc(sizeof(int) * ALLOCATE);
+		bucketQueue = new OpenQueueBucket();
 	}
 	else {
 		// this is bad....
@@ -478,7 +377,7 @@ int CMicroPather::Solve(void* startNode, void* endNode, VoidVec* path, float* co
 	}
 
 	// Make the priority queue
-	OpenQueueBH open(heapArrayMem);
+	OpenQueueAStar open(pathNodeMem, (OpenQueue4H::Entry*)heapArrayMem, heapPosMem);
 
 	{
 		const float estToGoal = LeastCostEstimateLocal( (size_t) startNode);
@@ -621,7 +520,7 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, VoidVec& endNodes
 	}
 
 	// Make the priority queue
-	OpenQueueBH open(heapArrayMem);
+	OpenQueueAStar open(pathNodeMem, (OpenQueue4H::Entry*)heapArrayMem, heapPosMem);
 
 	{
 		const float estToGoal = LeastCostEstimateLocal((size_t)startNode);
@@ -701,7 +600,7 @@ int CMicroPather::FindBestPathToAnyGivenPoint(void* startNode, VoidVec& endNodes
 				#endif
 
 				float newCost = nodeCostFromStart;
-				const float nodeCost = COST_BASE + moveFun(index2) + threatFun(index2);
+				const float nodeCost = COST_BASE + costArray[index2];
 
 				#ifdef USE_ASSERTIONS
 				assert(nodeCost > 0.f);  // > 1.f for speed
@@ -773,7 +672,7 @@ int CMicroPather::FindBestPathToPointOnRadius(void* startNode, void* endNode,
 	}
 
 	// make the priority queue
-	OpenQueueBH open(heapArrayMem);
+	OpenQueueAStar open(pathNodeMem, (OpenQueue4H::Entry*)heapArrayMem, heapPosMem);
 
 	{
 		PathNode* tempStartNode = &pathNodeMem[(size_t) startNode];
@@ -870,7 +769,7 @@ int CMicroPather::FindBestPathToPointOnRadius(void* startNode, void* endNode,
 				#endif
 
 				float newCost = nodeCostFromStart;
-				const float nodeCost = COST_BASE + moveFun(index2) + threatFun(index2);
+				const float nodeCost = COST_BASE + costArray[index2];
 
 				#ifdef USE_ASSERTIONS
 				assert(nodeCost > 0.f);  // > 1.f for speed
@@ -929,7 +828,8 @@ void CMicroPather::MakeCostMap(void* startNode, std::vector<float>& costMap)
 	}
 
 	// Make the priority queue
-	OpenQueueBH open(heapArrayMem);
+	OpenQueueDijkstra& open = *bucketQueue;
+	open.Clear(pathNodeMem);
 
 	{
 		PathNode* tempStartNode = &pathNodeMem[(size_t) startNode];
@@ -1028,7 +928,7 @@ size_t CMicroPather::RefinePath(IndexVec& path)
 	int x0, y0;
 	graph.PathIndex2MoveXY(path[0], &x0, &y0);
 
-	const float moveCost = moveFun(path[0]) + MOVE_EPSILON;
+	const float moveCost = moveCostArray[path[0]] + MOVE_EPSILON;
 
 	// All octant line draw
 	auto IsStraightLine = [this, x0, y0, moveCost](int index) {
@@ -1052,7 +952,7 @@ size_t CMicroPather::RefinePath(IndexVec& path)
 			}
 
 			int idx = CanMoveNode2Index(graph.MoveXY2MoveNode(x, y));
-			if ((idx < 0) || (threatArray[idx] > THREAT_EPSILON) || (moveFun(idx) > moveCost)) {
+			if ((idx < 0) || (threatArray[idx] > THREAT_EPSILON) || (moveCostArray[idx] > moveCost)) {
 				return false;
 			}
 		}
@@ -90,7 +90,8 @@ namespace circuit {
 }
 
 namespace NSMicroPather {
-	using CostFunc = std::function<float (int index)>;  // without +2 edges
+	class OpenQueueBucket;
+
 	using TestFunc = std::function<bool (int2 start, int2 end)>;  // without +2 edges
 
 	class PathNode {
@@ -129,7 +130,6 @@ namespace NSMicroPather {
 				inClosed = 0;
 			}
 
-			int myIndex;
 			int x2, y2, index2;
 			float costFromStart;	// exact
 			float totalCost;		// could be a function, but save some math.
@@ -223,8 +223,8 @@ namespace NSMicroPather {
 
 			const bool* canMoveArray;
 			const float* threatArray;
-			CostFunc moveFun;
-			CostFunc threatFun;
+			const float* costArray;  // move + threat cost of a cell, without +2 edges
+			const float* moveCostArray;  // move-only cost of a cell, RefinePath bound
 			const FloatVec* heightMap;
 
 			int mapSizeX;
@@ -237,8 +237,8 @@ namespace NSMicroPather {
 			std::vector<void*> endNodes;  // helper vector
 			std::vector<void*> nodeTargets;  // helper vector
 
-			void SetMapData(const bool* canMoveArray, const float* threatArray,
-					const CostFunc& moveFun, const CostFunc& threatFun, const FloatVec& heightMap);
+			void SetMapData(const bool* canMoveArray, const float* threatArray, const float* costArray,
+					const float* moveCostArray, const FloatVec& heightMap);
 			int FindBestPathToAnyGivenPoint(void* startNode, VoidVec& endNodes, VoidVec& targets, float maxThreat,
 					IndexVec* path, float* cost);
 			int FindBestPathToPointOnRadius(void* startNode, void* endNode, int radius, float maxThreat, TestFunc hitTest,
@@ -274,7 +274,9 @@ namespace NSMicroPather {
 			const circuit::CPathFinder& graph;
 			PathNode* pathNodeMem;			// pointer to root of PathNode blocks
 			PathNode* pathNodeMemForFree;	// pointer to root of PathNode blocks
-			PathNode** heapArrayMem;		// pointer to root of a PathNode pointer array
+			void* heapArrayMem;				// pointer to root of open list heap array
+			int* heapPosMem;				// heap position of each node
+			OpenQueueBucket* bucketQueue;	// reusable open list of MakeCostMap
 
 			unsigned availMem;				// # PathNodes available in the current block
 			unsigned pathNodeCount;			// the # of PathNodes in use
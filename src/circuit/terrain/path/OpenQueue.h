@@ -0,0 +1,239 @@
+/*
+ * OpenQueue.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_TERRAIN_PATH_OPENQUEUE_H_
+#define SRC_CIRCUIT_TERRAIN_PATH_OPENQUEUE_H_
+
+#include "terrain/path/MicroPather.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace NSMicroPather {
+
+/*
+ * 4-ary heap of (cost, index) pairs stored inline, comparisons don't touch PathNode.
+ * Position of each node in the heap is kept in a dense array for Update (decrease-key).
+ */
+class OpenQueue4H {
+public:
+	struct Entry {
+		float cost;
+		int index;
+	};
+
+	OpenQueue4H(PathNode* nodes, Entry* heapArray, int* heapPos)
+		: nodes(nodes)
+		, heapArray(heapArray)
+		, heapPos(heapPos)
+		, size(0)
+	{}
+
+	~OpenQueue4H() {}
+
+	void Push(PathNode* pNode) {
+		pNode->inOpen = 1;
+		const int index = pNode - nodes;
+		heapArray[size] = {pNode->totalCost, index};
+		SiftUp(size++);
+	}
+
+	void Update(PathNode* pNode) {
+		// NOTE: totalCost only decreases
+		const int i = heapPos[pNode - nodes];
+		heapArray[i].cost = pNode->totalCost;
+		SiftUp(i);
+	}
+
+	PathNode* Pop() {
+		PathNode* min = &nodes[heapArray[0].index];
+		min->inOpen = 0;
+		if (--size > 0) {
+			heapArray[0] = heapArray[size];
+			SiftDown(0);
+		}
+		return min;
+	}
+
+	int Size() const { return size; }
+	bool Empty() {
+		return (size == 0);
+	}
+
+private:
+	void SiftUp(int i) {
+		const Entry entry = heapArray[i];
+		while (i > 0) {
+			const int parent = (i - 1) >> 2;
+			if (heapArray[parent].cost <= entry.cost) {
+				break;
+			}
+			heapArray[i] = heapArray[parent];
+			heapPos[heapArray[i].index] = i;
+			i = parent;
+		}
+		heapArray[i] = entry;
+		heapPos[entry.index] = i;
+	}
+
+	void SiftDown(int i) {
+		const Entry entry = heapArray[i];
+		while (true) {
+			const int first = (i << 2) + 1;
+			if (first >= size) {
+				break;
+			}
+			const int last = std::min(first + 4, size);
+			int smallest = first;
+			for (int c = first + 1; c < last; ++c) {
+				if (heapArray[c].cost < heapArray[smallest].cost) {
+					smallest = c;
+				}
+			}
+			if (heapArray[smallest].cost >= entry.cost) {
+				break;
+			}
+			heapArray[i] = heapArray[smallest];
+			heapPos[heapArray[i].index] = i;
+			i = smallest;
+		}
+		heapArray[i] = entry;
+		heapPos[entry.index] = i;
+	}
+
+	PathNode* nodes;
+	Entry* heapArray;
+	int* heapPos;
+	int size;
+};
+
+/*
+ * Bucket (Dial) queue for monotone Dijkstra: bucket width doesn't exceed minimal edge cost (COST_BASE),
+ * hence any node of the lowest bucket already has final cost and order inside a bucket doesn't matter.
+ * Window of NUM_BUCKETS is circular, farther costs wait in overflow.
+ * Decrease-key re-inserts node, outdated entries are skipped on Pop.
+ */
+class OpenQueueBucket {
+public:
+	struct Entry {
+		float cost;
+		int index;
+	};
+
+	OpenQueueBucket()
+		: nodes(nullptr)
+		, buckets(NUM_BUCKETS)
+	{}
+
+	~OpenQueueBucket() {}
+
+	void Clear(PathNode* nodes) {
+		this->nodes = nodes;
+		for (std::vector<Entry>& bucket : buckets) {
+			bucket.clear();
+		}
+		overflow.clear();
+		current = 0;
+		overflowMin = std::numeric_limits<size_t>::max();
+		inWindow = 0;
+	}
+
+	void Push(PathNode* pNode) {
+		pNode->inOpen = 1;
+		const Entry entry = {pNode->totalCost, int(pNode - nodes)};
+		const size_t b = std::max(Bucket(entry.cost), current);
+		if (b < current + NUM_BUCKETS) {
+			buckets[b & BUCKET_MASK].push_back(entry);
+			++inWindow;
+		} else {
+			overflow.push_back(entry);
+			overflowMin = std::min(overflowMin, b);
+		}
+	}
+
+	void Update(PathNode* pNode) {
+		Push(pNode);  // lazy
+	}
+
+	PathNode* Pop() {
+		Settle();
+		std::vector<Entry>& bucket = buckets[current & BUCKET_MASK];
+		PathNode* min = &nodes[bucket.back().index];
+		bucket.pop_back();
+		--inWindow;
+		min->inOpen = 0;
+		return min;
+	}
+
+	bool Empty() {
+		return !Settle();
+	}
+
+private:
+	static constexpr size_t NUM_BUCKETS = 1024;
+	static constexpr size_t BUCKET_MASK = NUM_BUCKETS - 1;
+
+	static size_t Bucket(float cost) { return size_t(cost / COST_BASE); }
+
+	// Move to the valid lowest entry, dropping outdated ones
+	bool Settle() {
+		while (true) {
+			if (inWindow == 0) {
+				if (overflow.empty()) {
+					return false;
+				}
+				current = overflowMin;
+				Redistribute();
+				continue;
+			}
+			std::vector<Entry>& bucket = buckets[current & BUCKET_MASK];
+			while (!bucket.empty()) {
+				const Entry& entry = bucket.back();
+				const PathNode* node = &nodes[entry.index];
+				if (node->inOpen && (node->totalCost == entry.cost)) {
+					return true;
+				}
+				bucket.pop_back();
+				--inWindow;
+			}
+			++current;
+			if (current + NUM_BUCKETS > overflowMin) {
+				Redistribute();
+			}
+		}
+	}
+
+	void Redistribute() {
+		size_t minB = std::numeric_limits<size_t>::max();
+		auto it = overflow.begin();
+		while (it != overflow.end()) {
+			const size_t b = Bucket(it->cost);
+			if (b < current + NUM_BUCKETS) {
+				buckets[std::max(b, current) & BUCKET_MASK].push_back(*it);
+				++inWindow;
+				*it = overflow.back();
+				overflow.pop_back();
+			} else {
+				minB = std::min(minB, b);
+				++it;
+			}
+		}
+		overflowMin = minB;
+	}
+
+	PathNode* nodes;
+	std::vector<std::vector<Entry>> buckets;
+	std::vector<Entry> overflow;
+	size_t current;  // lowest bucket
+	size_t overflowMin;
+	size_t inWindow;
+};
+
+} // namespace NSMicroPather
+
+#endif // SRC_CIRCUIT_TERRAIN_PATH_OPENQUEUE_H_
@@ -7,6 +7,7 @@
  */
 
 #include "terrain/path/PathFinder.h"
+#include "terrain/path/ClusterGraph.h"
 #include "terrain/path/QueryPathSingle.h"
 #include "terrain/path/QueryPathMulti.h"
 #include "terrain/path/QueryCostMap.h"
@@ -33,6 +34,7 @@ using namespace springai;
 using namespace NSMicroPather;
 
 #define SPIDER_SLOPE		0.99f
+#define COST_MAP_POOL		16
 
 std::vector<int> CPathFinder::blockArray;
 
@@ -41,6 +43,9 @@ CPathFinder::CPathFinder(const std::shared_ptr<CScheduler>& scheduler, CTerrainD
 		, pMoveData(&moveData0)
 		, airMoveArray(nullptr)
 		, isAreaUpdated(true)
+		, areaUpdateNum(0)
+		, costMapHits(0)
+		, costMapMisses(0)
 		, queryId(0)
 		, scheduler(scheduler)
 #ifdef DEBUG_VIS
@@ -58,19 +63,14 @@ CPathFinder::CPathFinder(const std::shared_ptr<CScheduler>& scheduler, CTerrainD
 	moveMapXSize = pathMapXSize + 2;  // +2 for passable edges
 	moveMapYSize = pathMapYSize + 2;  // +2 for passable edges
 
-	int mapWidth = terrainData->GetMap()->GetWidth();
-	int numThreads = scheduler->GetMaxPathThreads();
-	micropathers.reserve(numThreads);
-	for (int i = 0; i < numThreads; ++i) {
-		NSMicroPather::CMicroPather* micropather = new CMicroPather(*this,
-				pathMapXSize, pathMapYSize, mapWidth);
-		micropathers.push_back(micropather);
-	}
+	mapWidth = terrainData->GetMap()->GetWidth();
+	micropathers.resize(scheduler->GetMaxPathThreads(), nullptr);
 
 	areaData = terrainData->pAreaData.load();
 	const std::vector<STerrainMapMobileType>& moveTypes = areaData->mobileType;
 	moveData0.moveArrays.reserve(moveTypes.size());
 	moveData1.moveArrays.reserve(moveTypes.size());
+	clusterGraphs.resize(moveTypes.size());
 
 	const int totalcells = moveMapXSize * moveMapYSize;
 	for (const STerrainMapMobileType& mt : moveTypes) {
@@ -158,12 +158,15 @@ void CPathFinder::UpdateAreaUsers(CTerrainManager* terrainManager)
 	}
 
 	std::vector<bool*>& moveArrays = GetNextMoveData()->moveArrays;
+	const std::vector<bool*>& currArrays = pMoveData.load()->moveArrays;
+	std::vector<bool> isChanged(moveArrays.size(), false);
 	areaData = terrainData->GetNextAreaData();
 	const std::vector<STerrainMapMobileType>& moveTypes = areaData->mobileType;
 	const int blockThreshold = granularity * granularity / 4;  // 25% - blocked tile
 	for (unsigned j = 0; j < moveTypes.size(); ++j) {
 		const STerrainMapMobileType& mt = moveTypes[j];
 		bool* moveArray = moveArrays[j];
+		const bool* currArray = currArrays[j];
 
 		int k = 0;
 		for (int z = 1; z < moveMapYSize - 1; ++z) {
@@ -171,6 +174,9 @@ void CPathFinder::UpdateAreaUsers(CTerrainManager* terrainManager)
 				int index = z * moveMapXSize + x;
 				// NOTE: Not all passable sectors have area
 				moveArray[index] = (mt.sector[k].area != nullptr) && (blockArray[k] < blockThreshold);
+				if (moveArray[index] != currArray[index]) {
+					isChanged[j] = true;
+				}
 				++k;
 			}
 		}
@@ -178,6 +184,20 @@ void CPathFinder::UpdateAreaUsers(CTerrainManager* terrainManager)
 //	micropather->Reset();
 
 	pMoveData = GetNextMoveData();
+	++areaUpdateNum;
+
+	// Only changed clusters are rebuilt, off main thread
+	for (unsigned j = 0; j < clusterGraphs.size(); ++j) {
+		SClusterData& cd = clusterGraphs[j];
+		if (!isChanged[j] || ((cd.graph == nullptr) && !cd.isBuilding)) {
+			continue;
+		}
+		if (cd.isBuilding) {
+			cd.isOutdated = true;
+		} else {
+			BuildClusterGraph(j);
+		}
+	}
 }
 
 const FloatVec& CPathFinder::GetHeightMap() const
@@ -301,6 +321,63 @@ std::shared_ptr<IPathQuery> CPathFinder::CreateCostMapQuery(
 	return pQuery;
 }
 
+std::shared_ptr<IPathQuery> CPathFinder::CreateSharedCostMapQuery(
+		CCircuitUnit* unit, CThreatMap* threatMap, int frame,  // SetMapData
+		const AIFloat3& startPos)
+{
+	const SMapType mt = GetMapType(unit, threatMap, frame);
+	int x, y;
+	Pos2PathXY(startPos, &x, &y);
+	const SCostMapKey key = {mt.moveArray, mt.threatArray, mt.costType, PathXY2PathIndex(x, y)};
+	auto it = costMapCache.find(key);
+	if ((it != costMapCache.end())
+		&& (it->second.threatUpdateNum == threatMap->GetUpdateNum())
+		&& (it->second.areaUpdateNum == areaUpdateNum))
+	{
+		++costMapHits;
+		return it->second.query;
+	}
+	++costMapMisses;
+
+	std::shared_ptr<IPathQuery> pQuery = std::make_shared<CQueryCostMap>(*this, MakeQueryId());
+	CQueryCostMap* query = static_cast<CQueryCostMap*>(pQuery.get());
+	query->Init(mt.moveArray, GetClusterGraph(mt.mobileTypeId), mt.threatArray,
+			GetCostArray(threatMap, mt.threatArray, mt.costType, mt.mobileTypeId, mt.maxSlope));  // outlives requester
+	query->InitQuery(startPos);
+
+	// Drop outdated, users hold their queries
+	for (auto it = costMapCache.begin(); it != costMapCache.end();) {
+		if (it->second.frame + THREAT_UPDATE_RATE * 2 < frame) {
+			it = costMapCache.erase(it);
+		} else {
+			++it;
+		}
+	}
+	costMapCache[key] = SCostMapEntry {pQuery, threatMap->GetUpdateNum(), areaUpdateNum, frame};
+
+	RunQuery(pQuery);
+	return pQuery;
+}
+
+FloatVec CPathFinder::AcquireCostMap() const
+{
+	std::lock_guard<spring::mutex> lock(costMapMutex);
+	if (costMapPool.empty()) {
+		return FloatVec(pathMapXSize * pathMapYSize, -1.f);
+	}
+	FloatVec costMap = std::move(costMapPool.back());
+	costMapPool.pop_back();
+	return costMap;
+}
+
+void CPathFinder::ReleaseCostMap(FloatVec&& costMap) const
+{
+	std::lock_guard<spring::mutex> lock(costMapMutex);
+	if (costMapPool.size() < COST_MAP_POOL) {
+		costMapPool.push_back(std::move(costMap));
+	}
+}
+
 std::shared_ptr<IPathQuery> CPathFinder::CreateLineMapQuery(
 		CCircuitUnit* unit, CThreatMap* threatMap, int frame)  // SetMapData
 {
@@ -329,88 +406,217 @@ void CPathFinder::RunQuery(const std::shared_ptr<IPathQuery>& query, PathCallbac
 	}
 }
 
-void CPathFinder::FillMapData(IPathQuery* query, CCircuitUnit* unit, CThreatMap* threatMap, int frame)
+CPathFinder::SMapType CPathFinder::GetMapType(CCircuitUnit* unit, CThreatMap* threatMap, int frame) const
 {
 	CCircuitDef* cdef = unit->GetCircuitDef();
-	STerrainMapMobileType::Id mobileTypeId = cdef->GetMobileId();
+	SMapType mt;
+	mt.mobileTypeId = cdef->GetMobileId();
 
-	const std::vector<STerrainMapSector>& sectors = areaData->sector;
-	bool* moveArray;
-	float maxSlope;
-	if (mobileTypeId < 0) {
-		moveArray = airMoveArray;
-		maxSlope = 1.f;
+	if (mt.mobileTypeId < 0) {
+		mt.moveArray = airMoveArray;
+		mt.maxSlope = 1.f;
 	} else {
-		moveArray = pMoveData.load()->moveArrays[mobileTypeId];
-		maxSlope = std::max(areaData->mobileType[mobileTypeId].maxSlope, 1e-3f);
+		mt.moveArray = pMoveData.load()->moveArrays[mt.mobileTypeId];
+		mt.maxSlope = std::max(areaData->mobileType[mt.mobileTypeId].maxSlope, 1e-3f);
 	}
 
-	float* threatArray;
-	CostFunc moveFun;
-	CostFunc threatFun;
-	// TODO: Re-organize and pre-calculate moveFun for each move-type
 	if ((unit->GetPos(frame).y < .0f) && !cdef->IsSonarStealth()) {
-		threatArray = threatMap->GetAmphThreatArray();  // cloak doesn't work under water
-		moveFun = [&sectors, maxSlope](int index) {
-			return (sectors[index].isWater ? 2.f : 0.f) + 2.f * sectors[index].maxSlope / maxSlope;
-		};
-		threatFun = [threatArray](int index) {
-			return 2.f * threatArray[index];
-		};
+		mt.threatArray = threatMap->GetAmphThreatArray();  // cloak doesn't work under water
+		mt.costType = CostType::SUB;
 	} else if (unit->GetUnit()->IsCloaked()) {
-		threatArray = threatMap->GetCloakThreatArray();
-		moveFun = [&sectors, maxSlope](int index) {
-			return sectors[index].maxSlope / maxSlope;
-		};
-		threatFun = [threatArray](int index) {
-			return threatArray[index];
-		};
+		mt.threatArray = threatMap->GetCloakThreatArray();
+		mt.costType = CostType::CLOAK;
 	} else if (cdef->IsAbleToFly()) {
-		threatArray = threatMap->GetAirThreatArray();
-		moveFun = [](int index) {
-			return 0.f;
-		};
-		threatFun = [threatArray](int index) {
-			return 2.f * threatArray[index];
-		};
+		mt.threatArray = threatMap->GetAirThreatArray();
+		mt.costType = CostType::AIR;
 	} else if (cdef->IsAmphibious()) {
-		threatArray = threatMap->GetAmphThreatArray();
-		if (maxSlope > SPIDER_SLOPE) {
-			const float minElev = areaData->minElevation;
-			float elevLen = std::max(areaData->maxElevation - areaData->minElevation, 1e-3f);
-			moveFun = [&sectors, minElev, elevLen](int index) {
-				return 2.f * (1.f - (sectors[index].maxElevation - minElev) / elevLen) +
-						(sectors[index].isWater ? 2.f : 0.f);
-			};
-			threatFun = [threatArray](int index) {
-				return 2.f * threatArray[index];
-			};
-		} else {
-			moveFun = [&sectors, maxSlope](int index) {
-				return (sectors[index].isWater ? 2.f : 0.f) + 2.f * sectors[index].maxSlope / maxSlope;
-			};
-			threatFun = [threatArray](int index) {
-				return 2.f * threatArray[index];
-			};
-		}
+		mt.threatArray = threatMap->GetAmphThreatArray();
+		mt.costType = (mt.maxSlope > SPIDER_SLOPE) ? CostType::SPIDER : CostType::AMPH;
 	} else {
-		threatArray = threatMap->GetSurfThreatArray();
-		moveFun = [&sectors, maxSlope](int index) {
-			return sectors[index].isWater ? 0.f : (2.f * sectors[index].maxSlope / maxSlope);
-		};
-		threatFun = [threatArray](int index) {
-			return 2.f * threatArray[index];
-		};
+		mt.threatArray = threatMap->GetSurfThreatArray();
+		mt.costType = CostType::SURF;
 	}
+	return mt;
+}
+
+void CPathFinder::FillMapData(IPathQuery* query, CCircuitUnit* unit, CThreatMap* threatMap, int frame)
+{
+	const SMapType mt = GetMapType(unit, threatMap, frame);
+	query->Init(mt.moveArray, GetClusterGraph(mt.mobileTypeId), mt.threatArray,
+			GetCostArray(threatMap, mt.threatArray, mt.costType, mt.mobileTypeId, mt.maxSlope), unit);
+}
 
-	query->Init(moveArray, threatArray, std::move(moveFun), std::move(threatFun), unit);
+/*
+ * Returns nullptr until the first build finishes, queries use full-res search meanwhile
+ */
+std::shared_ptr<const CClusterGraph> CPathFinder::GetClusterGraph(int mobileTypeId)
+{
+	if (mobileTypeId < 0) {
+		return nullptr;  // air: open map, A* is fast enough
+	}
+	SClusterData& cd = clusterGraphs[mobileTypeId];
+	if ((cd.graph == nullptr) && !cd.isBuilding) {
+		BuildClusterGraph(mobileTypeId);
+	}
+	return cd.graph;
+}
+
+void CPathFinder::BuildClusterGraph(int mobileTypeId)
+{
+	SClusterData& cd = clusterGraphs[mobileTypeId];
+	cd.isBuilding = true;
+	cd.isOutdated = false;
+
+	// Job owns a snapshot, moveArrays are double-buffered for AREA_UPDATE_RATE only
+	struct SBuild {
+		std::unique_ptr<bool[]> moveArray;
+		std::shared_ptr<const CClusterGraph> prev;
+		std::shared_ptr<const CClusterGraph> graph;
+	};
+	std::shared_ptr<SBuild> build = std::make_shared<SBuild>();
+	const int totalcells = moveMapXSize * moveMapYSize;
+	const bool* moveArray = pMoveData.load()->moveArrays[mobileTypeId];
+	build->moveArray.reset(new bool[totalcells]);
+	std::copy(moveArray, moveArray + totalcells, build->moveArray.get());
+	build->prev = cd.graph;
+
+	const int xSize = moveMapXSize;
+	const int ySize = moveMapYSize;
+	scheduler->RunParallelTask(MakeTask([build, xSize, ySize]() {
+		build->graph = (build->prev == nullptr)
+				? std::make_shared<const CClusterGraph>(xSize, ySize, build->moveArray.get())
+				: std::make_shared<const CClusterGraph>(*build->prev, build->moveArray.get());
+		build->prev = nullptr;
+	}), MakeTask([this, build, mobileTypeId]() {
+		SClusterData& cd = clusterGraphs[mobileTypeId];
+		cd.graph = build->graph;
+		cd.isBuilding = false;
+		if (cd.isOutdated) {
+			BuildClusterGraph(mobileTypeId);
+		}
+	}), CScheduler::Priority::LOW);
+}
+
+/*
+ * Cost policies: Move(sector) + THREAT_MOD * threat
+ */
+struct SAirCost {
+	static constexpr float THREAT_MOD = 2.f;
+	float Move(const STerrainMapSector&) const {
+		return 0.f;
+	}
+};
+
+struct SSurfCost {
+	static constexpr float THREAT_MOD = 2.f;
+	float maxSlope;
+	float Move(const STerrainMapSector& s) const {
+		return s.isWater ? 0.f : (2.f * s.maxSlope / maxSlope);
+	}
+};
+
+struct SAmphCost {
+	static constexpr float THREAT_MOD = 2.f;
+	float maxSlope;
+	float Move(const STerrainMapSector& s) const {
+		return (s.isWater ? 2.f : 0.f) + 2.f * s.maxSlope / maxSlope;
+	}
+};
+
+struct SSpiderCost {  // climbs anything, prefers heights
+	static constexpr float THREAT_MOD = 2.f;
+	float minElev;
+	float elevLen;
+	float Move(const STerrainMapSector& s) const {
+		return 2.f * (1.f - (s.maxElevation - minElev) / elevLen) + (s.isWater ? 2.f : 0.f);
+	}
+};
+
+struct SCloakCost {
+	static constexpr float THREAT_MOD = 1.f;
+	float maxSlope;
+	float Move(const STerrainMapSector& s) const {
+		return s.maxSlope / maxSlope;
+	}
+};
+
+using SSubCost = SAmphCost;  // under water
+
+void CPathFinder::CCostArray::Fill()
+{
+	if (!isFilled.load()) {
+		std::lock_guard<spring::mutex> lock(mutex);
+		if (!isFilled.load()) {
+			fill(cost, move);
+			fill = nullptr;
+			isFilled.store(true);
+		}
+	}
+}
+
+/*
+ * Cheap on main thread: the full-map fill is deferred to the path thread of the first query.
+ */
+std::shared_ptr<CPathFinder::CCostArray> CPathFinder::GetCostArray(CThreatMap* threatMap, const float* threatArray,
+		CostType type, int mobileTypeId, float maxSlope)
+{
+	SCostArray& ca = costArrays[SCostKey {threatArray, areaData, type, mobileTypeId, maxSlope}];
+	if ((ca.cost != nullptr)
+		&& (ca.threatUpdateNum == threatMap->GetUpdateNum())
+		&& (ca.areaUpdateNum == areaUpdateNum))
+	{
+		return ca.cost;
+	}
+	ca.threatUpdateNum = threatMap->GetUpdateNum();
+	ca.areaUpdateNum = areaUpdateNum;
+
+	const SAreaData* areaData = this->areaData;
+	ca.cost = std::make_shared<CCostArray>([areaData, threatArray, type, maxSlope](FloatVec& cost, FloatVec& move) {
+		cost.resize(areaData->sector.size());
+		move.resize(areaData->sector.size());
+		switch (type) {
+			case CostType::AIR: {
+				FillCostArray(SAirCost(), areaData, threatArray, cost, move);
+			} break;
+			case CostType::SURF: {
+				FillCostArray(SSurfCost {maxSlope}, areaData, threatArray, cost, move);
+			} break;
+			case CostType::AMPH: {
+				FillCostArray(SAmphCost {maxSlope}, areaData, threatArray, cost, move);
+			} break;
+			case CostType::SPIDER: {
+				const float minElev = areaData->minElevation;
+				const float elevLen = std::max(areaData->maxElevation - areaData->minElevation, 1e-3f);
+				FillCostArray(SSpiderCost {minElev, elevLen}, areaData, threatArray, cost, move);
+			} break;
+			case CostType::CLOAK: {
+				FillCostArray(SCloakCost {maxSlope}, areaData, threatArray, cost, move);
+			} break;
+			case CostType::SUB: {
+				FillCostArray(SSubCost {maxSlope}, areaData, threatArray, cost, move);
+			} break;
+			default: break;
+		}
+	});
+	return ca.cost;
+}
+
+template<typename P>
+void CPathFinder::FillCostArray(const P& policy, const SAreaData* areaData,
+		const float* threatArray, FloatVec& costArray, FloatVec& moveArray)
+{
+	const std::vector<STerrainMapSector>& sectors = areaData->sector;
+	for (unsigned i = 0; i < sectors.size(); ++i) {
+		moveArray[i] = policy.Move(sectors[i]);
+		costArray[i] = moveArray[i] + P::THREAT_MOD * threatArray[i];
+	}
 }
 
 void CPathFinder::RunPathSingle(const std::shared_ptr<IPathQuery>& query, PathCallback&& onComplete)
 {
 	query->SetState(IPathQuery::State::PROCESS);
 	scheduler->RunPathTask(query, [this](const std::shared_ptr<IPathQuery>& query, int threadNum) {
-		this->MakePath(query.get(), micropathers[threadNum]);
+		this->MakePath(query.get(), this->GetMicroPather(threadNum));
 	}
 #ifdef DEBUG_VIS
 	, [this, onComplete](const std::shared_ptr<IPathQuery>& query) {
@@ -429,7 +635,7 @@ void CPathFinder::RunPathMulti(const std::shared_ptr<IPathQuery>& query, PathCal
 {
 	query->SetState(IPathQuery::State::PROCESS);
 	scheduler->RunPathTask(query, [this](const std::shared_ptr<IPathQuery>& query, int threadNum) {
-		this->FindBestPath(query.get(), micropathers[threadNum]);
+		this->FindBestPath(query.get(), this->GetMicroPather(threadNum));
 	}
 #ifdef DEBUG_VIS
 	, [this, onComplete](const std::shared_ptr<IPathQuery>& query) {
@@ -448,14 +654,24 @@ void CPathFinder::RunCostMap(const std::shared_ptr<IPathQuery>& query, PathCallb
 {
 	query->SetState(IPathQuery::State::PROCESS);
 	scheduler->RunPathTask(query, [this](const std::shared_ptr<IPathQuery>& query, int threadNum) {
-		this->MakeCostMap(query.get(), micropathers[threadNum]);
+		this->MakeCostMap(query.get(), this->GetMicroPather(threadNum));
 	}
 	, [onComplete](const std::shared_ptr<IPathQuery>& query) {
 		query->SetState(IPathQuery::State::READY);
 		if (onComplete != nullptr) {
 			onComplete(query.get());
 		}
-	});
+	}, CScheduler::Priority::LOW);  // full-map Dijkstra shouldn't delay threat refresh and unit paths
+}
+
+NSMicroPather::CMicroPather* CPathFinder::GetMicroPather(int threadNum)
+{
+	// NOTE: Slot is touched only by its own pool thread
+	NSMicroPather::CMicroPather*& micropather = micropathers[threadNum];
+	if (micropather == nullptr) {
+		micropather = new CMicroPather(*this, pathMapXSize, pathMapYSize, mapWidth);
+	}
+	return micropather;
 }
 
 void CPathFinder::MakePath(IPathQuery* query, NSMicroPather::CMicroPather* micropather)
@@ -465,8 +681,8 @@ void CPathFinder::MakePath(IPathQuery* query, NSMicroPather::CMicroPather* micro
 
 	const bool* canMoveArray = q->GetCanMoveArray();
 	const float* threatArray = q->GetThreatArray();
-	const NSMicroPather::CostFunc& moveFun = q->GetMoveFun();
-	const NSMicroPather::CostFunc& threatFun = q->GetThreatFun();
+	const float* costArray = q->GetCostArray();
+	const float* moveCostArray = q->GetMoveCostArray();
 	const FloatVec& heightMap = q->GetHeightMap();
 
 	AIFloat3& startPos = q->GetStartPosRef();
@@ -483,8 +699,26 @@ void CPathFinder::MakePath(IPathQuery* query, NSMicroPather::CMicroPather* micro
 	CTerrainData::CorrectPosition(startPos);
 	CTerrainData::CorrectPosition(endPos);
 
-	micropather->SetMapData(canMoveArray, threatArray, moveFun, threatFun, heightMap);
-	if (micropather->FindBestPathToPointOnRadius(Pos2MoveNode(startPos), Pos2MoveNode(endPos),
+	void* startNode = Pos2MoveNode(startPos);
+	void* endNode = Pos2MoveNode(endPos);
+
+	// Long path: full-res search within coarse corridor first
+	const CClusterGraph* clusterGraph = q->GetClusterGraph();
+	const bool* corridorArray = (clusterGraph == nullptr) ? nullptr
+			: clusterGraph->MakeCorridor(canMoveArray, costArray, startNode, {endNode});
+	if (corridorArray != nullptr) {
+		micropather->SetMapData(corridorArray, threatArray, costArray, moveCostArray, heightMap);
+		if (micropather->FindBestPathToPointOnRadius(startNode, endNode,
+				radius, maxThreat, hitTest, &iPath.path, &pathCost) == CMicroPather::SOLVED)
+		{
+			micropather->FillPathInfo(iPath);
+			return;
+		}
+		iPath.Clear();
+	}
+
+	micropather->SetMapData(canMoveArray, threatArray, costArray, moveCostArray, heightMap);
+	if (micropather->FindBestPathToPointOnRadius(startNode, endNode,
 			radius, maxThreat, hitTest, &iPath.path, &pathCost) == CMicroPather::SOLVED)
 	{
 		micropather->FillPathInfo(iPath);
@@ -498,8 +732,8 @@ void CPathFinder::FindBestPath(IPathQuery* query, NSMicroPather::CMicroPather* m
 
 	const bool* canMoveArray = q->GetCanMoveArray();
 	const float* threatArray = q->GetThreatArray();
-	const NSMicroPather::CostFunc& moveFun = q->GetMoveFun();
-	const NSMicroPather::CostFunc& threatFun = q->GetThreatFun();
+	const float* costArray = q->GetCostArray();
+	const float* moveCostArray = q->GetMoveCostArray();
 	const FloatVec& heightMap = q->GetHeightMap();
 
 	AIFloat3& startPos = q->GetStartPosRef();
@@ -628,10 +862,28 @@ void CPathFinder::FindBestPath(IPathQuery* query, NSMicroPather::CMicroPather* m
 
 	CTerrainData::CorrectPosition(startPos);
 
-	micropather->SetMapData(canMoveArray, threatArray, moveFun, threatFun, heightMap);
-	if (micropather->FindBestPathToAnyGivenPoint(Pos2MoveNode(startPos), endNodes, nodeTargets,
-			maxThreat, &iPath.path, &pathCost) == CMicroPather::SOLVED)
-	{
+	void* startNode = Pos2MoveNode(startPos);
+
+	// Long path: full-res search within coarse corridor first
+	const CClusterGraph* clusterGraph = q->GetClusterGraph();
+	const bool* corridorArray = (clusterGraph == nullptr) ? nullptr
+			: clusterGraph->MakeCorridor(canMoveArray, costArray, startNode, nodeTargets);
+	bool isSolved = false;
+	if (corridorArray != nullptr) {
+		micropather->SetMapData(corridorArray, threatArray, costArray, moveCostArray, heightMap);
+		isSolved = micropather->FindBestPathToAnyGivenPoint(startNode, endNodes, nodeTargets,
+				maxThreat, &iPath.path, &pathCost) == CMicroPather::SOLVED;
+		if (!isSolved) {
+			iPath.Clear();
+		}
+	}
+
+	if (!isSolved) {
+		micropather->SetMapData(canMoveArray, threatArray, costArray, moveCostArray, heightMap);
+		isSolved = micropather->FindBestPathToAnyGivenPoint(startNode, endNodes, nodeTargets,
+				maxThreat, &iPath.path, &pathCost) == CMicroPather::SOLVED;
+	}
+	if (isSolved) {
 		micropather->FillPathInfo(iPath);
 	}
 
@@ -646,14 +898,14 @@ void CPathFinder::MakeCostMap(IPathQuery* query, NSMicroPather::CMicroPather* mi
 
 	const bool* canMoveArray = q->GetCanMoveArray();
 	const float* threatArray = q->GetThreatArray();
-	NSMicroPather::CostFunc moveFun = q->GetMoveFun();
-	NSMicroPather::CostFunc threatFun = q->GetThreatFun();
+	const float* costArray = q->GetCostArray();
+	const float* moveCostArray = q->GetMoveCostArray();
 	const FloatVec& heightMap = q->GetHeightMap();
 
 	const AIFloat3& startPos = q->GetStartPos();
 	std::vector<float>& costMap = q->GetCostMapRef();
 
-	micropather->SetMapData(canMoveArray, threatArray, moveFun, threatFun, heightMap);
+	micropather->SetMapData(canMoveArray, threatArray, costArray, moveCostArray, heightMap);
 	micropather->MakeCostMap(Pos2MoveNode(startPos), costMap);
 }
 
@@ -679,15 +931,9 @@ std::shared_ptr<IPathQuery> CPathFinder::CreateDbgPathQuery(CThreatMap* threatMa
 	};
 
 	const float* threatArray = costArray[dbgType];
-	const std::vector<STerrainMapSector>& sectors = areaData->sector;
-	CostFunc moveFun = [&sectors, maxSlope](int index) {
-		return sectors[index].maxSlope / maxSlope;
-	};
-	CostFunc threatFun = [threatArray](int index) {
-		return threatArray[index];
-	};
 
-	query->Init(moveArray, threatArray, std::move(moveFun), std::move(threatFun));
+	query->Init(moveArray, GetClusterGraph(mobileTypeId), threatArray,
+			GetCostArray(threatMap, threatArray, CostType::CLOAK, mobileTypeId, std::max(maxSlope, 1e-3f)));
 	query->InitQuery(dbgPos, endPos, maxRange, nullptr, maxThreat, false);
 
 	return pQuery;
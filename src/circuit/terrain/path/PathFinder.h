@@ -12,9 +12,13 @@
 #include "terrain/path/MicroPather.h"
 #include "util/Defines.h"
 
+#include "System/Threading/SpringThreading.h"
+
 #include <atomic>
 #include <memory>
 #include <functional>
+#include <map>
+#include <tuple>
 
 namespace circuit {
 
@@ -25,6 +29,7 @@ class CTerrainData;
 class CTerrainManager;
 class CCircuitUnit;
 class CThreatMap;
+class CClusterGraph;
 struct SAreaData;
 #ifdef DEBUG_VIS
 class CCircuitAI;
@@ -38,6 +43,27 @@ public:
 	struct SMoveData {
 		std::vector<bool*> moveArrays;
 	};
+	// Movement class, each has own compile-time cost policy
+	enum class CostType: char {AIR = 0, SURF, AMPH, SPIDER, CLOAK, SUB, _SIZE_};
+	/*
+	 * Fused move + threat cost per cell, filled by the first path thread that reads it.
+	 * Move-only part is kept along for RefinePath's straight-line bound.
+	 * Immutable once filled, queries hold it for their lifetime.
+	 */
+	class CCostArray {
+	public:
+		CCostArray(std::function<void (FloatVec& cost, FloatVec& move)>&& fill)
+			: fill(std::move(fill)), isFilled(false) {}
+		const float* Get() { Fill(); return cost.data(); }
+		const float* GetMove() { Fill(); return move.data(); }
+	private:
+		void Fill();
+		std::function<void (FloatVec& cost, FloatVec& move)> fill;
+		std::atomic<bool> isFilled;
+		spring::mutex mutex;
+		FloatVec cost;
+		FloatVec move;
+	};
 
 	CPathFinder(const std::shared_ptr<CScheduler>& scheduler, CTerrainData* terrainData);
 	virtual ~CPathFinder();
@@ -67,6 +93,20 @@ public:
 	std::shared_ptr<IPathQuery> CreateCostMapQuery(CCircuitUnit* unit, CThreatMap* threatMap, int frame,
 			const springai::AIFloat3& startPos);
 	std::shared_ptr<IPathQuery> CreateLineMapQuery(CCircuitUnit* unit, CThreatMap* threatMap, int frame);
+	/*
+	 * Cost map of the same move type and threat layer from the same start sector is shared
+	 * until threat or area update. Query is already running or ready, do not RunQuery it.
+	 * Shared query has no owner unit: GetUnit() is nullptr.
+	 */
+	std::shared_ptr<IPathQuery> CreateSharedCostMapQuery(CCircuitUnit* unit, CThreatMap* threatMap, int frame,
+			const springai::AIFloat3& startPos);
+	float GetCostMapHitRate() const {
+		return (costMapHits + costMapMisses > 0) ? float(costMapHits) / (costMapHits + costMapMisses) : 0.f;
+	}
+
+	// Thread-safe, recycles CQueryCostMap storage
+	FloatVec AcquireCostMap() const;
+	void ReleaseCostMap(FloatVec&& costMap) const;
 
 	void RunQuery(const std::shared_ptr<IPathQuery>& query, PathCallback&& onComplete = nullptr);
 
@@ -88,12 +128,27 @@ private:
 	}
 
 	int MakeQueryId() { return queryId++; }
+	struct SMapType {
+		bool* moveArray;
+		float* threatArray;
+		CostType costType;
+		int mobileTypeId;  // STerrainMapMobileType::Id
+		float maxSlope;
+	};
+	SMapType GetMapType(CCircuitUnit* unit, CThreatMap* threatMap, int frame) const;
 	void FillMapData(IPathQuery* query, CCircuitUnit* unit, CThreatMap* threatMap, int frame);
+	std::shared_ptr<const CClusterGraph> GetClusterGraph(int mobileTypeId);
+	void BuildClusterGraph(int mobileTypeId);
+	std::shared_ptr<CCostArray> GetCostArray(CThreatMap* threatMap, const float* threatArray, CostType type,
+			int mobileTypeId, float maxSlope);
+	template<typename P> static void FillCostArray(const P& policy, const SAreaData* areaData,
+			const float* threatArray, FloatVec& costArray, FloatVec& moveArray);
 
 	void RunPathSingle(const std::shared_ptr<IPathQuery>& query, PathCallback&& onComplete = nullptr);
 	void RunPathMulti(const std::shared_ptr<IPathQuery>& query, PathCallback&& onComplete = nullptr);
 	void RunCostMap(const std::shared_ptr<IPathQuery>& query, PathCallback&& onComplete = nullptr);
 
+	NSMicroPather::CMicroPather* GetMicroPather(int threadNum);
 	void MakePath(IPathQuery* query, NSMicroPather::CMicroPather* micropather);
 	void FindBestPath(IPathQuery* query, NSMicroPather::CMicroPather* micropather);
 	void MakeCostMap(IPathQuery* query, NSMicroPather::CMicroPather* micropather);
@@ -101,12 +156,65 @@ private:
 	CTerrainData* terrainData;
 	SAreaData* areaData;
 
-	std::vector<NSMicroPather::CMicroPather*> micropathers;
+	std::vector<NSMicroPather::CMicroPather*> micropathers;  // per pool thread, created on its first path job
+	int mapWidth;
 	SMoveData moveData0, moveData1;
 	std::atomic<SMoveData*> pMoveData;
 	bool* airMoveArray;
+	struct SClusterData {
+		std::shared_ptr<const CClusterGraph> graph;  // published, immutable
+		bool isBuilding = false;
+		bool isOutdated = false;  // area changed during build
+	};
+	std::vector<SClusterData> clusterGraphs;  // HPA* graph per mobile type, built on first use
 	static std::vector<int> blockArray;  // temporary array for moveArray construction
 	bool isAreaUpdated;
+	int areaUpdateNum;
+
+	/*
+	 * Cost arrays of current area and threat update, replaced (not refilled) after an update.
+	 * Keyed by double-buffered arrays, hence old array stays intact for one more update.
+	 */
+	struct SCostKey {
+		const float* threatArray;
+		const SAreaData* areaData;
+		CostType type;
+		int mobileTypeId;  // STerrainMapMobileType::Id
+		float maxSlope;
+		bool operator<(const SCostKey& o) const {
+			return std::tie(threatArray, areaData, type, mobileTypeId, maxSlope)
+					< std::tie(o.threatArray, o.areaData, o.type, o.mobileTypeId, o.maxSlope);
+		}
+	};
+	struct SCostArray {
+		int threatUpdateNum;
+		int areaUpdateNum;
+		std::shared_ptr<CCostArray> cost;
+	};
+	std::map<SCostKey, SCostArray> costArrays;
+
+	struct SCostMapKey {
+		const bool* canMoveArray;  // move type, area buffer
+		const float* threatArray;  // threat layer, threat buffer
+		CostType type;  // cost policy: cloaked, submerged, spider share layers with others
+		int startIndex;  // path-map sector
+		bool operator<(const SCostMapKey& o) const {
+			return std::tie(canMoveArray, threatArray, type, startIndex)
+					< std::tie(o.canMoveArray, o.threatArray, o.type, o.startIndex);
+		}
+	};
+	struct SCostMapEntry {
+		std::shared_ptr<IPathQuery> query;
+		int threatUpdateNum;
+		int areaUpdateNum;
+		int frame;
+	};
+	// NOTE: Pool outlives the cache, cached CQueryCostMap releases its storage on destruction
+	mutable spring::mutex costMapMutex;
+	mutable std::vector<FloatVec> costMapPool;
+	std::map<SCostMapKey, SCostMapEntry> costMapCache;
+	unsigned costMapHits;
+	unsigned costMapMisses;
 
 	int squareSize;
 	int moveMapXSize;  // +2 for edges
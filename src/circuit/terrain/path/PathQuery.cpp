@@ -30,14 +30,14 @@ IPathQuery::~IPathQuery()
 	}
 }
 
-void IPathQuery::Init(const bool* canMoveArray, const float* threatArray,
-		NSMicroPather::CostFunc&& moveFun, NSMicroPather::CostFunc&& threatFun,
+void IPathQuery::Init(const bool* canMoveArray, const std::shared_ptr<const CClusterGraph>& clusterGraph,
+		const float* threatArray, const std::shared_ptr<CPathFinder::CCostArray>& costArray,
 		CCircuitUnit* unit)
 {
 	this->canMoveArray = canMoveArray;
+	this->clusterGraph = clusterGraph;
 	this->threatArray = threatArray;
-	this->moveFun = moveFun;
-	this->threatFun = threatFun;
+	this->costArray = costArray;
 	this->unit = unit;  // optional
 }
 
@@ -31,14 +31,15 @@ public:
 	void SetState(State value) { state.store(value); }
 	State GetState() const { return state.load(); }
 
-	void Init(const bool* canMoveArray, const float* threatArray,
-			  NSMicroPather::CostFunc&& moveFun, NSMicroPather::CostFunc&& threatFun,
+	void Init(const bool* canMoveArray, const std::shared_ptr<const CClusterGraph>& clusterGraph,
+			  const float* threatArray, const std::shared_ptr<CPathFinder::CCostArray>& costArray,
 			  CCircuitUnit* unit = nullptr);
 
 	const bool* GetCanMoveArray() const { return canMoveArray; }
+	const CClusterGraph* GetClusterGraph() const { return clusterGraph.get(); }
 	const float* GetThreatArray() const { return threatArray; }
-	const NSMicroPather::CostFunc& GetMoveFun() const { return moveFun; }
-	const NSMicroPather::CostFunc& GetThreatFun() const { return threatFun; }
+	const float* GetCostArray() const { return costArray->Get(); }  // path thread, fills on first use
+	const float* GetMoveCostArray() const { return costArray->GetMove(); }  // path thread
 	const FloatVec& GetHeightMap() const { return heightMap; }
 
 	CCircuitUnit* GetUnit() const { return unit; }
@@ -54,9 +55,9 @@ protected:
 	std::atomic<State> state;
 
 	const bool* canMoveArray;  // outdate after AREA_UPDATE_RATE
+	std::shared_ptr<const CClusterGraph> clusterGraph;  // optional, may lag behind canMoveArray
 	const float* threatArray;  // outdate after THREAT_UPDATE_RATE
-	NSMicroPather::CostFunc moveFun;  // AREA_UPDATE_RATE
-	NSMicroPather::CostFunc threatFun;  // THREAT_UPDATE_RATE
+	std::shared_ptr<CPathFinder::CCostArray> costArray;  // AREA_UPDATE_RATE, THREAT_UPDATE_RATE
 
 	CCircuitUnit* unit;  // optional, non-safe
 
@@ -18,6 +18,9 @@ CQueryCostMap::CQueryCostMap(const CPathFinder& pathfinder, int id)
 
 CQueryCostMap::~CQueryCostMap()
 {
+	if (!costMap.empty()) {
+		pathfinder.ReleaseCostMap(std::move(costMap));
+	}
 }
 
 void CQueryCostMap::InitQuery(const AIFloat3& startPos)
@@ -27,9 +30,8 @@ void CQueryCostMap::InitQuery(const AIFloat3& startPos)
 
 void CQueryCostMap::Prepare()
 {
-	// TODO: Cache to avoid memory allocations
-	costMap.resize(pathfinder.GetPathMapXSize() * pathfinder.GetPathMapYSize(), -1.f);
-//	std::fill(costMap.begin(), costMap.end(), -1.f);
+	costMap = pathfinder.AcquireCostMap();
+	std::fill(costMap.begin(), costMap.end(), -1.f);
 }
 
 /*
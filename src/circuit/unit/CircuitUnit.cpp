@@ -13,6 +13,9 @@
 #include "setup/SetupManager.h"
 #include "CircuitAI.h"
 #include "util/Utils.h"
+
+#include "spring/SpringCallback.h"
+
 #ifdef DEBUG_VIS
 #include "task/UnitTask.h"
 #include "Command.h"
@@ -39,6 +42,8 @@ CCircuitUnit::CCircuitUnit(Id unitId, Unit* unit, CCircuitDef* cdef)
 		, failFrame(-1)
 		, execFrame(-1)
 		, isDead(false)
+		, cmdFrame(-1)
+		, isIdleEvent(false)
 		, isDisarmed(false)
 		, disarmFrame(-1)
 		, isWeaponReady(true)
@@ -130,6 +135,18 @@ bool CCircuitUnit::IsForceUpdate(int frame)
 	return false;
 }
 
+bool CCircuitUnit::IsCmdQueueEmpty() const
+{
+	// NOTE: Count only, no Command objects
+	return manager->GetCircuit()->GetCallback()->Unit_GetCommandCount(GetId()) == 0;
+}
+
+void CCircuitUnit::SetCmdFrame()
+{
+	cmdFrame = manager->GetCircuit()->GetLastFrame();
+	isIdleEvent = false;
+}
+
 void CCircuitUnit::ManualFire(CEnemyInfo* target, int timeout)
 {
 	TRY_UNIT(manager->GetCircuit(), this,
@@ -139,6 +156,7 @@ void CCircuitUnit::ManualFire(CEnemyInfo* target, int timeout)
 			} else {
 				unit->DGun(target->GetUnit(), UNIT_COMMAND_OPTION_ALT_KEY | UNIT_COMMAND_OPTION_CONTROL_KEY, timeout);
 			}
+			SetCmdFrame();
 		} else {
 			CmdMoveTo(target->GetPos() + target->GetVel() * FRAMES_PER_SEC * 2, UNIT_COMMAND_OPTION_ALT_KEY, timeout);
 			CmdManualFire(UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
@@ -233,16 +251,67 @@ void CCircuitUnit::CmdMoveTo(const AIFloat3& pos, short options, int timeout)
 {
 //	unit->MoveTo(pos, options, timeout);
 	unit->ExecuteCustomCommand(CMD_RAW_MOVE, {pos.x, pos.y, pos.z}, options, timeout);
+	SetCmdFrame();
 }
 
 void CCircuitUnit::CmdJumpTo(const AIFloat3& pos, short options, int timeout)
 {
 	unit->ExecuteCustomCommand(CMD_JUMP, {pos.x, pos.y, pos.z}, options, timeout);
+	SetCmdFrame();
 }
 
 void CCircuitUnit::CmdAttackGround(const AIFloat3& pos, short options, int timeout)
 {
 	unit->ExecuteCustomCommand(CMD_ATTACK_GROUND, {pos.x, pos.y, pos.z}, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdFight(const AIFloat3& pos, short options, int timeout)
+{
+	unit->Fight(pos, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdPatrolTo(const AIFloat3& pos, short options, int timeout)
+{
+	unit->PatrolTo(pos, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdAttack(Unit* target, short options, int timeout)
+{
+	unit->Attack(target, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdGuard(Unit* target, short options, int timeout)
+{
+	unit->Guard(target, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdRepair(Unit* target, short options, int timeout)
+{
+	unit->Repair(target, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdReclaimUnit(Unit* target, short options, int timeout)
+{
+	unit->ReclaimUnit(target, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdReclaimInArea(const AIFloat3& pos, float radius, short options, int timeout)
+{
+	unit->ReclaimInArea(pos, radius, options, timeout);
+	SetCmdFrame();
+}
+
+void CCircuitUnit::CmdBuild(UnitDef* def, const AIFloat3& pos, int facing, short options, int timeout)
+{
+	unit->Build(def, pos, facing, options, timeout);
+	SetCmdFrame();
 }
 
 void CCircuitUnit::CmdWantedSpeed(float speed)
@@ -270,11 +339,13 @@ void CCircuitUnit::CmdFireAtRadar(bool state)
 void CCircuitUnit::CmdFindPad(int timeout)
 {
 	unit->ExecuteCustomCommand(CMD_FIND_PAD, {}, 0, timeout);
+	SetCmdFrame();
 }
 
 void CCircuitUnit::CmdManualFire(short options, int timeout)
 {
 	unit->ExecuteCustomCommand(CMD_ONECLICK_WEAPON, {}, options, timeout);
+	SetCmdFrame();
 }
 
 void CCircuitUnit::CmdPriority(float value)
@@ -295,6 +366,7 @@ void CCircuitUnit::CmdAirStrafe(float value)
 void CCircuitUnit::CmdTerraform(std::vector<float>&& params)
 {
 	unit->ExecuteCustomCommand(CMD_TERRAFORM_INTERNAL, params);
+	SetCmdFrame();
 }
 
 void CCircuitUnit::Attack(CEnemyInfo* enemy, int timeout)
@@ -305,15 +377,15 @@ void CCircuitUnit::Attack(CEnemyInfo* enemy, int timeout)
 		if (circuitDef->IsAttrMelee()) {
 			if (IsJumpReady()) {
 				CmdJumpTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
-				unit->Attack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
+				CmdAttack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
 			} else {
 				CmdMoveTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
-				unit->Attack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
+				CmdAttack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
 			}
 		} else {
-			unit->Attack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
+			CmdAttack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
 		}
-		unit->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);  // los-cheat related
+		CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);  // los-cheat related
 		CmdWantedSpeed(NO_SPEED_LIMIT);
 		CmdSetTarget(target);
 	)
@@ -326,12 +398,12 @@ void CCircuitUnit::Attack(const AIFloat3& position, int timeout)
 		if (circuitDef->IsAttrMelee()) {
 			if (IsJumpReady()) {
 				CmdJumpTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
-				unit->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
+				CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
 			} else {
 				CmdMoveTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
 			}
 		} else {
-			unit->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
+			CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
 		}
 		CmdWantedSpeed(NO_SPEED_LIMIT);
 	)
@@ -344,15 +416,15 @@ void CCircuitUnit::Attack(const AIFloat3& position, CEnemyInfo* enemy, int timeo
 		if (circuitDef->IsAttrMelee()) {
 			if (IsJumpReady()) {
 				CmdJumpTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
-				unit->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
+				CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
 			} else {
 				CmdMoveTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
 			}
 		} else {
-			unit->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
+			CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
 		}
-		unit->Attack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
-		unit->Fight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);  // los-cheat related
+		CmdAttack(enemy->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
+		CmdFight(position, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);  // los-cheat related
 		CmdWantedSpeed(NO_SPEED_LIMIT);
 		CmdSetTarget(target);
 	)
@@ -369,6 +441,7 @@ void CCircuitUnit::Guard(CCircuitUnit* target, int timeout)
 {
 	TRY_UNIT(manager->GetCircuit(), this,
 		unit->ExecuteCustomCommand(CMD_ORBIT, {(float)target->GetId(), 300.0f}, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
+		SetCmdFrame();
 //		unit->Guard(target->GetUnit(), UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
 //		CmdWantedSpeed(NO_SPEED_LIMIT);
 	)
@@ -380,7 +453,7 @@ void CCircuitUnit::Gather(const AIFloat3& groupPos, int timeout)
 	TRY_UNIT(manager->GetCircuit(), this,
 		CmdMoveTo(groupPos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, timeout);
 		CmdWantedSpeed(NO_SPEED_LIMIT);
-		unit->PatrolTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
+		CmdPatrolTo(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY, timeout);
 	)
 }
 
@@ -13,6 +13,7 @@
 #include "util/Defines.h"
 
 namespace springai {
+	class UnitDef;
 	class Weapon;
 }
 
@@ -20,6 +21,8 @@ namespace circuit {
 
 #define TRY_UNIT(c, u, x)	try { x } catch (const std::exception& e) { c->Garbage(u, e.what()); }
 
+#define UNIT_IDLE_SUSPECT	(FRAMES_PER_SEC * 30)  // without commands
+
 #define UNIT_CMD_OPTION				0
 
 #define CMD_ATTACK_GROUND			20
@@ -81,6 +84,15 @@ public:
 	void ForceUpdate(int frame) { execFrame = frame; }
 	bool IsForceUpdate(int frame);
 
+	void SetIdleEvent() { isIdleEvent = true; }
+	/*
+	 * Watchdog candidate: UnitIdle without new orders, or no orders for too long.
+	 * Order frame is stamped by the queueing Cmd* helpers once engine accepted the order.
+	 * Others are not queried from engine.
+	 */
+	bool IsIdleSuspect(int frame) const { return isIdleEvent || (frame - cmdFrame >= UNIT_IDLE_SUSPECT); }
+	bool IsCmdQueueEmpty() const;
+
 	void Dead() { isDead = true; }
 	bool IsDead() const { return isDead; }
 
@@ -107,6 +119,14 @@ public:
 	void CmdMoveTo(const springai::AIFloat3& pos, short options = 0, int timeout = INT_MAX);
 	void CmdJumpTo(const springai::AIFloat3& pos, short options = 0, int timeout = INT_MAX);
 	void CmdAttackGround(const springai::AIFloat3& pos, short options = 0, int timeout = INT_MAX);
+	void CmdFight(const springai::AIFloat3& pos, short options = 0, int timeout = INT_MAX);
+	void CmdPatrolTo(const springai::AIFloat3& pos, short options = 0, int timeout = INT_MAX);
+	void CmdAttack(springai::Unit* target, short options = 0, int timeout = INT_MAX);
+	void CmdGuard(springai::Unit* target, short options = 0, int timeout = INT_MAX);
+	void CmdRepair(springai::Unit* target, short options = 0, int timeout = INT_MAX);
+	void CmdReclaimUnit(springai::Unit* target, short options = 0, int timeout = INT_MAX);
+	void CmdReclaimInArea(const springai::AIFloat3& pos, float radius, short options = 0, int timeout = INT_MAX);
+	void CmdBuild(springai::UnitDef* def, const springai::AIFloat3& pos, int facing, short options = 0, int timeout = INT_MAX);
 	void CmdWantedSpeed(float speed = NO_SPEED_LIMIT);
 	void CmdSetTarget(CEnemyInfo* enemy);
 	void CmdCloak(bool state);
@@ -137,6 +157,8 @@ public:
 	int GetTargetTile() const { return targetTile; }
 
 private:
+	void SetCmdFrame();
+
 	// NOTE: taskFrame assigned on task change and OnUnitIdle to workaround idle spam.
 	//       Proper fix: do not issue any commands OnUnitIdle, delay them until next frame?
 	int taskFrame;
@@ -152,6 +174,9 @@ private:
 	bool execFrame;  // TODO: Replace by CExecuteAction?
 	bool isDead;
 
+	int cmdFrame;
+	bool isIdleEvent;
+
 	springai::Weapon* dgun;
 	springai::Weapon* weapon;  // main weapon
 	springai::Weapon* shield;
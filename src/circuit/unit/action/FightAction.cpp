@@ -48,14 +48,14 @@ void CFightAction::Update(CCircuitAI* circuit)
 
 	TRY_UNIT(circuit, unit,
 		const AIFloat3& pos = pPath->posPath[step];
-		unit->GetUnit()->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, lastFrame + FRAMES_PER_SEC * 60);
+		unit->CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, lastFrame + FRAMES_PER_SEC * 60);
 		unit->CmdWantedSpeed(stepSpeed);
 
 		constexpr short options = UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY | UNIT_COMMAND_OPTION_SHIFT_KEY;
 		for (int i = 2; (step < pathMaxIndex) && (i < 3); ++i) {
 			step = std::min(step + increment, pathMaxIndex);
 			const AIFloat3& pos = pPath->posPath[step];
-			unit->GetUnit()->Fight(pos, options, lastFrame + FRAMES_PER_SEC * 60 * i);
+			unit->CmdFight(pos, options, lastFrame + FRAMES_PER_SEC * 60 * i);
 		}
 	)
 }
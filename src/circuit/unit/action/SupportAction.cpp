@@ -47,9 +47,9 @@ void CSupportAction::Update(CCircuitAI* circuit)
 	}
 	TRY_UNIT(circuit, unit,
 		if (unit->GetCircuitDef()->IsAttrMelee()) {
-			unit->GetUnit()->Guard(leader->GetUnit());
+			unit->CmdGuard(leader->GetUnit());
 		} else {
-			unit->GetUnit()->Fight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
+			unit->CmdFight(pos, UNIT_COMMAND_OPTION_RIGHT_MOUSE_KEY, frame + FRAMES_PER_SEC * 60);
 		}
 	)
 }
@@ -27,6 +27,8 @@
 #include "AIFloat3.h"
 #include "Team.h"
 
+#include <algorithm>
+
 namespace circuit {
 
 using namespace springai;
@@ -86,7 +88,7 @@ void CAllyTeam::Init(CCircuitAI* circuit, float decloakRadius)
 	pathfinder = std::make_shared<CPathFinder>(circuit->GetScheduler(), &circuit->GetGameAttribute()->GetTerrainData());
 	factoryData = std::make_shared<CFactoryData>(circuit);
 
-	circuit->GetScheduler()->RunOnRelease(std::make_shared<CGameTask>(&CAllyTeam::DelegateAuthority, this, circuit));
+	circuit->GetScheduler()->RunOnRelease(MakeTask(&CAllyTeam::DelegateAuthority, this, circuit));
 }
 
 void CAllyTeam::Release()
@@ -96,10 +98,11 @@ void CAllyTeam::Release()
 		return;
 	}
 
-	for (auto& kv : friendlyUnits) {
-		delete kv.second;
+	ClearFriendlyUnits();
+	for (CAllyUnit* unit : allyUnitPool) {
+		delete unit;
 	}
-	friendlyUnits.clear();
+	allyUnitPool.clear();
 
 	mapManager = nullptr;
 	metalManager = nullptr;
@@ -121,6 +124,7 @@ void CAllyTeam::UpdateFriendlyUnits()
 {
 	// FIXME: Works bad because of circuit->GetCircuitDef(unitDefId) inside allyTeam:
 	//   If resigned ai updated the list then all teammates will have broken links to CCircuitDef*.
+	//   DelegateAuthority drops all units, survivors of regular update keep links of current authority.
 	// Options:
 	//   1) save CCircuitDef::Id instead of pointer. But u->GetCircuitDef() is too spread out to fix it now.
 	//   2) Move friendlyUnits from CAllyTeam level to CCircuitAI (and eat more memory and cpu on updates for each ai instance).
@@ -128,28 +132,81 @@ void CAllyTeam::UpdateFriendlyUnits()
 		return;
 	}
 
-	for (auto& kv : friendlyUnits) {
-		delete kv.second;
-	}
-	friendlyUnits.clear();
+	const std::vector<int>& unitIds = circuit->GetCallback()->GetFriendlyUnitIds();
+	friendlyIds.assign(unitIds.begin(), unitIds.end());
+	std::sort(friendlyIds.begin(), friendlyIds.end());
+
+	// NOTE: Both lists are sorted by id, survivors keep their CAllyUnit.
+	//   Engine reuses ids, def of survivor is checked to catch replaced unit.
 	COOAICallback* clb = circuit->GetCallback();
-	const std::vector<Unit*>& units = clb->GetFriendlyUnits();
-	for (Unit* u : units) {
-		if (u == nullptr) {  // engine returns vector with nullptrs
-			continue;
+	std::swap(friendlyUnits, prevUnits);
+	friendlyUnits.clear();
+	auto it = prevUnits.begin();
+	for (ICoreUnit::Id unitId : friendlyIds) {
+		while ((it != prevUnits.end()) && (it->first < unitId)) {
+			ReleaseFriendlyUnit(it->second);  // dead unit
+			++it;
+		}
+		if ((it != prevUnits.end()) && (it->first == unitId)) {
+			CCircuitDef* cdef = it->second->GetCircuitDef();
+			if ((cdef != nullptr) && (cdef->GetId() == clb->Unit_GetDefId(unitId))) {
+				friendlyUnits.push_back(*it);  // old unit
+			} else {
+				ReleaseFriendlyUnit(it->second);  // id reused by another unit
+				friendlyUnits.push_back(std::make_pair(unitId, AcquireFriendlyUnit(unitId)));
+			}
+			++it;
+		} else {
+			friendlyUnits.push_back(std::make_pair(unitId, AcquireFriendlyUnit(unitId)));  // new unit
 		}
-		int unitId = u->GetUnitId();
-		CCircuitDef::Id unitDefId = clb->Unit_GetDefId(unitId);
-		CAllyUnit* unit = new CAllyUnit(unitId, u, circuit->GetCircuitDef(unitDefId));
-		friendlyUnits[unitId] = unit;
 	}
+	for (; it != prevUnits.end(); ++it) {
+		ReleaseFriendlyUnit(it->second);  // dead unit
+	}
+	prevUnits.clear();
+
 	lastUpdate = circuit->GetLastFrame();
 }
 
 CAllyUnit* CAllyTeam::GetFriendlyUnit(ICoreUnit::Id unitId) const
 {
-	decltype(friendlyUnits)::const_iterator it = friendlyUnits.find(unitId);
-	return (it != friendlyUnits.end()) ? it->second : nullptr;
+	return ((unsigned)unitId < friendlyTable.size()) ? friendlyTable[unitId] : nullptr;
+}
+
+CAllyUnit* CAllyTeam::AcquireFriendlyUnit(ICoreUnit::Id unitId)
+{
+	COOAICallback* clb = circuit->GetCallback();
+	Unit* u = clb->GetUnit(unitId);
+	CCircuitDef* cdef = circuit->GetCircuitDef(clb->Unit_GetDefId(unitId));
+	CAllyUnit* unit;
+	if (allyUnitPool.empty()) {
+		unit = new CAllyUnit(unitId, u, cdef);
+	} else {
+		unit = allyUnitPool.back();
+		allyUnitPool.pop_back();
+		unit->Reset(unitId, u, cdef);
+	}
+
+	if ((unsigned)unitId >= friendlyTable.size()) {
+		friendlyTable.resize(unitId + 1, nullptr);
+	}
+	friendlyTable[unitId] = unit;
+	return unit;
+}
+
+void CAllyTeam::ReleaseFriendlyUnit(CAllyUnit* unit)
+{
+	friendlyTable[unit->GetId()] = nullptr;
+	allyUnitPool.push_back(unit);
+}
+
+void CAllyTeam::ClearFriendlyUnits()
+{
+	for (auto& kv : friendlyUnits) {
+		ReleaseFriendlyUnit(kv.second);
+	}
+	friendlyUnits.clear();
+	lastUpdate = -1;
 }
 
 bool CAllyTeam::EnemyInLOS(CEnemyUnit* data, CCircuitAI* ai)
@@ -372,10 +429,11 @@ void CAllyTeam::DelegateAuthority(CCircuitAI* curOwner)
 	for (CCircuitAI* circuit : curOwner->GetGameAttribute()->GetCircuits()) {
 		if (circuit->IsInitialized() && (circuit != curOwner) && (circuit->GetAllyTeamId() == curOwner->GetAllyTeamId())) {
 			this->circuit = circuit;
+			ClearFriendlyUnits();  // unit wrappers and CCircuitDef* belong to curOwner
 			mapManager->SetAuthority(circuit);
 			metalManager->SetAuthority(circuit);
 			energyGrid->SetAuthority(circuit);
-			circuit->GetScheduler()->RunOnRelease(std::make_shared<CGameTask>(&CAllyTeam::DelegateAuthority, this, circuit));
+			circuit->GetScheduler()->RunOnRelease(MakeTask(&CAllyTeam::DelegateAuthority, this, circuit));
 			break;
 		}
 	}
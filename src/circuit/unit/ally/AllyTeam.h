@@ -35,7 +35,7 @@ struct STerrainMapArea;
 class CAllyTeam {
 public:
 	using Id = int;
-	using AllyUnits = std::map<ICoreUnit::Id, CAllyUnit*>;
+	using AllyUnits = std::vector<std::pair<ICoreUnit::Id, CAllyUnit*>>;  // sorted by id
 	using TeamIds = std::unordered_set<Id>;
 	union SBox {
 		SBox() : edge{0.f, 0.f, 0.f, 0.f} {}
@@ -116,6 +116,9 @@ public:
 
 private:
 	void DelegateAuthority(CCircuitAI* curOwner);
+	CAllyUnit* AcquireFriendlyUnit(ICoreUnit::Id unitId);
+	void ReleaseFriendlyUnit(CAllyUnit* unit);
+	void ClearFriendlyUnits();
 
 	CCircuitAI* circuit;  // authority
 	TeamIds teamIds;
@@ -125,6 +128,10 @@ private:
 	int resignSize;
 	int lastUpdate;
 	AllyUnits friendlyUnits;  // owner
+	AllyUnits prevUnits;  // buffer
+	std::vector<CAllyUnit*> friendlyTable;  // id-indexed friendlyUnits
+	std::vector<CAllyUnit*> allyUnitPool;  // owner, reusable
+	std::vector<ICoreUnit::Id> friendlyIds;  // buffer
 	CQuadField quadField;
 
 	std::map<int, SClusterTeam> occupants;  // Cluster owner on start. clusterId: SClusterTeam
@@ -25,6 +25,16 @@ CAllyUnit::~CAllyUnit()
 {
 }
 
+void CAllyUnit::Reset(Id unitId, springai::Unit* unit, CCircuitDef* cdef)
+{
+	delete this->unit;
+	this->id = unitId;
+	this->unit = unit;
+	circuitDef = cdef;
+	task = nullptr;
+	posFrame = -1;
+}
+
 const AIFloat3& CAllyUnit::GetPos(int frame)
 {
 	if (posFrame != frame) {
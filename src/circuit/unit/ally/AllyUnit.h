@@ -22,6 +22,9 @@ public:
 	CAllyUnit(Id unitId, springai::Unit* unit, CCircuitDef* cdef);
 	virtual ~CAllyUnit();
 
+	// Reuse for another unit
+	void Reset(Id unitId, springai::Unit* unit, CCircuitDef* cdef);
+
 	CCircuitDef* GetCircuitDef() const { return circuitDef; }
 	IUnitTask* GetTask() const { return task; }
 	const springai::AIFloat3& GetPos(int frame);
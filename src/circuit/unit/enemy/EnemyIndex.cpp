@@ -0,0 +1,102 @@
+/*
+ * EnemyIndex.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#include "unit/enemy/EnemyIndex.h"
+#include "unit/enemy/EnemyUnit.h"
+#include "terrain/TerrainManager.h"
+#include "CircuitAI.h"
+#include "util/Utils.h"
+
+namespace circuit {
+
+using namespace springai;
+
+CEnemyIndex::CEnemyIndex(CCircuitAI* circuit)
+		: circuit(circuit)
+		, lastFrame(-1)
+		, isDirty(true)
+{
+	cellXSize = std::max((CTerrainManager::GetTerrainWidth() + ENEMY_INDEX_CELL - 1) / ENEMY_INDEX_CELL, 1);
+	cellZSize = std::max((CTerrainManager::GetTerrainHeight() + ENEMY_INDEX_CELL - 1) / ENEMY_INDEX_CELL, 1);
+	cellStart.resize(cellXSize * cellZSize + 1);
+}
+
+CEnemyIndex::~CEnemyIndex()
+{
+}
+
+void CEnemyIndex::Validate()
+{
+	if (isDirty || (lastFrame != circuit->GetLastFrame())) {
+		Rebuild();
+	}
+}
+
+void CEnemyIndex::Rebuild()
+{
+	isDirty = false;
+	lastFrame = circuit->GetLastFrame();
+
+	const FloatVec& heightMap = circuit->GetTerrainManager()->GetAreaData()->heightMap;
+	const int hmX = CTerrainManager::GetTerrainWidth() / SQUARE_SIZE;
+	const int hmZ = CTerrainManager::GetTerrainHeight() / SQUARE_SIZE;
+
+	const CCircuitAI::EnemyInfos& enemies = circuit->GetEnemyInfos();
+	entries.clear();
+	entries.reserve(enemies.size());
+	cellEntries.resize(enemies.size());
+	std::fill(cellStart.begin(), cellStart.end(), 0);
+
+	auto getCell = [this](const AIFloat3& pos) {
+		const int x = utils::clamp(int(pos.x) / ENEMY_INDEX_CELL, 0, cellXSize - 1);
+		const int z = utils::clamp(int(pos.z) / ENEMY_INDEX_CELL, 0, cellZSize - 1);
+		return z * cellXSize + x;
+	};
+
+	auto getElevation = [&heightMap, hmX, hmZ](const AIFloat3& pos) {
+		// Bilinear between square centers
+		const float fx = utils::clamp(pos.x / SQUARE_SIZE - 0.5f, 0.f, float(hmX - 1));
+		const float fz = utils::clamp(pos.z / SQUARE_SIZE - 0.5f, 0.f, float(hmZ - 1));
+		const int x0 = int(fx), z0 = int(fz);
+		const int x1 = std::min(x0 + 1, hmX - 1), z1 = std::min(z0 + 1, hmZ - 1);
+		const float tx = fx - x0, tz = fz - z0;
+		const float h0 = heightMap[z0 * hmX + x0] + (heightMap[z0 * hmX + x1] - heightMap[z0 * hmX + x0]) * tx;
+		const float h1 = heightMap[z1 * hmX + x0] + (heightMap[z1 * hmX + x1] - heightMap[z1 * hmX + x0]) * tx;
+		return h0 + (h1 - h0) * tz;
+	};
+
+	for (auto& kv : enemies) {
+		CEnemyInfo* enemy = kv.second;
+		const AIFloat3& pos = enemy->GetPos();
+		entries.push_back({enemy, pos, getElevation(pos)});
+		++cellStart[getCell(pos) + 1];
+	}
+
+	// Counting sort by cell
+	for (unsigned i = 1; i < cellStart.size(); ++i) {
+		cellStart[i] += cellStart[i - 1];
+	}
+	cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+	for (unsigned i = 0; i < entries.size(); ++i) {
+		cellEntries[cellFill[getCell(entries[i].pos)]++] = i;
+	}
+}
+
+CEnemyIndex::SCellRect CEnemyIndex::GetCellRect(int cell) const
+{
+	const int x = cell % cellXSize;
+	const int z = cell / cellXSize;
+	const float maxVal = std::numeric_limits<float>::max();
+	return SCellRect {
+		(x == 0) ? -maxVal : float(x * ENEMY_INDEX_CELL),
+		(z == 0) ? -maxVal : float(z * ENEMY_INDEX_CELL),
+		(x == cellXSize - 1) ? maxVal : float((x + 1) * ENEMY_INDEX_CELL),
+		(z == cellZSize - 1) ? maxVal : float((z + 1) * ENEMY_INDEX_CELL)
+	};
+}
+
+} // namespace circuit
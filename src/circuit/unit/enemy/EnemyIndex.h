@@ -0,0 +1,131 @@
+/*
+ * EnemyIndex.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_UNIT_ENEMY_ENEMYINDEX_H_
+#define SRC_CIRCUIT_UNIT_ENEMY_ENEMYINDEX_H_
+
+#include "AIFloat3.h"
+
+#include <vector>
+#include <algorithm>
+
+#define ENEMY_INDEX_CELL	512  // elmos
+
+namespace circuit {
+
+class CCircuitAI;
+class CEnemyInfo;
+
+/*
+ * Per AI index of known enemies for target selection, rebuilt lazily once per frame
+ * or after enemy add/remove. Entries keep order of CCircuitAI::EnemyInfos for
+ * order-dependent scans, uniform grid over entries serves range and nearest queries.
+ * Elevation is bilinear over terrain heightmap: no engine call per candidate,
+ * close to engine's interpolated GetElevationAt but not bit-exact.
+ */
+class CEnemyIndex {
+public:
+	struct SEntry {
+		CEnemyInfo* enemy;
+		springai::AIFloat3 pos;
+		float elevation;
+	};
+	struct SCellRect {
+		float minX, minZ, maxX, maxZ;  // border cells are open to out of map entries
+		float SqDistance2D(const springai::AIFloat3& pos) const {
+			const float dx = std::max(std::max(minX - pos.x, pos.x - maxX), 0.f);
+			const float dz = std::max(std::max(minZ - pos.z, pos.z - maxZ), 0.f);
+			return dx * dx + dz * dz;
+		}
+	};
+
+	CEnemyIndex(CCircuitAI* circuit);
+	virtual ~CEnemyIndex();
+
+	void SetDirty() { isDirty = true; }
+
+	/*
+	 * Visit every enemy (hidden included) in id order
+	 */
+	template<typename F>
+	void ForEach(F&& func) {
+		Validate();
+		for (const SEntry& entry : entries) {
+			func(entry);
+		}
+	}
+
+	/*
+	 * Visit enemies within maxRange (2D) in id order, only cells overlapping the circle are scanned
+	 */
+	template<typename F>
+	void ForEachInRange(const springai::AIFloat3& pos, float maxRange, F&& func);
+
+	/*
+	 * Entry with minimal score among ones that pass filter and check, ties in id order.
+	 * Filter and score run for every entry, expensive check only by ascending score until first pass:
+	 * O(N + k log N) for k checked candidates.
+	 */
+	template<typename F, typename S, typename C>
+	const SEntry* FindBest(F&& filter, S&& score, C&& check);
+	/*
+	 * Same result, cellScore(rect) must be lower bound of score for any position in rect.
+	 * Cells are expanded best-first by bound: filter and score run only for entries of cells
+	 * whose bound is below the found candidate.
+	 */
+	template<typename F, typename S, typename B, typename C>
+	const SEntry* FindBest(F&& filter, S&& score, B&& cellScore, C&& check);
+
+	/*
+	 * Up to k nearest (2D) enemies within maxRange that pass predicate, ascending distance.
+	 * Predicate is checked only for entries closer than current k-th candidate.
+	 */
+	template<typename P>
+	void FindNearest(const springai::AIFloat3& pos, float maxRange, unsigned k, P&& pred,
+					 std::vector<const SEntry*>& outEntries);
+	template<typename P>
+	const SEntry* FindNearest(const springai::AIFloat3& pos, float maxRange, P&& pred) {
+		FindNearest(pos, maxRange, 1, std::forward<P>(pred), nearest);
+		return nearest.empty() ? nullptr : nearest.front();
+	}
+
+private:
+	void Validate();
+	void Rebuild();
+	SCellRect GetCellRect(int cell) const;
+
+	CCircuitAI* circuit;
+	int lastFrame;
+	bool isDirty;
+
+	std::vector<SEntry> entries;
+	std::vector<int> cellStart;  // CSR over cells, size = cells + 1
+	std::vector<int> cellEntries;
+	std::vector<int> cellFill;
+	int cellXSize;
+	int cellZSize;
+
+	struct SCandidate {
+		float sqDist;  // or score
+		const SEntry* entry;
+		bool operator<(const SCandidate& other) const { return sqDist < other.sqDist; }
+	};
+	std::vector<SCandidate> candidates;  // max-heap by sqDist
+	std::vector<const SEntry*> nearest;
+	struct SCellBound {
+		float score;
+		int cell;
+	};
+	std::vector<SCellBound> cellBounds;
+	std::vector<int> inRange;
+};
+
+} // namespace circuit
+
+#include "unit/enemy/EnemyIndex.hpp"
+
+#endif // SRC_CIRCUIT_UNIT_ENEMY_ENEMYINDEX_H_
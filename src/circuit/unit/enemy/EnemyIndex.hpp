@@ -0,0 +1,178 @@
+/*
+ * EnemyIndex.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_UNIT_ENEMY_ENEMYINDEX_H_
+#	error "Don't include this file directly, include EnemyIndex.h instead"
+#endif
+
+#include "unit/enemy/EnemyIndex.h"
+
+namespace circuit {
+
+template<typename F>
+void CEnemyIndex::ForEachInRange(const springai::AIFloat3& pos, float maxRange, F&& func)
+{
+	Validate();
+	const float sqRange = maxRange * maxRange;
+	const int x1 = std::min(std::max(int(pos.x - maxRange) / ENEMY_INDEX_CELL, 0), cellXSize - 1);
+	const int x2 = std::min(std::max(int(pos.x + maxRange) / ENEMY_INDEX_CELL, 0), cellXSize - 1);
+	const int z1 = std::min(std::max(int(pos.z - maxRange) / ENEMY_INDEX_CELL, 0), cellZSize - 1);
+	const int z2 = std::min(std::max(int(pos.z + maxRange) / ENEMY_INDEX_CELL, 0), cellZSize - 1);
+	inRange.clear();
+	for (int z = z1; z <= z2; ++z) {
+		for (int x = x1; x <= x2; ++x) {
+			const int cell = z * cellXSize + x;
+			for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+				if (pos.SqDistance2D(entries[cellEntries[i]].pos) <= sqRange) {
+					inRange.push_back(cellEntries[i]);
+				}
+			}
+		}
+	}
+	// NOTE: Callers keep order-dependent logic of full scan
+	std::sort(inRange.begin(), inRange.end());
+	for (int i : inRange) {
+		func(entries[i]);
+	}
+}
+
+template<typename F, typename S, typename C>
+const CEnemyIndex::SEntry* CEnemyIndex::FindBest(F&& filter, S&& score, C&& check)
+{
+	Validate();
+	candidates.clear();
+	for (const SEntry& entry : entries) {
+		if (filter(entry)) {
+			candidates.push_back({score(entry), &entry});
+		}
+	}
+	// Min-heap in O(N), pop only until first pass instead of full sort
+	auto greater = [](const SCandidate& a, const SCandidate& b) {
+		return (b.sqDist < a.sqDist) || ((a.sqDist == b.sqDist) && (b.entry < a.entry));
+	};
+	std::make_heap(candidates.begin(), candidates.end(), greater);
+	while (!candidates.empty()) {
+		std::pop_heap(candidates.begin(), candidates.end(), greater);
+		const SEntry* entry = candidates.back().entry;
+		if (check(*entry)) {
+			return entry;
+		}
+		candidates.pop_back();
+	}
+	return nullptr;
+}
+
+template<typename F, typename S, typename B, typename C>
+const CEnemyIndex::SEntry* CEnemyIndex::FindBest(F&& filter, S&& score, B&& cellScore, C&& check)
+{
+	Validate();
+	candidates.clear();
+	cellBounds.clear();
+	for (int cell = 0; cell < cellXSize * cellZSize; ++cell) {
+		if (cellStart[cell] < cellStart[cell + 1]) {
+			cellBounds.push_back({cellScore(GetCellRect(cell)), cell});
+		}
+	}
+	auto greater = [](const SCandidate& a, const SCandidate& b) {
+		return (b.sqDist < a.sqDist) || ((a.sqDist == b.sqDist) && (b.entry < a.entry));
+	};
+	auto greaterCell = [](const SCellBound& a, const SCellBound& b) {
+		return b.score < a.score;
+	};
+	std::make_heap(cellBounds.begin(), cellBounds.end(), greaterCell);
+	while (true) {
+		// NOTE: Strict less keeps id order of ties that may hide in unexpanded cell
+		if (!candidates.empty() && (cellBounds.empty() || (candidates.front().sqDist < cellBounds.front().score))) {
+			std::pop_heap(candidates.begin(), candidates.end(), greater);
+			const SEntry* entry = candidates.back().entry;
+			if (check(*entry)) {
+				return entry;
+			}
+			candidates.pop_back();
+		} else if (!cellBounds.empty()) {
+			std::pop_heap(cellBounds.begin(), cellBounds.end(), greaterCell);
+			const int cell = cellBounds.back().cell;
+			cellBounds.pop_back();
+			for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+				const SEntry& entry = entries[cellEntries[i]];
+				if (filter(entry)) {
+					candidates.push_back({score(entry), &entry});
+					std::push_heap(candidates.begin(), candidates.end(), greater);
+				}
+			}
+		} else {
+			return nullptr;
+		}
+	}
+}
+
+template<typename P>
+void CEnemyIndex::FindNearest(const springai::AIFloat3& pos, float maxRange, unsigned k, P&& pred,
+							  std::vector<const SEntry*>& outEntries)
+{
+	Validate();
+	outEntries.clear();
+	candidates.clear();
+	if ((k == 0) || entries.empty()) {
+		return;
+	}
+
+	const float sqRange = maxRange * maxRange;
+	const int cx = std::min(std::max(int(pos.x) / ENEMY_INDEX_CELL, 0), cellXSize - 1);
+	const int cz = std::min(std::max(int(pos.z) / ENEMY_INDEX_CELL, 0), cellZSize - 1);
+	const int maxRing = std::max(std::max(cx, cellXSize - 1 - cx), std::max(cz, cellZSize - 1 - cz));
+
+	auto visitCell = [&](int x, int z) {
+		const int cell = z * cellXSize + x;
+		for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+			const SEntry& entry = entries[cellEntries[i]];
+			const float sqDist = pos.SqDistance2D(entry.pos);
+			if ((sqDist > sqRange)
+				|| ((candidates.size() >= k) && (sqDist >= candidates.front().sqDist))
+				|| !pred(entry))
+			{
+				continue;
+			}
+			candidates.push_back({sqDist, &entry});
+			std::push_heap(candidates.begin(), candidates.end());
+			if (candidates.size() > k) {
+				std::pop_heap(candidates.begin(), candidates.end());
+				candidates.pop_back();
+			}
+		}
+	};
+
+	for (int r = 0; r <= maxRing; ++r) {
+		// NOTE: Clamped coordinates keep the bound valid for positions out of map
+		const float bound = std::max(r - 1, 0) * ENEMY_INDEX_CELL;
+		if ((bound * bound > sqRange)
+			|| ((candidates.size() >= k) && (bound * bound >= candidates.front().sqDist)))
+		{
+			break;
+		}
+		for (int dz = -r; dz <= r; ++dz) {
+			const int z = cz + dz;
+			if ((z < 0) || (z >= cellZSize)) {
+				continue;
+			}
+			const int step = ((dz == -r) || (dz == r)) ? 1 : std::max(2 * r, 1);
+			for (int dx = -r; dx <= r; dx += step) {
+				const int x = cx + dx;
+				if ((x >= 0) && (x < cellXSize)) {
+					visitCell(x, z);
+				}
+			}
+		}
+	}
+
+	std::sort_heap(candidates.begin(), candidates.end());
+	for (const SCandidate& c : candidates) {
+		outEntries.push_back(c.entry);
+	}
+}
+
+} // namespace circuit
@@ -21,7 +21,6 @@
 #include "spring/SpringCallback.h"
 
 #include "WrappUnit.h"
-#include "Cheats.h"
 
 #include <limits>
 
@@ -29,6 +28,10 @@ namespace circuit {
 
 using namespace springai;
 
+// Frames of a full sweep over enemies, twice per threat update.
+// -1 is for threat-draw and k-means frame
+#define ENEMY_UPDATE_SPLIT	((THREAT_UPDATE_RATE - 1) / 2)
+
 CEnemyManager::CEnemyManager(CCircuitAI* circuit)
 		: circuit(circuit)
 		, enemyIterator(0)
@@ -73,16 +76,13 @@ CEnemyUnit* CEnemyManager::GetEnemyUnit(ICoreUnit::Id unitId) const
 
 void CEnemyManager::UpdateEnemyDatas(CQuadField& quadField)
 {
-//	static std::vector<CEnemyUnit*> batchUpdate;
-
 	if (enemyIterator >= enemyUpdates.size()) {
 		enemyIterator = 0;
 	}
 	enemyGarbage.clear();
 
 	// stagger the Update's
-	// -1 is for threat-draw and k-means frame
-	unsigned int n = (enemyUpdates.size() / (THREAT_UPDATE_RATE - 1)) + 1;
+	unsigned int n = (enemyUpdates.size() / ENEMY_UPDATE_SPLIT) + 1;
 
 	const int maxFrame = circuit->GetLastFrame() - FRAMES_PER_SEC * 60 * 20;
 	while ((enemyIterator < enemyUpdates.size()) && (n != 0)) {
@@ -95,6 +95,7 @@ void CEnemyManager::UpdateEnemyDatas(CQuadField& quadField)
 		int frame = enemy->GetLastSeen();
 		if ((frame != -1) && (maxFrame >= frame)) {
 			GarbageEnemy(enemy);
+			++enemyIterator;
 			continue;
 		}
 
@@ -102,6 +103,7 @@ void CEnemyManager::UpdateEnemyDatas(CQuadField& quadField)
 			const AIFloat3& pos = enemy->GetUnit()->GetPos();
 			if (CTerrainData::IsNotInBounds(pos)) {  // NOTE: Unit id validation. No EnemyDestroyed sometimes apparently
 				GarbageEnemy(enemy);
+				++enemyIterator;
 				continue;
 			}
 
@@ -109,38 +111,21 @@ void CEnemyManager::UpdateEnemyDatas(CQuadField& quadField)
 			quadField.MovedEnemyUnit(enemy);
 
 			if (enemy->IsInLOS()) {
-				// NOTE: batch-reading hack
-//				batchUpdate.push_back(enemy);
-				enemy->UpdateInLosData();  // heavy on engine calls
+				enemy->UpdateInLosData();
 			}
 		}
 
 		++enemyIterator;
 		--n;
 	}
-
-//	if (!circuit->IsCheating()) {
-//		// AI knows what units are in los, hence reduce the amount of useless
-//		// engine InLos checks for each single param of the enemy unit
-//		circuit->GetCheats()->SetEnabled(true);
-//	}
-//
-//	for (CEnemyUnit* enemy : batchUpdate) {
-//		enemy->UpdateInLosData();  // heavy on engine calls
-//	}
-//	batchUpdate.clear();
-//
-//	if (!circuit->IsCheating()) {
-//		circuit->GetCheats()->SetEnabled(false);
-//	}
 }
 
 void CEnemyManager::PrepareUpdate()
 {
 	CMapManager* mapMgr = circuit->GetMapManager();
 
-	hostileDatas.clear();
-	hostileDatas.reserve(mapMgr->GetHostileUnits().size() + mapMgr->GetEnemyFakes().size());
+	snapshot.Clear();
+	snapshot.Reserve(mapMgr->GetHostileUnits().size() + mapMgr->GetEnemyFakes().size() + mapMgr->GetPeaceUnits().size());
 	for (auto& kv : mapMgr->GetHostileUnits()) {
 		CEnemyUnit* e = kv.second;
 
@@ -148,7 +133,7 @@ void CEnemyManager::PrepareUpdate()
 			continue;
 		}
 
-		hostileDatas.push_back(e->GetData());
+		snapshot.Push(e, true);
 	}
 
 	const int frame = circuit->GetLastFrame();
@@ -157,15 +142,13 @@ void CEnemyManager::PrepareUpdate()
 		if (mapMgr->IsInLOS(e->GetPos()) || (frame >= e->GetTimeout())) {
 			deadFakes.push_back(e);
 		} else {
-			hostileDatas.push_back(e->GetData());
+			snapshot.Push(e, true);
 		}
 	}
 	for (CEnemyFake* e : deadFakes) {
 		circuit->GetAllyTeam()->UnregisterEnemyFake(e);
 	}
 
-	peaceDatas.clear();
-	peaceDatas.reserve(mapMgr->GetPeaceUnits().size());
 	for (auto& kv : mapMgr->GetPeaceUnits()) {
 		CEnemyUnit* e = kv.second;
 
@@ -173,7 +156,7 @@ void CEnemyManager::PrepareUpdate()
 			continue;
 		}
 
-		peaceDatas.push_back(e->GetData());
+		snapshot.Push(e, false);
 	}
 }
 
@@ -184,8 +167,8 @@ void CEnemyManager::EnqueueUpdate()
 //	}
 	isUpdating = true;
 
-	circuit->GetScheduler()->RunParallelTask(std::make_shared<CGameTask>(&CEnemyManager::Update, this),
-											 std::make_shared<CGameTask>(&CEnemyManager::Apply, this));
+	circuit->GetScheduler()->RunParallelTask(MakeTask(&CEnemyManager::Update, this),
+											 MakeTask(&CEnemyManager::Apply, this));
 }
 
 bool CEnemyManager::UnitInLOS(CEnemyUnit* data)
@@ -306,7 +289,6 @@ void CEnemyManager::GarbageEnemy(CEnemyUnit* enemy)
 {
 	enemyGarbage.push_back(enemy->GetId());
 	UnregisterEnemyUnit(enemy);
-	++enemyIterator;
 }
 
 void CEnemyManager::AddEnemyCost(const CEnemyUnit* e)
@@ -412,45 +394,41 @@ void CEnemyManager::KMeansIteration()
 
 	// calculate a new K. change the formula to adjust max K, needs to be 1 minimum.
 	constexpr int KMEANS_BASE_MAX_K = 32;
-	const auto enemySize = hostileDatas.size() + peaceDatas.size();
+	const int enemySize = snapshot.Size();
 	int newK = std::min(KMEANS_BASE_MAX_K, 1 + (int)sqrtf(enemySize));
 
 	// change the number of means according to newK
 	assert(newK > 0/* && enemyGoups.size() > 0*/);
 	// add a new means, just use one of the positions
-	AIFloat3 newMeansPosition = hostileDatas.empty()
-			? (peaceDatas.empty() ? enemyPos : peaceDatas.begin()->pos)
-			: hostileDatas.begin()->pos;
+	AIFloat3 newMeansPosition = (enemySize == 0)
+			? enemyPos
+			: AIFloat3(snapshot.posX[0], 0.f, snapshot.posZ[0]);
 //	newMeansPosition.y = circuit->GetMap()->GetElevationAt(newMeansPosition.x, newMeansPosition.z) + K_MEANS_ELEVATION;
 	groupData.enemyGroups.resize(newK, SEnemyGroup(newMeansPosition));
 
 	// check all positions and assign them to means, complexity n*k for one iteration
 	std::vector<int> unitsClosestMeanID(enemySize, -1);
+	std::vector<float> closestDistance(enemySize, std::numeric_limits<float>::max());
 	std::vector<int> numUnitsAssignedToMean(newK, 0);
 
-	{
-		int i = 0;
-		for (const std::vector<SEnemyData>& datas : {hostileDatas, peaceDatas}) {
-			for (const SEnemyData& enemy : datas) {
-				float closestDistance = std::numeric_limits<float>::max();
-				int closestIndex = -1;
-
-				for (int m = 0; m < newK; m++) {
-					const AIFloat3& mean = groupData.enemyGroups[m].pos;
-					float distance = enemy.pos.SqDistance2D(mean);
-
-					if (distance < closestDistance) {
-						closestDistance = distance;
-						closestIndex = m;
-					}
-				}
-
-				// position i is closest to the mean at closestIndex
-				unitsClosestMeanID[i++] = closestIndex;
-				numUnitsAssignedToMean[closestIndex]++;
+	const float* posX = snapshot.posX.data();
+	const float* posZ = snapshot.posZ.data();
+	for (int m = 0; m < newK; m++) {
+		const float meanX = groupData.enemyGroups[m].pos.x;
+		const float meanZ = groupData.enemyGroups[m].pos.z;
+		// NOTE: contiguous columns, vectorizable
+		for (int i = 0; i < enemySize; ++i) {
+			const float distance = SQUARE(posX[i] - meanX) + SQUARE(posZ[i] - meanZ);
+			if (distance < closestDistance[i]) {
+				closestDistance[i] = distance;
+				unitsClosestMeanID[i] = m;
 			}
 		}
 	}
+	for (int i = 0; i < enemySize; ++i) {
+		// position i is closest to the mean at closestIndex
+		numUnitsAssignedToMean[unitsClosestMeanID[i]]++;
+	}
 
 	// change the means according to which positions are assigned to them
 	// use meanAverage for indexes with 0 pos'es assigned
@@ -467,31 +445,29 @@ void CEnemyManager::KMeansIteration()
 		eg.threat = 0.f;
 	}
 
-	{
-		int i = 0;
-		for (const std::vector<SEnemyData>& datas : {hostileDatas, peaceDatas}) {
-			for (const SEnemyData& enemy : datas) {
-				int meanIndex = unitsClosestMeanID[i++];
-				SEnemyGroup& eg = newMeans[meanIndex];
-
-				// don't divide by 0
-				float num = std::max(1, numUnitsAssignedToMean[meanIndex]);
-				eg.pos += enemy.pos / num;
-
-				if (!enemy.IsFake()) {
-					eg.units.push_back(enemy.id);
-				}
-
-				if (enemy.cdef != nullptr) {
-					eg.roleCosts[enemy.cdef->GetMainRole()] += enemy.cost;
-					if (!enemy.cdef->IsMobile() || enemy.IsInRadarOrLOS()) {
-						eg.cost += enemy.cost;
-					}
-					eg.threat += enemy.threat * (enemy.cdef->IsMobile() ? initThrMod.inMobile : initThrMod.inStatic);
-				} else {
-					eg.threat += enemy.threat;
-				}
+	for (int i = 0; i < enemySize; ++i) {
+		int meanIndex = unitsClosestMeanID[i];
+		SEnemyGroup& eg = newMeans[meanIndex];
+
+		// don't divide by 0
+		float num = std::max(1, numUnitsAssignedToMean[meanIndex]);
+		eg.pos += AIFloat3(posX[i], 0.f, posZ[i]) / num;
+
+		if (!snapshot.IsFake(i)) {
+			eg.units.push_back(snapshot.id[i]);
+		}
+
+		const CCircuitDef* edef = snapshot.cdef[i];
+		const float threat = snapshot.threat[i];
+		if (edef != nullptr) {
+			const float cost = snapshot.cost[i];
+			eg.roleCosts[edef->GetMainRole()] += cost;
+			if (!snapshot.IsMobile(i) || snapshot.IsInRadarOrLOS(i)) {
+				eg.cost += cost;
 			}
+			eg.threat += threat * (snapshot.IsMobile(i) ? initThrMod.inMobile : initThrMod.inStatic);
+		} else {
+			eg.threat += threat;
 		}
 	}
 
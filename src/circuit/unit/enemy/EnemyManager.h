@@ -41,8 +41,7 @@ public:
 
 	const std::vector<ICoreUnit::Id>& GetGarbage() const { return enemyGarbage; }
 
-	const std::vector<SEnemyData>& GetHostileDatas() const { return hostileDatas; }
-	const std::vector<SEnemyData>& GetPeaceDatas() const { return peaceDatas; }
+	const SEnemySnapshot& GetSnapshot() const { return snapshot; }
 
 	void UpdateEnemyDatas(CQuadField& quadField);
 
@@ -114,8 +113,7 @@ private:
 
 	std::vector<ICoreUnit::Id> enemyGarbage;
 
-	std::vector<SEnemyData> hostileDatas;  // immutable during threaded processing
-	std::vector<SEnemyData> peaceDatas;  // immutable during threaded processing
+	SEnemySnapshot snapshot;  // immutable during threaded processing
 
 	SGroupData groupData0, groupData1;  // Double-buffer for threading
 	std::atomic<SGroupData*> pGroupData;
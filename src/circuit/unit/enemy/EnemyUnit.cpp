@@ -16,6 +16,72 @@ namespace circuit {
 
 using namespace springai;
 
+void SEnemySnapshot::Clear()
+{
+	posX.clear();
+	posZ.clear();
+	speed.clear();
+	threat.clear();
+	shieldPower.clear();
+	cost.clear();
+	for (std::vector<int>& r : range) {
+		r.clear();
+	}
+	flags.clear();
+	cdef.clear();
+	id.clear();
+	numHostile = 0;
+}
+
+void SEnemySnapshot::Reserve(size_t size)
+{
+	posX.reserve(size);
+	posZ.reserve(size);
+	speed.reserve(size);
+	threat.reserve(size);
+	shieldPower.reserve(size);
+	cost.reserve(size);
+	for (std::vector<int>& r : range) {
+		r.reserve(size);
+	}
+	flags.reserve(size);
+	cdef.reserve(size);
+	id.reserve(size);
+}
+
+void SEnemySnapshot::Push(const CEnemyUnit* e, bool isHostile)
+{
+	assert(!isHostile || (numHostile == Size()));  // hostiles first
+	const AIFloat3& pos = e->GetPos();
+	posX.push_back(pos.x);
+	posZ.push_back(pos.z);
+	speed.push_back(e->GetVel().Length2D());
+	threat.push_back(e->GetThreat());
+	shieldPower.push_back(e->GetShieldPower());
+	cost.push_back(e->GetCost());
+	for (CCircuitDef::ThreatT tt = 0; tt < static_cast<CCircuitDef::ThreatT>(CCircuitDef::ThreatType::_SIZE_); ++tt) {
+		range[tt].push_back(e->GetRange(static_cast<CCircuitDef::ThreatType>(tt)));
+	}
+	CCircuitDef* edef = e->GetCircuitDef();
+	FM flag = FlagMask::NONE;
+	if (isHostile) {
+		flag |= FlagMask::HOSTILE;
+		++numHostile;
+	}
+	if (e->IsFake()) {
+		flag |= FlagMask::FAKE;
+	}
+	if (e->IsInRadarOrLOS()) {
+		flag |= FlagMask::RADAR_OR_LOS;
+	}
+	if ((edef != nullptr) && edef->IsMobile()) {
+		flag |= FlagMask::MOBILE;
+	}
+	flags.push_back(flag);
+	cdef.push_back(edef);
+	id.push_back(e->GetId());
+}
+
 CEnemyUnit::CEnemyUnit(Id unitId, Unit* unit, CCircuitDef* cdef)
 		: ICoreUnit(unitId, unit)
 		, knownFrame(-1)
@@ -117,17 +183,25 @@ void CEnemyUnit::UpdateInRadarData(const AIFloat3& p)
 {
 	data.pos = p;
 	CTerrainData::CorrectPosition(data.pos);
-	data.vel = unit->GetVel();
+	if ((data.cdef == nullptr) || data.cdef->IsMobile()) {  // static stays at ZeroVector
+		data.vel = unit->GetVel();
+	}
 }
 
+/*
+ * Engine calls are per unit and checked for LOS each, read only what is used
+ */
 void CEnemyUnit::UpdateInLosData()
 {
 	if (shield != nullptr) {
 		data.shieldPower = shield->GetShieldPower();
 	}
 	data.health = unit->GetHealth();
-	data.isParalyzed = unit->IsParalyzed();
 	data.isBeingBuilt = unit->IsBeingBuilt();
+	if ((data.cdef == nullptr) || (data.cdef->GetThrDamage() < 1e-3f)) {
+		return;  // GetDamage doesn't look at paralyze and disarm
+	}
+	data.isParalyzed = unit->IsParalyzed();
 	data.isDisarmed = unit->GetRulesParamFloat("disarmed", 0) > .0f;
 }
 
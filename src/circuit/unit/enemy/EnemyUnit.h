@@ -87,6 +87,44 @@ struct SEnemyData {
 	bool IsDead()           const { return losStatus & LosMask::DEAD; }
 };
 
+class CEnemyUnit;
+
+/*
+ * Columnar snapshot of hostile and peace enemies, built once per threat update.
+ * Read-only during threaded processing (CThreatMap, CInfluenceMap, k-means).
+ * Hostiles occupy [0, numHostile), peace units [numHostile, Size()).
+ */
+struct SEnemySnapshot {
+	enum FlagMask: char {NONE = 0x00,
+						 HOSTILE = 0x01, FAKE = 0x02, RADAR_OR_LOS = 0x04, MOBILE = 0x08};
+	using FM = std::underlying_type<FlagMask>::type;
+
+	void Clear();
+	void Reserve(size_t size);
+	void Push(const CEnemyUnit* e, bool isHostile);
+	size_t Size() const { return id.size(); }
+
+	int GetRange(CCircuitDef::ThreatType t, size_t i) const {
+		return range[static_cast<CCircuitDef::ThreatT>(t)][i];
+	}
+	bool IsHostile(size_t i)     const { return flags[i] & FlagMask::HOSTILE; }
+	bool IsFake(size_t i)        const { return flags[i] & FlagMask::FAKE; }
+	bool IsInRadarOrLOS(size_t i) const { return flags[i] & FlagMask::RADAR_OR_LOS; }
+	bool IsMobile(size_t i)      const { return flags[i] & FlagMask::MOBILE; }  // unknown enemy is not mobile
+
+	std::vector<float> posX;
+	std::vector<float> posZ;
+	std::vector<float> speed;  // 2d, elmos per frame
+	std::vector<float> threat;
+	std::vector<float> shieldPower;
+	std::vector<float> cost;
+	std::array<std::vector<int>, static_cast<CCircuitDef::ThreatT>(CCircuitDef::ThreatType::_SIZE_)> range;
+	std::vector<FM> flags;
+	std::vector<CCircuitDef*> cdef;
+	std::vector<ICoreUnit::Id> id;
+	size_t numHostile = 0;
+};
+
 /*
  * Per AllyTeam common enemy information
  */
@@ -0,0 +1,168 @@
+/*
+ * BinaryCache.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#include "util/BinaryCache.h"
+#include "util/Utils.h"
+
+#include <fstream>
+#include <cstdio>
+#include <atomic>
+#ifdef _WIN32
+#include <process.h>
+#define getpid	_getpid
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace circuit {
+
+static const char CACHE_MAGIC[4] = {'C', 'A', 'I', 'C'};
+
+uint64_t CBinaryCache::Hash(const void* data, size_t size, uint64_t seed)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+CBinaryCache::CBinaryCache(uint32_t version, uint64_t key)
+		: version(version)
+		, key(key)
+		, data(nullptr)
+		, size(0)
+		, pos(0)
+		, mapping(nullptr)
+		, mapSize(0)
+{
+}
+
+CBinaryCache::~CBinaryCache()
+{
+	Unload();
+}
+
+bool CBinaryCache::Load(const std::string& filename)
+{
+	Unload();
+
+	const char* file = nullptr;
+	size_t fileSize = 0;
+#ifndef _WIN32
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if ((fstat(fd, &st) == 0) && (st.st_size >= (off_t)sizeof(SHeader))) {
+		void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (ptr != MAP_FAILED) {
+			mapping = ptr;
+			mapSize = st.st_size;
+			file = static_cast<const char*>(ptr);
+			fileSize = mapSize;
+		}
+	}
+	close(fd);
+#else
+	std::ifstream is(filename, std::ios::binary | std::ios::ate);
+	if (is.is_open() && (is.tellg() >= (std::streamoff)sizeof(SHeader))) {
+		fileBuffer.resize(is.tellg());
+		is.seekg(0);
+		if (is.read(fileBuffer.data(), fileBuffer.size())) {
+			file = fileBuffer.data();
+			fileSize = fileBuffer.size();
+		}
+	}
+#endif
+	if (file == nullptr) {
+		Unload();
+		return false;
+	}
+
+	SHeader header;
+	memcpy(&header, file, sizeof(SHeader));
+	if ((memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+		|| (header.version != version)
+		|| (header.key != key)
+		|| (header.size != fileSize - sizeof(SHeader))
+		|| (header.checksum != Hash(file + sizeof(SHeader), header.size)))
+	{
+		Unload();
+		return false;
+	}
+
+	data = file + sizeof(SHeader);
+	size = header.size;
+	pos = 0;
+	return true;
+}
+
+bool CBinaryCache::Save(const std::string& filename) const
+{
+	SHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = version;
+	header.key = key;
+	header.size = payload.size();
+	header.checksum = Hash(payload.data(), payload.size());
+
+	// NOTE: Other instances may read the same file, replace it at once.
+	//   Temporary name is unique per process and per save: several AIs may share one process.
+	static std::atomic<unsigned> saveNum(0);
+	const std::string tmpName = filename + "." + utils::int_to_string(getpid())
+			+ "-" + utils::int_to_string(saveNum++) + ".tmp";
+	{
+		std::ofstream os(tmpName, std::ios::binary | std::ios::trunc);
+		if (!os.is_open()) {
+			return false;
+		}
+		os.write(reinterpret_cast<const char*>(&header), sizeof(SHeader));
+		os.write(payload.data(), payload.size());
+		if (!os.good()) {
+			os.close();
+			std::remove(tmpName.c_str());
+			return false;
+		}
+	}
+#ifdef _WIN32
+	std::remove(filename.c_str());
+#endif
+	return std::rename(tmpName.c_str(), filename.c_str()) == 0;
+}
+
+void CBinaryCache::Unload()
+{
+#ifndef _WIN32
+	if (mapping != nullptr) {
+		munmap(mapping, mapSize);
+	}
+#endif
+	mapping = nullptr;
+	mapSize = 0;
+	data = nullptr;
+	size = pos = 0;
+	fileBuffer.clear();
+}
+
+bool CBinaryCache::ReadBytes(void* dst, size_t count)
+{
+	if ((data == nullptr) || (count > size - pos)) {
+		return false;
+	}
+	memcpy(dst, data + pos, count);
+	pos += count;
+	return true;
+}
+
+} // namespace circuit
@@ -0,0 +1,116 @@
+/*
+ * BinaryCache.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_BINARYCACHE_H_
+#define SRC_CIRCUIT_UTIL_BINARYCACHE_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace circuit {
+
+/*
+ * Versioned on-disk blob of precomputed analysis.
+ * File: header (magic, version, key, payload size, payload checksum) + payload.
+ * Key is the hash of all inputs, stale or corrupted file is rejected on Load.
+ * Payload is memory-mapped where supported.
+ * Values are plain trivially-copyable data, endianness of the host.
+ */
+class CBinaryCache {
+public:
+	static constexpr uint64_t HASH_SEED = 14695981039346656037ULL;
+
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed = HASH_SEED);  // FNV-1a
+	template<typename T> static uint64_t HashValue(const T& value, uint64_t seed = HASH_SEED) {
+		static_assert(std::is_trivially_copyable<T>::value, "Plain data only");
+		return Hash(&value, sizeof(T), seed);
+	}
+	template<typename T> static uint64_t HashVector(const std::vector<T>& values, uint64_t seed = HASH_SEED) {
+		static_assert(std::is_trivially_copyable<T>::value, "Plain data only");
+		return Hash(values.data(), values.size() * sizeof(T), HashValue(values.size(), seed));
+	}
+
+	CBinaryCache(uint32_t version, uint64_t key);
+	~CBinaryCache();
+
+	// Reader
+	bool Load(const std::string& filename);
+	bool IsLoaded() const { return data != nullptr; }
+	template<typename T> bool Read(T& value);
+	template<typename T> bool Read(std::vector<T>& values);
+
+	// Writer
+	template<typename T> void Write(const T& value);
+	template<typename T> void Write(const std::vector<T>& values);
+	bool Save(const std::string& filename) const;
+
+private:
+	struct SHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t key;
+		uint64_t size;
+		uint64_t checksum;
+	};
+
+	void Unload();
+	bool ReadBytes(void* dst, size_t count);
+
+	uint32_t version;
+	uint64_t key;
+
+	const char* data;  // payload
+	size_t size;
+	size_t pos;
+	void* mapping;  // whole file
+	size_t mapSize;
+	std::vector<char> fileBuffer;  // loaded file without mmap
+	std::vector<char> payload;  // to write
+};
+
+template<typename T>
+bool CBinaryCache::Read(T& value)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Plain data only");
+	return ReadBytes(&value, sizeof(T));
+}
+
+template<typename T>
+bool CBinaryCache::Read(std::vector<T>& values)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Plain data only");
+	uint64_t count;
+	if (!Read(count) || (count > (size - pos) / sizeof(T))) {
+		return false;
+	}
+	values.resize(count);
+	return ReadBytes(values.data(), count * sizeof(T));
+}
+
+template<typename T>
+void CBinaryCache::Write(const T& value)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Plain data only");
+	const char* src = reinterpret_cast<const char*>(&value);
+	payload.insert(payload.end(), src, src + sizeof(T));
+}
+
+template<typename T>
+void CBinaryCache::Write(const std::vector<T>& values)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Plain data only");
+	Write<uint64_t>(values.size());
+	const char* src = reinterpret_cast<const char*>(values.data());
+	payload.insert(payload.end(), src, src + values.size() * sizeof(T));
+}
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_BINARYCACHE_H_
@@ -61,12 +61,12 @@ static inline std::string MakeFileSystemCompatible(const std::string& str)
 	return cleaned;
 }
 
-static inline bool LocatePath(DataDirs* datadirs, std::string& filename)
+static inline bool LocatePath(DataDirs* datadirs, std::string& filename, bool writable = false)
 {
 	static const size_t absPath_sizeMax = 2048;
 	char absPath[absPath_sizeMax];
 	const bool dir = !filename.empty() && (*filename.rbegin() == '/' || *filename.rbegin() == '\\');
-	const bool located = datadirs->LocatePath(absPath, absPath_sizeMax, filename.c_str(), false /*writable*/, false /*create*/, dir, false /*common*/);
+	const bool located = datadirs->LocatePath(absPath, absPath_sizeMax, filename.c_str(), writable, writable /*create*/, dir, false /*common*/);
 	if (located) {
 		filename = absPath;
 	}
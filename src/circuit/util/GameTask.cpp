@@ -8,9 +8,149 @@
 #include "util/GameTask.h"
 #include "util/Utils.h"
 
+#include "System/Threading/SpringThreading.h"
+
+#include <atomic>
+#include <vector>
+
+#define TASK_POOL_CLASSES	4  // block sizes 64, 128, 256, 512
+#define TASK_POOL_MIN_SHIFT	6
+#define TASK_POOL_BATCH		32  // blocks moved between thread and depot at once
+
 namespace circuit {
 
-std::shared_ptr<CGameTask> CGameTask::emptyTask = std::make_shared<CGameTask>([]() { return; });
+namespace {
+
+struct SFreeBlock {
+	SFreeBlock* next;
+};
+
+struct SFreeList {
+	SFreeBlock* head;
+	int size;
+};
+
+/*
+ * Shared batches of free blocks, released at library unload
+ */
+struct SDepot {
+	~SDepot() {
+		for (std::vector<SFreeBlock*>& batches : classes) {
+			for (SFreeBlock* block : batches) {
+				while (block != nullptr) {
+					SFreeBlock* next = block->next;
+					::operator delete(block);
+					block = next;
+				}
+			}
+		}
+	}
+	spring::mutex mutex;
+	std::vector<SFreeBlock*> classes[TASK_POOL_CLASSES];
+};
+
+thread_local SFreeList freeLists[TASK_POOL_CLASSES];  // NOTE: trivial, flushed by FlushThread
+std::atomic<unsigned long long> numAllocs(0);
+
+SDepot& GetDepot()
+{
+	static SDepot depot;  // NOTE: constructed before emptyTask, destroyed after
+	return depot;
+}
+
+int GetClass(std::size_t size)
+{
+	int cls = 0;
+	while ((cls < TASK_POOL_CLASSES) && (size > ((std::size_t)1 << (TASK_POOL_MIN_SHIFT + cls)))) {
+		++cls;
+	}
+	return cls;
+}
+
+} // namespace
+
+void* CTaskPool::Alloc(std::size_t size)
+{
+	const int cls = GetClass(size);
+	if (cls >= TASK_POOL_CLASSES) {
+		numAllocs.fetch_add(1, std::memory_order_relaxed);
+		return ::operator new(size);
+	}
+
+	SFreeList& list = freeLists[cls];
+	if (list.head == nullptr) {
+		SDepot& depot = GetDepot();
+		std::lock_guard<spring::mutex> lock(depot.mutex);
+		std::vector<SFreeBlock*>& batches = depot.classes[cls];
+		if (batches.empty()) {
+			numAllocs.fetch_add(1, std::memory_order_relaxed);
+			return ::operator new((std::size_t)1 << (TASK_POOL_MIN_SHIFT + cls));
+		}
+		list.head = batches.back();
+		batches.pop_back();
+		list.size = 0;
+		for (SFreeBlock* b = list.head; b != nullptr; b = b->next) {  // flushed batches are partial
+			++list.size;
+		}
+	}
+
+	SFreeBlock* block = list.head;
+	list.head = block->next;
+	--list.size;
+	return block;
+}
+
+void CTaskPool::Free(void* ptr, std::size_t size)
+{
+	const int cls = GetClass(size);
+	if (cls >= TASK_POOL_CLASSES) {
+		::operator delete(ptr);
+		return;
+	}
+
+	SFreeList& list = freeLists[cls];
+	SFreeBlock* block = static_cast<SFreeBlock*>(ptr);
+	block->next = list.head;
+	list.head = block;
+	if (++list.size < TASK_POOL_BATCH * 2) {
+		return;
+	}
+
+	// Spill one batch, keep another for allocations
+	SFreeBlock* batch = list.head;
+	SFreeBlock* tail = batch;
+	for (int i = 1; i < TASK_POOL_BATCH; ++i) {
+		tail = tail->next;
+	}
+	list.head = tail->next;
+	list.size -= TASK_POOL_BATCH;
+	tail->next = nullptr;
+
+	SDepot& depot = GetDepot();
+	std::lock_guard<spring::mutex> lock(depot.mutex);
+	depot.classes[cls].push_back(batch);
+}
+
+void CTaskPool::FlushThread()
+{
+	SDepot& depot = GetDepot();
+	std::lock_guard<spring::mutex> lock(depot.mutex);
+	for (int cls = 0; cls < TASK_POOL_CLASSES; ++cls) {
+		SFreeList& list = freeLists[cls];
+		if (list.head != nullptr) {
+			depot.classes[cls].push_back(list.head);  // NOTE: partial batch
+		}
+		list.head = nullptr;
+		list.size = 0;
+	}
+}
+
+unsigned long long CTaskPool::GetNumAllocs()
+{
+	return numAllocs.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<CGameTask> CGameTask::emptyTask = MakeTask([]() { return; });
 
 CGameTask::~CGameTask()
 {
@@ -18,11 +158,7 @@ CGameTask::~CGameTask()
 
 void CGameTask::Run()
 {
-	CGameTask::_Impl_base* __t = static_cast<CGameTask::_Impl_base*>(__b.get());
-	CGameTask::__shared_base_type __local;
-	__local.swap(__t->_M_this_ptr);
-
-	__t->_M_run();
+	func();
 }
 
 } // namespace circuit
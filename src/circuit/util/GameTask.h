@@ -11,45 +11,190 @@
 
 #include <memory>
 #include <functional>
+#include <type_traits>
+#include <new>
+#include <cstddef>
+
+#define TASK_INLINE_SIZE	64  // bytes of captures stored in place, bigger go into CTaskPool
 
 namespace circuit {
 
-class CGameTask {
+/*
+ * Fixed size blocks for tasks and oversized captures.
+ * Each thread keeps freelists per size class, refilled from and spilled into shared depot by batches.
+ * Heap is touched only when depot is empty or block is bigger than 512, that's what GetNumAllocs counts.
+ * CScheduler keeps tasks, captures, timers and job queues in it, hence the count covers its whole path.
+ */
+class CTaskPool {
 public:
-	template<typename _Callable, typename... _Args>
-		explicit CGameTask(_Callable&& __f, _Args&&... __args) {
-			__b = _M_make_routine(std::bind(std::forward<_Callable>(__f), std::forward<_Args>(__args)...));
+	static void* Alloc(std::size_t size);
+	static void Free(void* ptr, std::size_t size);
+	/*
+	 * Return freelists of the calling thread to depot, before thread exit
+	 */
+	static void FlushThread();
+	static unsigned long long GetNumAllocs();
+};
+
+template<typename T> struct STaskAllocator {
+	using value_type = T;
+	STaskAllocator() noexcept = default;
+	template<typename U> STaskAllocator(const STaskAllocator<U>&) noexcept {}
+	T* allocate(std::size_t n) { return static_cast<T*>(CTaskPool::Alloc(n * sizeof(T))); }
+	void deallocate(T* p, std::size_t n) noexcept { CTaskPool::Free(p, n * sizeof(T)); }
+	template<typename U> bool operator==(const STaskAllocator<U>&) const noexcept { return true; }
+	template<typename U> bool operator!=(const STaskAllocator<U>&) const noexcept { return false; }
+};
+
+/*
+ * Move-only type-erased callable with small buffer.
+ * Captures up to TASK_INLINE_SIZE are stored in place, others in CTaskPool block.
+ */
+template<typename _Signature> class CTaskFunc;
+
+template<typename _Res, typename... _Args>
+class CTaskFunc<_Res (_Args...)> {
+public:
+	CTaskFunc() noexcept : ops(nullptr) {}
+	CTaskFunc(std::nullptr_t) noexcept : ops(nullptr) {}
+	template<typename _Callable, typename _Func = typename std::decay<_Callable>::type,
+			 typename = typename std::enable_if<!std::is_same<_Func, CTaskFunc>::value>::type>
+		CTaskFunc(_Callable&& __f) : ops(&SOps<_Func>::ops) {
+			SOps<_Func>::Create(storage, std::forward<_Callable>(__f));
 		}
-	~CGameTask();
+	CTaskFunc(CTaskFunc&& other) noexcept : ops(other.ops) {
+		if (ops != nullptr) {
+			ops->move(storage, other.storage);
+			other.ops = nullptr;
+		}
+	}
+	CTaskFunc(const CTaskFunc&) = delete;
+	~CTaskFunc() { Reset(); }
 
-	void Run();
+	CTaskFunc& operator=(CTaskFunc&& other) noexcept {
+		if (this != &other) {
+			Reset();
+			ops = other.ops;
+			if (ops != nullptr) {
+				ops->move(storage, other.storage);
+				other.ops = nullptr;
+			}
+		}
+		return *this;
+	}
+	CTaskFunc& operator=(const CTaskFunc&) = delete;
+	CTaskFunc& operator=(std::nullptr_t) noexcept {
+		Reset();
+		return *this;
+	}
+
+	_Res operator()(_Args... __args) {
+		return ops->invoke(storage, std::forward<_Args>(__args)...);
+	}
+
+	explicit operator bool() const noexcept { return ops != nullptr; }
+	bool operator==(std::nullptr_t) const noexcept { return ops == nullptr; }
+	bool operator!=(std::nullptr_t) const noexcept { return ops != nullptr; }
 
 private:
-	struct _Impl_base;
-	typedef std::shared_ptr<_Impl_base>	__shared_base_type;
-	struct _Impl_base {
-		__shared_base_type	_M_this_ptr;
-		inline virtual ~_Impl_base();
-		virtual void _M_run() = 0;
+	struct SOpsTable {
+		_Res (*invoke)(void* storage, _Args&&... __args);
+		void (*move)(void* dst, void* src);
+		void (*destroy)(void* storage);
 	};
-	template<typename _Callable> struct _Impl : public _Impl_base {
-		_Callable _M_func;
-		_Impl(_Callable&& __f) : _M_func(std::forward<_Callable>(__f)) {}
-		void _M_run() { _M_func(); }
+
+	template<typename _Func> struct SOps {
+		using Inplace = std::integral_constant<bool, (sizeof(_Func) <= TASK_INLINE_SIZE)
+				&& std::is_nothrow_move_constructible<_Func>::value>;
+		static_assert(alignof(_Func) <= alignof(std::max_align_t), "Over-aligned task");
+
+		template<typename _Callable> static void Create(void* storage, _Callable&& __f) {
+			Create(storage, std::forward<_Callable>(__f), Inplace());
+		}
+		template<typename _Callable> static void Create(void* storage, _Callable&& __f, std::true_type) {
+			new (storage) _Func(std::forward<_Callable>(__f));
+		}
+		template<typename _Callable> static void Create(void* storage, _Callable&& __f, std::false_type) {
+			void* block = CTaskPool::Alloc(sizeof(_Func));
+			*static_cast<_Func**>(storage) = new (block) _Func(std::forward<_Callable>(__f));
+		}
+		static _Func* Get(void* storage, std::true_type) { return static_cast<_Func*>(storage); }
+		static _Func* Get(void* storage, std::false_type) { return *static_cast<_Func**>(storage); }
+
+		static _Res Invoke(void* storage, _Args&&... __args) {
+			return (*Get(storage, Inplace()))(std::forward<_Args>(__args)...);
+		}
+		static void Move(void* dst, void* src) {
+			Move(dst, src, Inplace());
+		}
+		static void Move(void* dst, void* src, std::true_type) {
+			_Func* f = static_cast<_Func*>(src);
+			new (dst) _Func(std::move(*f));
+			f->~_Func();
+		}
+		static void Move(void* dst, void* src, std::false_type) {
+			*static_cast<_Func**>(dst) = *static_cast<_Func**>(src);
+		}
+		static void Destroy(void* storage) {
+			Destroy(storage, Inplace());
+		}
+		static void Destroy(void* storage, std::true_type) {
+			static_cast<_Func*>(storage)->~_Func();
+		}
+		static void Destroy(void* storage, std::false_type) {
+			_Func* f = *static_cast<_Func**>(storage);
+			f->~_Func();
+			CTaskPool::Free(f, sizeof(_Func));
+		}
+
+		static constexpr SOpsTable ops = {&Invoke, &Move, &Destroy};
 	};
 
-	template<typename _Callable> std::shared_ptr<_Impl<_Callable>> _M_make_routine(_Callable&& __f) {
-		// Create and allocate full data structure, not base.
-		return std::make_shared<_Impl<_Callable>>(std::forward<_Callable>(__f));
+	void Reset() noexcept {
+		if (ops != nullptr) {
+			ops->destroy(storage);
+			ops = nullptr;
+		}
 	}
 
-	__shared_base_type __b;
+	alignas(std::max_align_t) unsigned char storage[TASK_INLINE_SIZE];
+	const SOpsTable* ops;
+};
+
+template<typename _Res, typename... _Args>
+template<typename _Func>
+constexpr typename CTaskFunc<_Res (_Args...)>::SOpsTable CTaskFunc<_Res (_Args...)>::SOps<_Func>::ops;
+
+class CGameTask {
+public:
+	template<typename _Callable, typename... _Args>
+		explicit CGameTask(_Callable&& __f, _Args&&... __args)
+			: func(std::bind(std::forward<_Callable>(__f), std::forward<_Args>(__args)...))
+			, timerHead(-1)
+		{}
+	CGameTask(const CGameTask&) = delete;
+	CGameTask& operator=(const CGameTask&) = delete;
+	~CGameTask();
+
+	void Run();
+
+private:
+	friend class CScheduler;
+	CTaskFunc<void ()> func;
+	int timerHead;  // first CScheduler::STimer of the task, -1 if not scheduled. NOTE: one scheduler per task
 
 public:
 	static std::shared_ptr<CGameTask> emptyTask;
 };
 
-inline CGameTask::_Impl_base::~_Impl_base() = default;
+/*
+ * Task and its shared_ptr control block in one pooled block
+ */
+template<typename... _Args>
+inline std::shared_ptr<CGameTask> MakeTask(_Args&&... __args)
+{
+	return std::allocate_shared<CGameTask>(STaskAllocator<CGameTask>(), std::forward<_Args>(__args)...);
+}
 
 } // namespace circuit
 
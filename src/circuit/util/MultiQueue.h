@@ -12,10 +12,11 @@
 
 #include <deque>
 #include <functional>
+#include <memory>
 
 namespace circuit {
 
-template <typename T>
+template <typename T, typename A = std::allocator<T>>
 class CMultiQueue {
 public:
 	typedef std::function<void (T& item)> ProcessFunction;
@@ -34,6 +35,7 @@ public:
 	 */
 	void Pop(T& item);
 	void Push(const T& item);
+	void Push(T&& item);
 	bool IsEmpty();
 	size_t Size();
 	/*
@@ -54,7 +56,7 @@ public:
 	CMultiQueue& operator=(const CMultiQueue&) = delete; // disable assignment
 
 private:
-	std::deque<T> _queue;
+	std::deque<T, A> _queue;
 	spring::mutex _mutex;
 	spring::condition_variable_any _cond;
 };
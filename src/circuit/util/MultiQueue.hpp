@@ -14,32 +14,32 @@
 
 namespace circuit {
 
-template <typename T>
-T CMultiQueue<T>::Pop()
+template <typename T, typename A>
+T CMultiQueue<T, A>::Pop()
 {
 	std::unique_lock<spring::mutex> mlock(_mutex);
 	while (_queue.empty()) {
 		_cond.wait(mlock);
 	}
 
-	auto val = _queue.front();
+	T val = std::move(_queue.front());
 	_queue.pop_front();
 	return val;
 }
 
-template <typename T>
-void CMultiQueue<T>::Pop(T& item)
+template <typename T, typename A>
+void CMultiQueue<T, A>::Pop(T& item)
 {
 	std::unique_lock<spring::mutex> mlock(_mutex);
 
 	_cond.wait(mlock, [this]() { return !_queue.empty(); });
 
-	item = _queue.front();
+	item = std::move(_queue.front());
 	_queue.pop_front();
 }
 
-template <typename T>
-void CMultiQueue<T>::Push(const T& item)
+template <typename T, typename A>
+void CMultiQueue<T, A>::Push(const T& item)
 {
 	std::unique_lock<spring::mutex> mlock(_mutex);
 	_queue.push_back(item);
@@ -47,26 +47,35 @@ void CMultiQueue<T>::Push(const T& item)
 	_cond.notify_one();
 }
 
-template <typename T>
-bool CMultiQueue<T>::IsEmpty()
+template <typename T, typename A>
+void CMultiQueue<T, A>::Push(T&& item)
+{
+	std::unique_lock<spring::mutex> mlock(_mutex);
+	_queue.push_back(std::move(item));
+	mlock.unlock();
+	_cond.notify_one();
+}
+
+template <typename T, typename A>
+bool CMultiQueue<T, A>::IsEmpty()
 {
 	std::lock_guard<spring::mutex> mlock(_mutex);
 	return _queue.empty();
 }
 
-template <typename T>
-size_t CMultiQueue<T>::Size()
+template <typename T, typename A>
+size_t CMultiQueue<T, A>::Size()
 {
 	std::lock_guard<spring::mutex> mlock(_mutex);
 	return _queue.size();
 }
 
-template <typename T>
-bool CMultiQueue<T>::PopAndProcess(ProcessFunction process)
+template <typename T, typename A>
+bool CMultiQueue<T, A>::PopAndProcess(ProcessFunction process)
 {
 	std::unique_lock<spring::mutex> mlock(_mutex);
 	if (!_queue.empty()) {
-		auto item = _queue.front();
+		T item = std::move(_queue.front());
 		_queue.pop_front();
 		mlock.unlock();
 		process(item);
@@ -75,12 +84,12 @@ bool CMultiQueue<T>::PopAndProcess(ProcessFunction process)
 	return false;
 }
 
-template <typename T>
-void CMultiQueue<T>::PopAndProcessAll(ProcessFunction process)
+template <typename T, typename A>
+void CMultiQueue<T, A>::PopAndProcessAll(ProcessFunction process)
 {
 	std::unique_lock<spring::mutex> mlock(_mutex);
 	while (!_queue.empty()) {
-		auto item = _queue.front();
+		T item = std::move(_queue.front());
 		_queue.pop_front();
 //		mlock.unlock();
 		process(item);
@@ -88,15 +97,15 @@ void CMultiQueue<T>::PopAndProcessAll(ProcessFunction process)
 	}
 }
 
-template <typename T>
-void CMultiQueue<T>::RemoveAllIf(ConditionFunction condition)
+template <typename T, typename A>
+void CMultiQueue<T, A>::RemoveAllIf(ConditionFunction condition)
 {
 	std::lock_guard<spring::mutex> mlock(_mutex);
-	typename std::deque<T>::iterator iter = _queue.begin();
+	typename std::deque<T, A>::iterator iter = _queue.begin();
 	while (iter != _queue.end()) {
 		if (condition(*iter)) {
 //			iter = _queue.erase(iter);  // NOTE: micro-opt
-			*iter = _queue.back();
+			*iter = std::move(_queue.back());
 			_queue.pop_back();
 		} else {
 			++iter;
@@ -104,8 +113,8 @@ void CMultiQueue<T>::RemoveAllIf(ConditionFunction condition)
 	}
 }
 
-template <typename T>
-void CMultiQueue<T>::Clear()
+template <typename T, typename A>
+void CMultiQueue<T, A>::Clear()
 {
 	std::lock_guard<spring::mutex> mlock(_mutex);
 	_queue.clear();
@@ -0,0 +1,259 @@
+/*
+ * Profiler.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#include "util/Profiler.h"
+
+#include "System/Threading/SpringThreading.h"
+
+#include <algorithm>
+#include <limits>
+#include <fstream>
+#include <cstdio>
+
+namespace circuit {
+
+static const char* zoneNames[PROFILE_MAX_ZONES];
+static std::atomic<int> numZones(0);
+static spring::mutex profileMutex;
+
+std::vector<CProfiler::SThreadData*> CProfiler::threadDatas;
+
+int CProfiler::RegisterZone(const char* name)
+{
+	std::lock_guard<spring::mutex> lock(profileMutex);
+	const int num = numZones.load(std::memory_order_relaxed);
+	for (int i = 0; i < num; ++i) {
+		if (zoneNames[i] == name) {  // same call site in other instantiation
+			return i;
+		}
+	}
+	if (num >= PROFILE_MAX_ZONES - 1) {
+		zoneNames[PROFILE_MAX_ZONES - 1] = "<overflow>";
+		return PROFILE_MAX_ZONES - 1;
+	}
+	zoneNames[num] = name;
+	numZones.store(num + 1, std::memory_order_release);
+	return num;
+}
+
+void CProfiler::Record(int zoneId, int64_t start, int64_t end)
+{
+	SThreadData* data = GetThreadData();
+	const int64_t duration = end - start;
+
+	const uint64_t head = data->head.load(std::memory_order_relaxed);
+	SEvent& event = data->events[head & (PROFILE_RING_SIZE - 1)];
+	event.zoneId.store(zoneId, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.duration.store(duration, std::memory_order_relaxed);
+	data->head.store(head + 1, std::memory_order_release);
+
+	// NOTE: Single writer, load + store instead of locked read-modify-write
+	SZoneStats& zone = data->zones[zoneId];
+	zone.count.store(zone.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	zone.total.store(zone.total.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+	if (zone.max.load(std::memory_order_relaxed) < duration) {
+		zone.max.store(duration, std::memory_order_relaxed);
+	}
+	std::atomic<uint32_t>& bucket = zone.buckets[GetBucket(duration)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+std::string CProfiler::Summary()
+{
+	std::lock_guard<spring::mutex> lock(profileMutex);
+	std::string text = "zone | count | total ms | p50 us | p99 us | max us\n";
+	const int num = PROFILE_MAX_ZONES;  // including overflow
+	std::vector<uint64_t> buckets(PROFILE_BUCKETS);
+	char line[128];
+	for (int z = 0; z < num; ++z) {
+		int64_t total;
+		int64_t max;
+		const uint64_t count = MergeZone(z, total, max, buckets);
+		if ((count == 0) || (zoneNames[z] == nullptr)) {
+			continue;
+		}
+
+		auto percentile = [&buckets, count](double p) {
+			const uint64_t rank = std::max<uint64_t>(1, count * p);
+			uint64_t sum = 0;
+			for (int b = 0; b < PROFILE_BUCKETS; ++b) {
+				sum += buckets[b];
+				if (sum >= rank) {
+					return GetBucketValue(b);
+				}
+			}
+			return GetBucketValue(PROFILE_BUCKETS - 1);
+		};
+		snprintf(line, sizeof(line), " | %llu | %.3f | %.1f | %.1f | %.1f\n", (unsigned long long)count,
+				total * 1e-6, percentile(.5) * 1e-3, percentile(.99) * 1e-3, max * 1e-3);
+		text += zoneNames[z];
+		text += line;
+	}
+	return text;
+}
+
+bool CProfiler::ExportTrace(const std::string& filename)
+{
+	std::ofstream file(filename, std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::lock_guard<spring::mutex> lock(profileMutex);
+	int64_t origin = std::numeric_limits<int64_t>::max();
+	for (SThreadData* data : threadDatas) {
+		const uint64_t head = data->head.load(std::memory_order_acquire);
+		const uint64_t tail = (head > PROFILE_RING_SIZE) ? (head - PROFILE_RING_SIZE) : 0;
+		for (uint64_t i = tail; i < head; ++i) {
+			origin = std::min(origin, data->events[i & (PROFILE_RING_SIZE - 1)].start.load(std::memory_order_relaxed));
+		}
+	}
+
+	auto escape = [](const char* name) {
+		std::string str;
+		for (; *name != '\0'; ++name) {
+			if ((*name == '"') || (*name == '\\')) {
+				str += '\\';
+			}
+			str += *name;
+		}
+		return str;
+	};
+	const int num = PROFILE_MAX_ZONES;  // including overflow
+	std::vector<std::string> names(num);
+	for (int z = 0; z < num; ++z) {
+		names[z] = (zoneNames[z] != nullptr) ? escape(zoneNames[z]) : "";
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	char line[64];
+	bool isFirst = true;
+	for (SThreadData* data : threadDatas) {
+		const uint64_t head = data->head.load(std::memory_order_acquire);
+		const uint64_t tail = (head > PROFILE_RING_SIZE) ? (head - PROFILE_RING_SIZE) : 0;
+		for (uint64_t i = tail; i < head; ++i) {
+			const SEvent& event = data->events[i & (PROFILE_RING_SIZE - 1)];
+			const int zoneId = event.zoneId.load(std::memory_order_relaxed);
+			if ((unsigned)zoneId >= (unsigned)num) {
+				continue;
+			}
+			file << (isFirst ? "\n" : ",\n") << "{\"name\":\"" << names[zoneId] << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << data->threadNum;
+			snprintf(line, sizeof(line), ",\"ts\":%.3f,\"dur\":%.3f}",
+					(event.start.load(std::memory_order_relaxed) - origin) * 1e-3, event.duration.load(std::memory_order_relaxed) * 1e-3);
+			file << line;
+			isFirst = false;
+		}
+	}
+	file << "\n]}\n";
+	return file.good();
+}
+
+bool CProfiler::ExportStats(const std::string& filename)
+{
+	std::ofstream file(filename, std::ios::out | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::lock_guard<spring::mutex> lock(profileMutex);
+	const int num = PROFILE_MAX_ZONES;  // including overflow
+	std::vector<uint64_t> buckets(PROFILE_BUCKETS);
+	char line[96];
+	bool isFirst = true;
+	file << "{\"zones\":{";
+	for (int z = 0; z < num; ++z) {
+		int64_t total;
+		int64_t max;
+		const uint64_t count = MergeZone(z, total, max, buckets);
+		if ((count == 0) || (zoneNames[z] == nullptr)) {
+			continue;
+		}
+		file << (isFirst ? "\n\"" : ",\n\"");
+		for (const char* name = zoneNames[z]; *name != '\0'; ++name) {
+			if ((*name == '"') || (*name == '\\')) {
+				file << '\\';
+			}
+			file << *name;
+		}
+		snprintf(line, sizeof(line), "\":{\"count\":%llu,\"total\":%lld,\"max\":%lld,\"buckets\":[",
+				(unsigned long long)count, (long long)total, (long long)max);
+		file << line;
+		bool isFirstBucket = true;
+		for (int b = 0; b < PROFILE_BUCKETS; ++b) {
+			if (buckets[b] == 0) {
+				continue;
+			}
+			snprintf(line, sizeof(line), "%s[%lld,%llu]", isFirstBucket ? "" : ",",
+					(long long)GetBucketValue(b), (unsigned long long)buckets[b]);
+			file << line;
+			isFirstBucket = false;
+		}
+		file << "]}";
+		isFirst = false;
+	}
+	file << "\n}}\n";
+	return file.good();
+}
+
+/*
+ * Sum of zone aggregates over all threads, profileMutex must be locked
+ */
+uint64_t CProfiler::MergeZone(int zoneId, int64_t& total, int64_t& max, std::vector<uint64_t>& buckets)
+{
+	uint64_t count = 0;
+	total = 0;
+	max = 0;
+	std::fill(buckets.begin(), buckets.end(), 0);
+	for (SThreadData* data : threadDatas) {
+		const SZoneStats& zone = data->zones[zoneId];
+		count += zone.count.load(std::memory_order_relaxed);
+		total += zone.total.load(std::memory_order_relaxed);
+		max = std::max(max, zone.max.load(std::memory_order_relaxed));
+		for (int b = 0; b < PROFILE_BUCKETS; ++b) {
+			buckets[b] += zone.buckets[b].load(std::memory_order_relaxed);
+		}
+	}
+	return count;
+}
+
+CProfiler::SThreadData* CProfiler::GetThreadData()
+{
+	static thread_local SThreadData* data = nullptr;
+	if (data == nullptr) {
+		data = new SThreadData();  // value-initialized: zeroes
+		std::lock_guard<spring::mutex> lock(profileMutex);
+		data->threadNum = threadDatas.size();
+		threadDatas.push_back(data);
+	}
+	return data;
+}
+
+/*
+ * Bucket of log2 scale with 4 linear sub-buckets: [4 * 2^(e-2) + sub * 2^(e-2), ...)
+ */
+int CProfiler::GetBucket(int64_t duration)
+{
+	if (duration < 4) {
+		return std::max<int64_t>(duration, 0);
+	}
+	int e = 63 - __builtin_clzll(duration);
+	const int bucket = 4 * (e - 1) + ((duration >> (e - 2)) & 3);
+	return std::min(bucket, PROFILE_BUCKETS - 1);
+}
+
+int64_t CProfiler::GetBucketValue(int bucket)
+{
+	if (bucket < 4) {
+		return bucket;
+	}
+	const int e = bucket / 4 + 1;
+	const int sub = bucket % 4;
+	return ((int64_t)(4 + sub) << (e - 2)) + ((int64_t)1 << (e - 2)) / 2;  // middle of the bucket
+}
+
+} // namespace circuit
@@ -0,0 +1,104 @@
+/*
+ * Profiler.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_PROFILER_H_
+#define SRC_CIRCUIT_UTIL_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define PROFILE_MAX_ZONES	128
+#define PROFILE_RING_SIZE	(1 << 14)  // latest events per thread, power of 2
+#define PROFILE_BUCKETS		160  // log2 histogram with 4 sub-buckets, up to ~18 min
+
+#define PROFILE_CONCAT_(a, b)	a##b
+#define PROFILE_CONCAT(a, b)	PROFILE_CONCAT_(a, b)
+/*
+ * Zone id registered once per call site (unique lambda type owns the static).
+ * Name must live until process exit (string literal, __PRETTY_FUNCTION__), evaluated at call site.
+ */
+#define PROFILE_ZONE_ID(name)																			\
+	[](const char* zoneName) { static const int zoneId = circuit::CProfiler::RegisterZone(zoneName); return zoneId; }(name)
+/*
+ * Always-on zone, single declaration
+ */
+#define PROFILE_ZONE(name)																				\
+	circuit::CProfiler::CScope PROFILE_CONCAT(profScope, __LINE__)(PROFILE_ZONE_ID(name))
+
+namespace circuit {
+
+/*
+ * Process-wide zone profiler, shared by all AIs and pool threads.
+ * Each thread owns a ring buffer of latest events and per-zone aggregates (count, total, max,
+ * log-histogram for percentiles). Writers never lock: single writer per buffer, relaxed atomics.
+ * Buffers live until process exit, Summary and ExportTrace read them at game end.
+ */
+class CProfiler {
+public:
+	using clock = std::chrono::steady_clock;
+
+	class CScope {
+	public:
+		explicit CScope(int zoneId) : zoneId(zoneId), start(Now()) {}
+		~CScope() { Record(zoneId, start, Now()); }
+	private:
+		int zoneId;
+		int64_t start;
+	};
+
+	static int RegisterZone(const char* name);
+	static void Record(int zoneId, int64_t start, int64_t end);
+	static int64_t Now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+	}
+
+	/*
+	 * Per-zone table: count, total, p50, p99, max
+	 */
+	static std::string Summary();
+	/*
+	 * Chrome trace JSON of the latest events (chrome://tracing, ui.perfetto.dev)
+	 */
+	static bool ExportTrace(const std::string& filename);
+	/*
+	 * JSON of full per-zone aggregates: count, total, max and non-empty histogram buckets, ns
+	 */
+	static bool ExportStats(const std::string& filename);
+
+private:
+	struct SEvent {
+		std::atomic<int> zoneId;
+		std::atomic<int64_t> start;
+		std::atomic<int64_t> duration;
+	};
+	struct SZoneStats {
+		std::atomic<uint64_t> count;
+		std::atomic<int64_t> total;
+		std::atomic<int64_t> max;
+		std::atomic<uint32_t> buckets[PROFILE_BUCKETS];
+	};
+	struct SThreadData {
+		int threadNum;
+		std::atomic<uint64_t> head;
+		SEvent events[PROFILE_RING_SIZE];
+		SZoneStats zones[PROFILE_MAX_ZONES];
+	};
+
+	static std::vector<SThreadData*> threadDatas;  // NOTE: live until process exit
+
+	static SThreadData* GetThreadData();
+	static uint64_t MergeZone(int zoneId, int64_t& total, int64_t& max, std::vector<uint64_t>& buckets);
+	static int GetBucket(int64_t duration);
+	static int64_t GetBucketValue(int bucket);
+};
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_PROFILER_H_
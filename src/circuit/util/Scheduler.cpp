@@ -6,37 +6,60 @@
  */
 
 #include "util/Scheduler.h"
+#include "util/Profiler.h"
 #include "util/Utils.h"
 
-namespace circuit {
+#include <algorithm>
 
-#define MAX_JOB_THREADS		4
+namespace circuit {
 
-CMultiQueue<CScheduler::WorkTask> CScheduler::workTasks;
-CMultiQueue<CScheduler::PathTask> CScheduler::pathTasks;
-spring::thread CScheduler::workerThread;
-std::vector<spring::thread> CScheduler::patherThreads;
-int CScheduler::maxPathThreads = 1;
+#define MAX_JOB_THREADS		16
+
+#define WHEEL_BITS		8
+#define WHEEL_SIZE		(1 << WHEEL_BITS)
+#define WHEEL_MASK		(WHEEL_SIZE - 1)
+#define WHEEL_LEVELS	3  // 2^24 frames, farther timers are clamped and cascade again
+#define READY_SLOT		(WHEEL_SIZE * WHEEL_LEVELS)
+
+std::vector<CScheduler::SJobQueue*> CScheduler::jobQueues;
+std::vector<spring::thread> CScheduler::poolThreads;
+CScheduler::SJobCounter CScheduler::jobCounters[static_cast<int>(CScheduler::JobType::_SIZE_)];
+spring::mutex CScheduler::poolMutex;
+spring::condition_variable_any CScheduler::poolCond;
+std::atomic<int> CScheduler::numQueued(0);
+std::atomic<unsigned int> CScheduler::pushCounter(0);
+int CScheduler::numThreads = 1;
 std::atomic<bool> CScheduler::workerRunning(false);
 unsigned int CScheduler::counterInstance = 0;
 
+static thread_local int poolThreadNum = -1;
+
 CScheduler::CScheduler()
 		: lastFrame(-1)
 		, isProcessing(false)
-		, isWorkProcess(false)
+		, numWorkProcess(0)
 		, numPathProcess(0)
+		, wheelFrame(-1)
+		, timerSeq(0)
+		, frameBudget(FRAME_BUDGET_US)
+		, drainStats({0, 0, 0})
 {
-	if (counterInstance == 0) {
-		int maxThreads = spring::thread::hardware_concurrency();
-		maxPathThreads = utils::clamp(maxThreads - 2, 1, MAX_JOB_THREADS);
-	}
+	slots.resize(READY_SLOT + 1, -1);
+
 	counterInstance++;
 	isRunning = true;
+	SetMaxThreads(JOB_THREADS);
 }
 
 CScheduler::~CScheduler()
 {
 	Release();
+
+	for (STimer& timer : timers) {
+		if (timer.task != nullptr) {
+			timer.task->timerHead = -1;  // task may outlive scheduler
+		}
+	}
 }
 
 void CScheduler::ProcessInit()
@@ -65,40 +88,65 @@ void CScheduler::Release()
 	counterInstance--;
 
 	std::weak_ptr<CScheduler>& scheduler = self;
-	workTasks.RemoveAllIf([&scheduler](WorkTask& item) -> bool {
-		return !scheduler.owner_before(item.scheduler) && !item.scheduler.owner_before(scheduler);
-	});
-	pathTasks.RemoveAllIf([&scheduler](PathTask& item) -> bool {
+	auto isOwner = [&scheduler](const PoolJob& item) -> bool {
 		return !scheduler.owner_before(item.scheduler) && !item.scheduler.owner_before(scheduler);
-	});
-
-	if (counterInstance == 0 && workerRunning.load()) {
-		workerRunning = false;
-		// At this point workTasks is empty. Push empty task in case worker stuck at Pop().
-		workTasks.Push({self, nullptr, nullptr});
-		if (workerThread.joinable()) {
-			workerThread.join();
+	};
+	for (SJobQueue* queue : jobQueues) {
+		std::lock_guard<spring::mutex> mlock(queue->mutex);
+		for (JobDeque& jobs : queue->jobs) {
+			auto it = jobs.begin();
+			while (it != jobs.end()) {
+				if (isOwner(*it)) {
+					jobCounters[static_cast<int>(it->type)].depth--;
+					numQueued--;
+					it = jobs.erase(it);
+				} else {
+					++it;
+				}
+			}
 		}
-		workTasks.Clear();
+	}
 
-		for (unsigned int i = 0; i < patherThreads.size(); ++i) {
-			pathTasks.Push({self, nullptr, nullptr, nullptr});
+	if (counterInstance == 0 && workerRunning.load()) {
+		{
+			std::lock_guard<spring::mutex> mlock(poolMutex);
+			workerRunning = false;
 		}
-		for (std::thread& t : patherThreads) {
+		poolCond.notify_all();
+		for (spring::thread& t : poolThreads) {
 			if (t.joinable()) {
 				t.join();
 			}
 		}
-		patherThreads.clear();
-		pathTasks.Clear();
+		poolThreads.clear();
+
+		for (SJobQueue* queue : jobQueues) {
+			delete queue;
+		}
+		jobQueues.clear();
+		numQueued = 0;
+		for (SJobCounter& counter : jobCounters) {
+			counter.depth = 0;
+		}
 	}
 
-	barrier.Wait([this]() { return !isWorkProcess && (numPathProcess == 0); });
+	barrier.Wait([this]() { return (numWorkProcess == 0) && (numPathProcess == 0); });
 
 	finishTasks.Clear();
 	pathedTasks.Clear();
 }
 
+void CScheduler::SetMaxThreads(int maxThreads)
+{
+	// NOTE: Number of threads must not change while any CScheduler is alive,
+	//       CPathFinder keeps one CMicroPather slot per thread.
+	if ((counterInstance != 1) || workerRunning.load()) {
+		return;
+	}
+	const int hwThreads = spring::thread::hardware_concurrency();
+	numThreads = utils::clamp(std::min(hwThreads - 1, (maxThreads > 0) ? maxThreads : MAX_JOB_THREADS), 1, MAX_JOB_THREADS);
+}
+
 void CScheduler::StartThreads()
 {
 	if (workerRunning.load()) {
@@ -106,68 +154,54 @@ void CScheduler::StartThreads()
 	}
 	workerRunning = true;
 
-	workerThread = spring::thread(&CScheduler::WorkerThread);
-
-	assert(patherThreads.empty());
-	for (int i = 0; i < maxPathThreads; ++i) {
-		std::thread t = spring::thread(&CScheduler::PatherThread, i);
-		patherThreads.push_back(std::move(t));
+	assert(poolThreads.empty() && jobQueues.empty());
+	for (int i = 0; i < numThreads; ++i) {
+		jobQueues.push_back(new SJobQueue);
+	}
+	for (int i = 0; i < numThreads; ++i) {
+		poolThreads.push_back(spring::thread(&CScheduler::PoolThread, i));
 	}
 }
 
 void CScheduler::RunTaskEvery(const std::shared_ptr<CGameTask>& task, int frameInterval, int frameOffset)
 {
-	if (frameOffset > 0) {
-		RunTaskAfter(std::make_shared<CGameTask>([this, task, frameInterval]() {
-			repeatTasks.push_back({task, frameInterval, lastFrame});
-		}), frameOffset);
-	} else {
-		repeatTasks.push_back({task, frameInterval, lastFrame});
-	}
+	AddTimer(task, lastFrame + std::max(frameOffset, 0) + frameInterval, std::max(frameInterval, 1));
 }
 
 void CScheduler::ProcessTasks(int frame)
 {
+	PROFILE_ZONE("CScheduler::ProcessTasks");
 	isProcessing = true;
 	lastFrame = frame;
-
-	// Process once tasks
-	std::list<OnceTask>::iterator ionce = onceTasks.begin();
-	while (ionce != onceTasks.end()) {
-		if (ionce->frame <= frame) {
-			ionce->task->Run();
-			ionce = onceTasks.erase(ionce);  // alternatively, onceTasks.erase(iter++);
-		} else {
-			++ionce;
+	AdvanceWheel(frame);
+
+	// Process once tasks, including ones added for this frame by once tasks
+	CollectDue(false);
+	while (!dueTimers.empty()) {
+		for (int index : dueTimers) {
+			timers[index].task->Run();
+			FreeTimer(index);
 		}
+		CollectDue(false);
 	}
 
 	// Process repeat tasks
-	for (auto& container : repeatTasks) {
-		if (frame - container.lastFrame >= container.frameInterval) {
-			container.task->Run();
-			container.lastFrame = frame;
-		}
+	CollectDue(true);
+	for (int index : dueTimers) {
+		STimer& timer = timers[index];
+		timer.frame = frame + timer.interval;
+		LinkTimer(index);
+		CGameTask* task = timer.task.get();  // NOTE: Run may reallocate timers, removal is deferred
+		task->Run();
 	}
 
 	// Process onComplete from parallel tasks
-	CMultiQueue<FinishTask>::ProcessFunction process = [](FinishTask& item) {
-		item.task->Run();
-	};
-	if (!finishTasks.PopAndProcess(process)) {  // one heavy
-		pathedTasks.PopAndProcessAll([](PathedTask& item) {  // many lite
-			std::shared_ptr<IPathQuery> query = item.query.lock();
-			if (query != nullptr) {
-				item.onComplete(query);
-			}
-		});
-	}
+	DrainFinished();
 
 	// Update task queues
 	if (!removeTasks.empty()) {
 		for (auto& task : removeTasks) {
-			onceTasks.remove({task, 0});
-			repeatTasks.remove({task, 0, 0});
+			RemoveTimers(task.get());
 		}
 		removeTasks.clear();
 	}
@@ -175,16 +209,97 @@ void CScheduler::ProcessTasks(int frame)
 	isProcessing = false;
 }
 
-void CScheduler::RunParallelTask(const std::shared_ptr<CGameTask>& task, const std::shared_ptr<CGameTask>& onComplete)
+/*
+ * One heavy task per frame as before, then path callbacks (unit commands),
+ * then other heavy tasks while budget lasts. Remainder waits for next frame.
+ */
+void CScheduler::DrainFinished()
+{
+	PROFILE_ZONE("CScheduler::DrainFinished");
+	const clock::time_point deadline = clock::now() + frameBudget;
+	auto isInBudget = [this, &deadline]() {
+		return (frameBudget.count() == 0) || (clock::now() < deadline);
+	};
+	decltype(finishTasks)::ProcessFunction process = [](FinishTask& item) {
+		item.task->Run();
+	};
+	decltype(pathedTasks)::ProcessFunction processPathed = [](PathedTask& item) {
+		std::shared_ptr<IPathQuery> query = item.query.lock();
+		if (query != nullptr) {
+			item.onComplete(query);
+		}
+	};
+
+	finishTasks.PopAndProcess(process);
+	while (isInBudget() && pathedTasks.PopAndProcess(processPathed));
+	while (isInBudget() && finishTasks.PopAndProcess(process));
+
+	drainStats.backlog = finishTasks.Size() + pathedTasks.Size();
+	drainStats.maxBacklog = std::max(drainStats.maxBacklog, drainStats.backlog);
+	if (drainStats.backlog > 0) {
+		++drainStats.deferredFrames;
+	}
+}
+
+void CScheduler::RunParallelTask(const std::shared_ptr<CGameTask>& task, const std::shared_ptr<CGameTask>& onComplete,
+								 Priority priority)
 {
 	StartThreads();
-	workTasks.Push({self, task, onComplete});
+	PushJob(PoolJob(self, task, onComplete), priority);
 }
 
-void CScheduler::RunPathTask(const std::shared_ptr<IPathQuery>& query, PathFunc&& task, PathedFunc&& onComplete)
+void CScheduler::RunPathTask(const std::shared_ptr<IPathQuery>& query, PathFunc&& task, PathedFunc&& onComplete,
+							 Priority priority)
 {
 	StartThreads();
-	pathTasks.Push({self, query, std::move(task), std::move(onComplete)});
+	PushJob(PoolJob(self, query, std::move(task), std::move(onComplete)), priority);
+}
+
+CScheduler::SJobStats CScheduler::GetJobStats(JobType type)
+{
+	const SJobCounter& counter = jobCounters[static_cast<int>(type)];
+	SJobStats stats;
+	stats.depth = std::max(counter.depth.load(), 0);
+	stats.count = counter.count.load();
+	stats.avgWaitMs = (stats.count > 0) ? counter.waitSumUs.load() / (1000.f * stats.count) : 0.f;
+	stats.maxWaitMs = counter.waitMaxUs.load() / 1000.f;
+	return stats;
+}
+
+void CScheduler::RunParallelFor(int count, std::function<void (int index)>&& func)
+{
+	if (count <= 0) {
+		return;
+	}
+	// NOTE: Jobs may start after return, shared state keeps them harmless
+	struct SParallelFor {
+		SParallelFor(int count, std::function<void (int index)>&& func)
+			: count(count), next(0), done(0), func(std::move(func)) {}
+		void Work() {
+			int index;
+			int numDone = 0;
+			while ((index = next++) < count) {
+				func(index);
+				++numDone;
+			}
+			if (numDone > 0) {
+				barrier.NotifyOne([this, numDone]() { done += numDone; });
+			}
+		}
+		const int count;
+		std::atomic<int> next;
+		int done;  // guarded by barrier
+		Barrier barrier;
+		std::function<void (int index)> func;
+	};
+	std::shared_ptr<SParallelFor> state = std::make_shared<SParallelFor>(count, std::move(func));
+
+	const int numJobs = std::min(numThreads, count - 1);
+	for (int i = 0; i < numJobs; ++i) {
+		RunParallelTask(MakeTask([state]() { state->Work(); }));
+	}
+	state->Work();  // caller takes chunks too, then sleeps until workers finish the rest
+	state->barrier.Wait([&state, count]() { return state->done == count; });
 }
 
 void CScheduler::RemoveTask(const std::shared_ptr<CGameTask>& task)
@@ -192,52 +307,242 @@ void CScheduler::RemoveTask(const std::shared_ptr<CGameTask>& task)
 	if (isProcessing) {
 		removeTasks.push_back(task);
 	} else {
-		onceTasks.remove({task, 0});
-		repeatTasks.remove({task, 0, 0});
+		RemoveTimers(task.get());
 	}
 }
 
-void CScheduler::WorkerThread()
+void CScheduler::AddTimer(const std::shared_ptr<CGameTask>& task, int frame, int interval)
 {
-	while (workerRunning.load()) {
-		WorkTask container = workTasks.Pop();
+	int index;
+	if (freeTimers.empty()) {
+		index = timers.size();
+		timers.emplace_back();
+	} else {
+		index = freeTimers.back();
+		freeTimers.pop_back();
+	}
+	STimer& timer = timers[index];
+	timer.task = task;
+	timer.frame = frame;
+	timer.interval = interval;
+	timer.seq = timerSeq++;
+
+	timer.prevSame = -1;
+	timer.nextSame = task->timerHead;
+	if (timer.nextSame >= 0) {
+		timers[timer.nextSame].prevSame = index;
+	}
+	task->timerHead = index;
 
-		std::shared_ptr<CScheduler> scheduler = container.scheduler.lock();
-		if (scheduler != nullptr) {
-			scheduler->barrier.NotifyOne([scheduler]() { scheduler->isWorkProcess = true; });
-			if (scheduler->isRunning) {
+	LinkTimer(index);
+}
 
-				container.task->Run();
-				if (container.onComplete != nullptr) {
-					scheduler->finishTasks.Push(container);
-				}
+void CScheduler::FreeTimer(int index)
+{
+	STimer& timer = timers[index];
+	if (timer.slot >= 0) {
+		UnlinkTimer(index);
+	}
+
+	if (timer.prevSame >= 0) {
+		timers[timer.prevSame].nextSame = timer.nextSame;
+	} else {
+		timer.task->timerHead = timer.nextSame;
+	}
+	if (timer.nextSame >= 0) {
+		timers[timer.nextSame].prevSame = timer.prevSame;
+	}
+
+	timer.task = nullptr;
+	freeTimers.push_back(index);
+}
+
+void CScheduler::RemoveTimers(CGameTask* task)
+{
+	while (task->timerHead >= 0) {
+		FreeTimer(task->timerHead);
+	}
+}
 
+void CScheduler::LinkTimer(int index)
+{
+	STimer& timer = timers[index];
+	timer.slot = GetSlot(timer.frame);
+	int& head = slots[timer.slot];
+	timer.prev = -1;
+	timer.next = head;
+	if (head >= 0) {
+		timers[head].prev = index;
+	}
+	head = index;
+}
+
+void CScheduler::UnlinkTimer(int index)
+{
+	STimer& timer = timers[index];
+	if (timer.prev >= 0) {
+		timers[timer.prev].next = timer.next;
+	} else {
+		slots[timer.slot] = timer.next;
+	}
+	if (timer.next >= 0) {
+		timers[timer.next].prev = timer.prev;
+	}
+	timer.slot = -1;
+}
+
+int CScheduler::GetSlot(int frame) const
+{
+	const int delta = frame - wheelFrame;
+	if (delta <= 0) {
+		return READY_SLOT;
+	}
+	if (delta < WHEEL_SIZE) {
+		return frame & WHEEL_MASK;
+	}
+	if (delta < (1 << (WHEEL_BITS * 2))) {
+		return WHEEL_SIZE + ((frame >> WHEEL_BITS) & WHEEL_MASK);
+	}
+	if (delta >= (1 << (WHEEL_BITS * 3))) {
+		frame = wheelFrame + (1 << (WHEEL_BITS * 3)) - 1;
+	}
+	return WHEEL_SIZE * 2 + ((frame >> (WHEEL_BITS * 2)) & WHEEL_MASK);
+}
+
+void CScheduler::AdvanceWheel(int frame)
+{
+	// Relink every timer of the slot relative to wheelFrame
+	auto cascade = [this](int slot) {
+		int index = slots[slot];
+		slots[slot] = -1;
+		while (index >= 0) {
+			const int next = timers[index].next;
+			LinkTimer(index);
+			index = next;
+		}
+	};
+
+	if (frame - wheelFrame > WHEEL_SIZE) {  // jump: relink all instead of visiting each frame
+		wheelFrame = frame;
+		for (int slot = 0; slot < READY_SLOT; ++slot) {
+			cascade(slot);
+		}
+		return;
+	}
+
+	while (wheelFrame < frame) {
+		++wheelFrame;
+		const int idx = wheelFrame & WHEEL_MASK;
+		if (idx == 0) {
+			if (((wheelFrame >> WHEEL_BITS) & WHEEL_MASK) == 0) {
+				cascade(WHEEL_SIZE * 2 + ((wheelFrame >> (WHEEL_BITS * 2)) & WHEEL_MASK));
 			}
-			scheduler->barrier.NotifyOne([scheduler]() { scheduler->isWorkProcess = false; });
+			cascade(WHEEL_SIZE + ((wheelFrame >> WHEEL_BITS) & WHEEL_MASK));
 		}
+		cascade(idx);  // due timers go into ready list
 	}
 }
 
-void CScheduler::PatherThread(int num)
+void CScheduler::CollectDue(bool isRepeat)
 {
-	while (workerRunning.load()) {
-		PathTask container = pathTasks.Pop();
+	dueTimers.clear();
+	int index = slots[READY_SLOT];
+	while (index >= 0) {
+		const int next = timers[index].next;
+		if ((timers[index].interval > 0) == isRepeat) {
+			UnlinkTimer(index);
+			dueTimers.push_back(index);
+		}
+		index = next;
+	}
+	std::sort(dueTimers.begin(), dueTimers.end(), [this](int a, int b) {
+		return timers[a].seq < timers[b].seq;
+	});
+}
 
-		std::shared_ptr<IPathQuery> query = container.query.lock();
-		if (query == nullptr) {
-			continue;
+void CScheduler::PushJob(PoolJob&& job, Priority priority)
+{
+	job.queueTime = clock::now();
+	jobCounters[static_cast<int>(job.type)].depth++;
+
+	// Pool threads keep own jobs local, external producers spread jobs round-robin
+	const int num = (poolThreadNum >= 0) ? poolThreadNum : (pushCounter++ % numThreads);
+	SJobQueue* queue = jobQueues[num];
+	{
+		std::lock_guard<spring::mutex> mlock(queue->mutex);
+		queue->jobs[static_cast<int>(priority)].push_back(std::move(job));
+	}
+
+	numQueued++;
+	{
+		// NOTE: empty critical section prevents lost wake-up between predicate check and wait
+		std::lock_guard<spring::mutex> mlock(poolMutex);
+	}
+	poolCond.notify_one();
+}
+
+bool CScheduler::PopJob(int num, PoolJob& job)
+{
+	// Own deque first, then steal from others. Priority outweighs locality.
+	for (int p = 0; p < static_cast<int>(Priority::_SIZE_); ++p) {
+		for (int i = 0; i < numThreads; ++i) {
+			SJobQueue* queue = jobQueues[(num + i) % numThreads];
+			std::lock_guard<spring::mutex> mlock(queue->mutex);
+			JobDeque& jobs = queue->jobs[p];
+			if (!jobs.empty()) {
+				job = std::move(jobs.front());
+				jobs.pop_front();
+				numQueued--;
+				return true;
+			}
 		}
-		std::shared_ptr<CScheduler> scheduler = container.scheduler.lock();
-		if (scheduler == nullptr) {
-			continue;
+	}
+	return false;
+}
+
+void CScheduler::ExecuteJob(PoolJob& job, int num)
+{
+	SJobCounter& counter = jobCounters[static_cast<int>(job.type)];
+	counter.depth--;
+	counter.count++;
+	const long long waitUs = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - job.queueTime).count();
+	counter.waitSumUs += waitUs;
+	long long prevMax = counter.waitMaxUs.load();
+	while ((prevMax < waitUs) && !counter.waitMaxUs.compare_exchange_weak(prevMax, waitUs));
+
+	std::shared_ptr<CScheduler> scheduler = job.scheduler.lock();
+	if (scheduler == nullptr) {
+		return;
+	}
+
+	if (job.type == JobType::WORK) {
+
+		scheduler->barrier.NotifyOne([scheduler]() { scheduler->numWorkProcess++; });
+		if (scheduler->isRunning) {
+
+			PROFILE_ZONE("CScheduler::WorkJob");
+			job.task->Run();
+			if (job.onComplete != nullptr) {
+				scheduler->finishTasks.Push(job.onComplete);
+			}
+
+		}
+		scheduler->barrier.NotifyOne([scheduler]() { scheduler->numWorkProcess--; });
+
+	} else {
+
+		std::shared_ptr<IPathQuery> query = job.query.lock();
+		if (query == nullptr) {
+			return;
 		}
 
 		scheduler->barrier.NotifyOne([scheduler]() { scheduler->numPathProcess++; });
 		if (scheduler->isRunning) {
 
-			container.task(query, num);
-			if (container.onComplete != nullptr) {
-				scheduler->pathedTasks.Push(container);
+			PROFILE_ZONE("CScheduler::PathJob");
+			job.pathTask(query, num);
+			if (job.onPathed != nullptr) {
+				scheduler->pathedTasks.Push(PathedTask(job));
 			}
 
 		}
@@ -245,4 +550,20 @@ void CScheduler::PatherThread(int num)
 	}
 }
 
+void CScheduler::PoolThread(int num)
+{
+	poolThreadNum = num;
+	while (workerRunning.load()) {
+		PoolJob job;
+		if (PopJob(num, job)) {
+			ExecuteJob(job, num);
+			continue;
+		}
+
+		std::unique_lock<spring::mutex> mlock(poolMutex);
+		poolCond.wait(mlock, []() { return (numQueued.load() > 0) || !workerRunning.load(); });
+	}
+	CTaskPool::FlushThread();
+}
+
 } // namespace circuit
@@ -16,7 +16,11 @@
 
 #include <functional>
 #include <memory>
-#include <list>
+#include <deque>
+#include <chrono>
+
+#define FRAME_BUDGET_US		4000  // default of quota.frame_budget
+#define JOB_THREADS			4  // default of quota.job_threads
 
 namespace circuit {
 
@@ -57,21 +61,37 @@ private:
 	void StartThreads();
 
 public:
-	using PathFunc = std::function<void (const std::shared_ptr<IPathQuery>& query, int threadNum)>;
-	using PathedFunc = std::function<void (const std::shared_ptr<IPathQuery>& query)>;
+	using PathFunc = CTaskFunc<void (const std::shared_ptr<IPathQuery>& query, int threadNum)>;
+	using PathedFunc = CTaskFunc<void (const std::shared_ptr<IPathQuery>& query)>;
+
+	enum class JobType: int {WORK = 0, PATH, _SIZE_};
+	enum class Priority: int {HIGH = 0, NORMAL, LOW, _SIZE_};  // order of extraction
+
+	struct SJobStats {
+		int depth;  // jobs queued but not started
+		unsigned int count;  // jobs started since launch
+		float avgWaitMs;
+		float maxWaitMs;
+	};
+
+	struct SDrainStats {
+		int backlog;  // finished jobs left for next frame
+		int maxBacklog;
+		unsigned int deferredFrames;  // frames that ran out of budget
+	};
 
 	/*
 	 * Add task at specified frame, or execute immediately at next frame
 	 */
 	void RunTaskAt(const std::shared_ptr<CGameTask>& task, int frame = 0) {
-		onceTasks.push_back({task, frame});
+		AddTimer(task, frame, 0);
 	}
 
 	/*
 	 * Add task at frame relative to current frame
 	 */
 	void RunTaskAfter(const std::shared_ptr<CGameTask>& task, int frame = 0) {
-		onceTasks.push_back({task, lastFrame + frame});
+		AddTimer(task, lastFrame + frame, 0);
 	}
 
 	/*
@@ -87,12 +107,20 @@ public:
 	/*
 	 * Run concurrent task, finalize on success at main thread
 	 */
-	void RunParallelTask(const std::shared_ptr<CGameTask>& task, const std::shared_ptr<CGameTask>& onComplete = nullptr);
+	void RunParallelTask(const std::shared_ptr<CGameTask>& task, const std::shared_ptr<CGameTask>& onComplete = nullptr,
+						 Priority priority = Priority::HIGH);
 
 	/*
 	 * Run concurrent pathfinder, finalize on complete at main thread
 	 */
-	void RunPathTask(const std::shared_ptr<IPathQuery>& query, PathFunc&& task, PathedFunc&& onComplete = nullptr);
+	void RunPathTask(const std::shared_ptr<IPathQuery>& query, PathFunc&& task, PathedFunc&& onComplete = nullptr,
+					 Priority priority = Priority::NORMAL);
+
+	/*
+	 * Blocking: run func(index) for index in [0, count) on pool threads and the calling thread.
+	 * NOTE: func must be thread-safe, no engine callbacks.
+	 */
+	void RunParallelFor(int count, std::function<void (int index)>&& func);
 
 	/*
 	 * Remove scheduled task from queue
@@ -113,14 +141,33 @@ public:
 		releaseTasks.push_back(task);
 	}
 
-	int GetMaxPathThreads() const { return maxPathThreads; }
+	/*
+	 * Number of pool threads, threadNum of PathFunc is in [0, GetMaxPathThreads())
+	 */
+	int GetMaxPathThreads() const { return numThreads; }
+	/*
+	 * Pool size limit, 0 - by hardware only. Takes effect only before the pool starts,
+	 * for the first CScheduler of the process.
+	 */
+	void SetMaxThreads(int maxThreads);
+
+	/*
+	 * Queue depth and wait time of shared job pool
+	 */
+	static SJobStats GetJobStats(JobType type);
+
+	/*
+	 * Main thread time per frame for onComplete of finished jobs, 0 - unlimited
+	 */
+	void SetFrameBudget(int budgetUs) { frameBudget = std::chrono::microseconds(std::max(budgetUs, 0)); }
+	const SDrainStats& GetDrainStats() const { return drainStats; }
 
 private:
 	std::weak_ptr<CScheduler> self;
 	int lastFrame;
 	bool isProcessing;  // regular CGameTask
 
-	bool isWorkProcess;  // parallel CGameTask
+	int numWorkProcess;  // parallel CGameTask
 	int numPathProcess;  // parallel PathFunc
 	Barrier barrier;
 	std::atomic<bool> isRunning;  // parallel
@@ -132,72 +179,123 @@ private:
 			return task == other.task;
 		}
 	};
-	struct OnceTask: public BaseContainer {
-		OnceTask(const std::shared_ptr<CGameTask>& task, int frame)
-			: BaseContainer(task), frame(frame) {}
-		int frame;
-	};
-	std::list<OnceTask> onceTasks;
 
-	struct RepeatTask: public BaseContainer {
-		RepeatTask(const std::shared_ptr<CGameTask>& task, int frameInterval, int lastFrame)
-			: BaseContainer(task), frameInterval(frameInterval), lastFrame(lastFrame) {}
-		int frameInterval;
-		int lastFrame;
+	/*
+	 * Hierarchical timing wheel of once and repeat tasks.
+	 * Level L slot covers 2^(WHEEL_BITS * L) frames, slots of upper level cascade down
+	 * when lower level wraps. Only due slot is visited per frame, due timers go into ready list.
+	 * Timers are intrusive lists over node pool, insert/cancel is O(1).
+	 * Timers of the same task are listed from CGameTask::timerHead.
+	 */
+	struct STimer {
+		std::shared_ptr<CGameTask> task;
+		int frame;  // due frame
+		int interval;  // 0 for once task
+		unsigned int seq;  // order of registration, order of execution within frame
+		int slot;
+		int prev, next;  // timers of slot
+		int prevSame, nextSame;  // timers of the same task
 	};
-	std::list<RepeatTask> repeatTasks;
+	std::vector<STimer, STaskAllocator<STimer>> timers;
+	std::vector<int, STaskAllocator<int>> freeTimers;
+	std::vector<int> slots;  // head timer per slot, last slot is ready list
+	std::vector<int, STaskAllocator<int>> dueTimers;
+	int wheelFrame;  // all slots up to this frame are visited
+	unsigned int timerSeq;
+
+	void AddTimer(const std::shared_ptr<CGameTask>& task, int frame, int interval);
+	void FreeTimer(int index);
+	void RemoveTimers(CGameTask* task);
+	void LinkTimer(int index);
+	void UnlinkTimer(int index);
+	int GetSlot(int frame) const;
+	void AdvanceWheel(int frame);
+	void CollectDue(bool isRepeat);
 
 	std::vector<std::shared_ptr<CGameTask>> removeTasks;
 
-	struct WorkTask: public BaseContainer {
-		WorkTask(const std::weak_ptr<CScheduler>& scheduler, const std::shared_ptr<CGameTask>& task,
-				 const std::shared_ptr<CGameTask>& onComplete)
-			: BaseContainer(task), onComplete(onComplete), scheduler(scheduler) {}
-		std::shared_ptr<CGameTask> onComplete;
+	using clock = std::chrono::steady_clock;
+
+	/*
+	 * Unit of the shared pool: either parallel CGameTask or PathFunc
+	 */
+	struct PoolJob {
+		PoolJob() : type(JobType::WORK) {}
+		PoolJob(const std::weak_ptr<CScheduler>& scheduler, const std::shared_ptr<CGameTask>& task,
+				const std::shared_ptr<CGameTask>& onComplete)
+			: scheduler(scheduler), type(JobType::WORK), task(task), onComplete(onComplete) {}
+		PoolJob(const std::weak_ptr<CScheduler>& scheduler, const std::shared_ptr<IPathQuery>& query,
+				PathFunc&& pathTask, PathedFunc&& onPathed)
+			: scheduler(scheduler), type(JobType::PATH), query(query)
+			, pathTask(std::move(pathTask)), onPathed(std::move(onPathed)) {}
 		std::weak_ptr<CScheduler> scheduler;
+		JobType type;
+		clock::time_point queueTime;
+		// JobType::WORK
+		std::shared_ptr<CGameTask> task;
+		std::shared_ptr<CGameTask> onComplete;
+		// JobType::PATH
+		std::weak_ptr<IPathQuery> query;
+		PathFunc pathTask;
+		PathedFunc onPathed;
 	};
-	static CMultiQueue<WorkTask> workTasks;
 
 	struct FinishTask: public BaseContainer {
 		FinishTask(const std::shared_ptr<CGameTask>& task)
 			: BaseContainer(task) {}
-		FinishTask(const WorkTask& workTask)
-			: BaseContainer(workTask.onComplete) {}
 	};
-	CMultiQueue<FinishTask> finishTasks;  // onComplete
-
-	struct PathTask {
-		PathTask(const std::weak_ptr<CScheduler>& scheduler, const std::shared_ptr<IPathQuery>& query,
-				PathFunc&& task, PathedFunc&& onComplete)
-			: scheduler(scheduler), query(query), task(std::move(task)), onComplete(std::move(onComplete)) {}
-		std::weak_ptr<CScheduler> scheduler;
-		std::weak_ptr<IPathQuery> query;
-		PathFunc task;
-		PathedFunc onComplete;
-	};
-	static CMultiQueue<PathTask> pathTasks;
+	CMultiQueue<FinishTask, STaskAllocator<FinishTask>> finishTasks;  // onComplete
 
 	struct PathedTask {
 		PathedTask(PathedFunc&& func)
 			: onComplete(std::move(func)) {}
-		PathedTask(const PathTask& pathTask)
-			: query(pathTask.query), onComplete(std::move(pathTask.onComplete)) {}
+		PathedTask(PoolJob& job)
+			: query(job.query), onComplete(std::move(job.onPathed)) {}
 		std::weak_ptr<IPathQuery> query;
 		PathedFunc onComplete;
 	};
-	CMultiQueue<PathedTask> pathedTasks;  // onComplete
+	CMultiQueue<PathedTask, STaskAllocator<PathedTask>> pathedTasks;  // onComplete
+
+	std::chrono::microseconds frameBudget;
+	SDrainStats drainStats;
+	void DrainFinished();
 
 	std::vector<std::shared_ptr<CGameTask>> initTasks;
 	std::vector<std::shared_ptr<CGameTask>> releaseTasks;
 
-	static spring::thread workerThread;
-	static std::vector<spring::thread> patherThreads;
-	static int maxPathThreads;
+	/*
+	 * Per-thread deque of the work-stealing pool.
+	 * Owner and thieves both extract from the front to keep jobs roughly FIFO,
+	 * higher priority deque is drained first.
+	 */
+	using JobDeque = std::deque<PoolJob, STaskAllocator<PoolJob>>;  // chunks recycle through CTaskPool
+	struct SJobQueue {
+		spring::mutex mutex;
+		JobDeque jobs[static_cast<int>(Priority::_SIZE_)];
+	};
+
+	struct SJobCounter {
+		std::atomic<int> depth;
+		std::atomic<unsigned int> count;
+		std::atomic<long long> waitSumUs;
+		std::atomic<long long> waitMaxUs;
+	};
+
+	static std::vector<SJobQueue*> jobQueues;
+	static std::vector<spring::thread> poolThreads;
+	static SJobCounter jobCounters[static_cast<int>(JobType::_SIZE_)];
+	static spring::mutex poolMutex;
+	static spring::condition_variable_any poolCond;
+	static std::atomic<int> numQueued;
+	static std::atomic<unsigned int> pushCounter;
+	static int numThreads;
 	static std::atomic<bool> workerRunning;
 	static unsigned int counterInstance;
 
-	static void WorkerThread();
-	static void PatherThread(int num);
+	void PushJob(PoolJob&& job, Priority priority);
+	static bool PopJob(int num, PoolJob& job);
+	static void ExecuteJob(PoolJob& job, int num);
+	static void PoolThread(int num);
 };
 
 } // namespace circuit
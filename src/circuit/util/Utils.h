@@ -10,6 +10,7 @@
 
 #include "util/Defines.h"
 #include "util/Point.h"
+#include "util/Profiler.h"
 
 #include "System/StringUtil.h"
 #include "System/Threading/SpringThreading.h"
@@ -208,10 +209,23 @@ template<typename T> static inline std::istream& binary_read(std::istream& strea
 		clock::time_point t0;
 		int thr;
 	};
-	#define SCOPED_TIME(x, y) utils::CScopedTime<std::chrono::milliseconds> st(x, y, 10)
+	// Profiler zone and slow-call log of the same scope
+	template<typename units>
+	class CScopedZoneTime {
+	public:
+		CScopedZoneTime(int zoneId, circuit::CCircuitAI* ai, const std::string& msg, int t)
+			: zone(zoneId), time(ai, msg, t)
+		{}
+	private:
+		circuit::CProfiler::CScope zone;
+		CScopedTime<units> time;
+	};
+	// NOTE: y is also PROFILE_ZONE name, must be static; SCOPED_TIME_NT logs only
+	#define SCOPED_TIME(x, y) utils::CScopedZoneTime<std::chrono::milliseconds> st(PROFILE_ZONE_ID(y), x, y, 10)
 	#define SCOPED_TIME_NT(n, x, y, t) utils::CScopedTime<std::chrono::milliseconds> n(x, y, t)
 #else
-	#define SCOPED_TIME(x, y)
+	#define SCOPED_TIME(x, y) PROFILE_ZONE(y)
+	#define SCOPED_TIME_NT(n, x, y, t)
 #endif
 
 } // namespace utils
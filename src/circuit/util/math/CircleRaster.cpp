@@ -0,0 +1,154 @@
+/*
+ * CircleRaster.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#include "util/math/CircleRaster.h"
+
+#include "System/Threading/SpringThreading.h"
+
+#include <atomic>
+#include <cmath>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace circuit {
+
+#define MAX_CACHED_RADIUS	512
+
+static std::atomic<CCircleRaster::SCircle*> circles[MAX_CACHED_RADIUS + 1];
+static spring::mutex circleMutex;
+
+static inline int isqrt(int v)
+{
+	int r = (int)std::sqrt((float)v);
+	while ((r + 1) * (r + 1) <= v) ++r;
+	while (r * r > v) --r;
+	return r;
+}
+
+const CCircleRaster::SCircle& CCircleRaster::GetCircle(int radius)
+{
+	if (radius > MAX_CACHED_RADIUS) {
+		// NOTE: Larger than any map in sector units, keep the last one per thread
+		static thread_local SCircle large;
+		if (large.radius != radius) {
+			BuildCircle(large, radius);
+		}
+		return large;
+	}
+
+	SCircle* circle = circles[radius].load(std::memory_order_acquire);
+	if (circle == nullptr) {
+		std::lock_guard<spring::mutex> lock(circleMutex);
+		circle = circles[radius].load(std::memory_order_relaxed);
+		if (circle == nullptr) {
+			circle = new SCircle;  // NOTE: lives until process exit, shared by all AIs
+			BuildCircle(*circle, radius);
+			circles[radius].store(circle, std::memory_order_release);
+		}
+	}
+	return *circle;
+}
+
+int CCircleRaster::RowExtent(int R, int rc, int dz)
+{
+	const int v = rc * rc - dz * dz;
+	return (v < 0) ? -1 : std::min(R - 1, isqrt(v));
+}
+
+void CCircleRaster::BuildCircle(SCircle& circle, int radius)
+{
+	circle.radius = radius;
+	circle.extent.resize(radius);
+	circle.offset.resize(radius);
+	circle.dist.clear();
+	const float invRadius = 1.f / radius;
+	for (int dz = 0; dz < radius; ++dz) {
+		const int ext = RowExtent(radius, radius, dz);
+		circle.extent[dz] = ext;
+		circle.offset[dz] = circle.dist.size();
+		for (int dx = -ext; dx <= ext; ++dx) {
+			circle.dist.push_back(sqrtf(dx * dx + dz * dz) * invRadius);
+		}
+	}
+}
+
+void CCircleRaster::AddSpan(float* dst, const float* dist, int n, float a, float b)
+{
+	int i = 0;
+#if defined(__AVX2__)
+	const __m256 va = _mm256_set1_ps(a);
+	const __m256 vb = _mm256_set1_ps(b);
+	for (; i + 8 <= n; i += 8) {
+		__m256 v = _mm256_add_ps(va, _mm256_mul_ps(vb, _mm256_loadu_ps(dist + i)));
+		_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), v));
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128 sa = _mm_set1_ps(a);
+	const __m128 sb = _mm_set1_ps(b);
+	for (; i + 4 <= n; i += 4) {
+		__m128 v = _mm_add_ps(sa, _mm_mul_ps(sb, _mm_loadu_ps(dist + i)));
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), v));
+	}
+#endif
+	for (; i < n; ++i) {
+		dst[i] += a + b * dist[i];
+	}
+}
+
+void CCircleRaster::AddSpanClamp(float* dst, const float* dist, int n, float a, float b, float low)
+{
+	int i = 0;
+#if defined(__AVX2__)
+	const __m256 va = _mm256_set1_ps(a);
+	const __m256 vb = _mm256_set1_ps(b);
+	const __m256 vl = _mm256_set1_ps(low);
+	for (; i + 8 <= n; i += 8) {
+		__m256 v = _mm256_add_ps(va, _mm256_mul_ps(vb, _mm256_loadu_ps(dist + i)));
+		v = _mm256_add_ps(_mm256_loadu_ps(dst + i), v);
+		_mm256_storeu_ps(dst + i, _mm256_max_ps(v, vl));
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128 sa = _mm_set1_ps(a);
+	const __m128 sb = _mm_set1_ps(b);
+	const __m128 sl = _mm_set1_ps(low);
+	for (; i + 4 <= n; i += 4) {
+		__m128 v = _mm_add_ps(sa, _mm_mul_ps(sb, _mm_loadu_ps(dist + i)));
+		v = _mm_add_ps(_mm_loadu_ps(dst + i), v);
+		_mm_storeu_ps(dst + i, _mm_max_ps(v, sl));
+	}
+#endif
+	for (; i < n; ++i) {
+		dst[i] = std::max(dst[i] + (a + b * dist[i]), low);
+	}
+}
+
+void CCircleRaster::AddConstClamp(float* dst, int n, float a, float low)
+{
+	int i = 0;
+#if defined(__AVX2__)
+	const __m256 va = _mm256_set1_ps(a);
+	const __m256 vl = _mm256_set1_ps(low);
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_ps(dst + i, _mm256_max_ps(_mm256_add_ps(_mm256_loadu_ps(dst + i), va), vl));
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128 sa = _mm_set1_ps(a);
+	const __m128 sl = _mm_set1_ps(low);
+	for (; i + 4 <= n; i += 4) {
+		_mm_storeu_ps(dst + i, _mm_max_ps(_mm_add_ps(_mm_loadu_ps(dst + i), sa), sl));
+	}
+#endif
+	for (; i < n; ++i) {
+		dst[i] = std::max(dst[i] + a, low);
+	}
+}
+
+} // namespace circuit
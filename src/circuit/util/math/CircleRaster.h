@@ -0,0 +1,85 @@
+/*
+ * CircleRaster.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: rlcevg
+ */
+
+#ifndef SRC_CIRCUIT_UTIL_MATH_CIRCLERASTER_H_
+#define SRC_CIRCUIT_UTIL_MATH_CIRCLERASTER_H_
+
+#include <vector>
+#include <algorithm>
+
+namespace circuit {
+
+/*
+ * Row-span rasteriser of circles on a cell grid (threat, influence).
+ * Circle of radius R covers cells with |dx| < R, |dz| < R and dx^2 + dz^2 <= R^2.
+ * Each row is a contiguous run, its x-extent is found analytically
+ * and gradient is applied from a per-radius falloff table.
+ */
+class CCircleRaster {
+public:
+	/*
+	 * Falloff table: for each row dz in (-R, R) normalized distance sqrt(dx^2 + dz^2) / R,
+	 * dx runs over [-extent, extent].
+	 */
+	struct SCircle {
+		int radius;
+		std::vector<int> extent;  // [|dz|] max |dx|
+		std::vector<int> offset;  // [|dz|] start of the row in dist
+		std::vector<float> dist;
+		const float* GetRow(int dz) const { return &dist[offset[dz]]; }  // dz >= 0
+	};
+
+	/*
+	 * Thread-safe, tables are built once on demand
+	 */
+	static const SCircle& GetCircle(int radius);
+
+	/*
+	 * Max |dx| of circle with radius rc at row dz inside the box of radius R, -1 if row is empty
+	 */
+	static int RowExtent(int R, int rc, int dz);
+
+	/*
+	 * Visit clipped rows: func(z, beginX, endX, const float* dist), dist corresponds to beginX
+	 */
+	template<typename F>
+	static void ForEachRow(int posx, int posz, int radius, int width, int height, F&& func);
+
+	// dst[i] = dst[i] + a + b * dist[i]
+	static void AddSpan(float* dst, const float* dist, int n, float a, float b);
+	// dst[i] = max(dst[i] + a + b * dist[i], low)
+	static void AddSpanClamp(float* dst, const float* dist, int n, float a, float b, float low);
+	// dst[i] = max(dst[i] + a, low)
+	static void AddConstClamp(float* dst, int n, float a, float low);
+
+private:
+	static void BuildCircle(SCircle& circle, int radius);
+};
+
+template<typename F>
+void CCircleRaster::ForEachRow(int posx, int posz, int radius, int width, int height, F&& func)
+{
+	if (radius <= 0) {
+		return;
+	}
+	const SCircle& circle = GetCircle(radius);
+	const int beginZ = std::max(posz - radius + 1,      0);
+	const int endZ   = std::min(posz + radius    , height);
+	for (int z = beginZ; z < endZ; ++z) {
+		const int dz = std::abs(z - posz);
+		const int ext = circle.extent[dz];
+		const int beginX = std::max(posx - ext,         0);
+		const int endX   = std::min(posx + ext + 1, width);
+		if (beginX < endX) {
+			func(z, beginX, endX, circle.GetRow(dz) + (beginX - (posx - ext)));
+		}
+	}
+}
+
+} // namespace circuit
+
+#endif // SRC_CIRCUIT_UTIL_MATH_CIRCLERASTER_H_
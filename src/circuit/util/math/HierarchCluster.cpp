@@ -9,6 +9,8 @@
 #include "util/math/RagMatrix.h"
 #include "util/Utils.h"
 
+#include <limits>
+
 namespace circuit {
 
 using namespace springai;
@@ -23,49 +25,78 @@ CHierarchCluster::~CHierarchCluster()
 
 const CHierarchCluster::Clusters& CHierarchCluster::Clusterize(CRagMatrix& distmatrix, float maxDistance)
 {
+	/*
+	 * Complete-linkage by nearest-neighbour chain, O(n^2).
+	 * Complete linkage is reducible: merge never brings a cluster closer to others,
+	 * hence reciprocal nearest neighbours of the chain can be merged right away,
+	 * and a cluster without neighbours within maxDistance is final.
+	 */
 	int nrows = distmatrix.GetNrows();
+	auto dist = [&distmatrix](int i, int j) -> float& {
+		return (i > j) ? distmatrix(i, j) : distmatrix(j, i);
+	};
 
 	// Initialize cluster-element list
 	iclusters.clear();
-	iclusters.reserve(nrows);
+	std::vector<std::vector<int>> members(nrows);
+	std::vector<int> active;  // unordered
+	std::vector<int> activePos(nrows);
+	active.reserve(nrows);
 	for (int i = 0; i < nrows; i++) {
-		std::vector<int> cluster;
-		cluster.push_back(i);
-		iclusters.push_back(cluster);
+		members[i].push_back(i);
+		activePos[i] = i;
+		active.push_back(i);
 	}
+	auto deactivate = [&active, &activePos](int i) {
+		const int last = active.back();
+		active[activePos[i]] = last;
+		activePos[last] = activePos[i];
+		active.pop_back();
+	};
 
-	for (int n = nrows; n > 1; n--) {
-		// Find pair
-		int is = 1;
-		int js = 0;
-		if (distmatrix.FindClosestPair(n, is, js) > maxDistance) {
-			break;
+	std::vector<int> chain;
+	chain.reserve(nrows);
+	while (!active.empty()) {
+		if (chain.empty()) {
+			chain.push_back(active.front());
 		}
 
-		// Fix the distances
-		for (int j = 0; j < js; j++) {
-			distmatrix(js, j) = std::max(distmatrix(is, j), distmatrix(js, j));
-		}
-		for (int j = js + 1; j < is; j++) {
-			distmatrix(j, js) = std::max(distmatrix(is, j), distmatrix(j, js));
-		}
-		for (int j = is + 1; j < n; j++) {
-			distmatrix(j, js) = std::max(distmatrix(j, is), distmatrix(j, js));
+		// Nearest neighbour of the chain's tip, previous element wins ties to avoid cycles
+		const int a = chain.back();
+		const int prev = (chain.size() > 1) ? chain[chain.size() - 2] : -1;
+		int c = prev;
+		float minDist = (prev >= 0) ? dist(a, prev) : std::numeric_limits<float>::max();
+		for (int k : active) {
+			if ((k != a) && (dist(a, k) < minDist)) {
+				minDist = dist(a, k);
+				c = k;
+			}
 		}
 
-		for (int j = 0; j < is; j++) {
-			distmatrix(is, j) = distmatrix(n - 1, j);
+		if ((c < 0) || (minDist > maxDistance)) {
+			iclusters.push_back(std::move(members[a]));
+			deactivate(a);
+			chain.pop_back();
+			continue;
 		}
-		for (int j = is + 1; j < n - 1; j++) {
-			distmatrix(j, is) = distmatrix(n - 1, j);
+
+		if (c != prev) {
+			chain.push_back(c);
+			continue;
 		}
 
-		// Merge clusters
-		std::vector<int>& cluster = iclusters[js];
-		cluster.reserve(cluster.size() + iclusters[is].size());  // preallocate memory
-		cluster.insert(cluster.end(), iclusters[is].begin(), iclusters[is].end());
-		iclusters[is] = iclusters[n - 1];
-		iclusters.pop_back();
+		// Merge reciprocal nearest neighbours into a, fix the distances
+		chain.pop_back();
+		chain.pop_back();
+		deactivate(c);
+		for (int k : active) {
+			if (k != a) {
+				dist(a, k) = std::max(dist(a, k), dist(c, k));
+			}
+		}
+		std::vector<int>& cluster = members[a];
+		cluster.insert(cluster.end(), members[c].begin(), members[c].end());
+		members[c].clear();
 	}
 
 	return iclusters;
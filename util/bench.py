@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Benchmark of AI frame times over spring-headless runs.
+# Every run replays head.script with "profile_trace": true in behaviour.json and reads zone histograms
+# exported by AI on game end (CProfiler::ExportStats, <writable datadir>/profile/<map>_stats.json).
+# With --fixtures saved stats files are read instead and the engine is not needed, e.g.
+#   bench.py --fixtures old/*_stats.json --save base.json
+#   bench.py --fixtures new/*_stats.json --baseline base.json
+# Histograms hold every call of a zone, they are merged over runs and percentiles are taken from them.
+# With --baseline zones slower than baseline p99 by more than --threshold are reported.
+
+from subprocess import Popen, PIPE
+import argparse
+import json
+import os
+import shutil
+import sys
+
+
+def percentile(zone, p):
+	# Same rank as CProfiler::Summary, value is the middle of the bucket
+	rank = max(1, int(zone["count"] * p))
+	total = 0
+	for value, num in zone["buckets"]:
+		total += num
+		if total >= rank:
+			return value / 1000.0
+	return zone["max"] / 1000.0
+
+
+def read_stats(filename):
+	with open(filename) as f:
+		return json.load(f)["zones"]
+
+
+def merge(zones, run):
+	for name, z in run.items():
+		m = zones.setdefault(name, {"count": 0, "total": 0, "max": 0, "buckets": {}})
+		m["count"] += z["count"]
+		m["total"] += z["total"]
+		m["max"] = max(m["max"], z["max"])
+		for value, num in z["buckets"]:
+			m["buckets"][value] = m["buckets"].get(value, 0) + num
+
+
+def summarize(zones):
+	stats = {}
+	for name, z in zones.items():
+		zone = dict(z, buckets=sorted(z["buckets"].items()))
+		stats[name] = {
+			"count": z["count"],
+			"p50": percentile(zone, 0.5),
+			"p99": percentile(zone, 0.99),
+			"max": z["max"] / 1000.0,
+		}
+	return stats
+
+
+def run_engine(args, zones):
+	succeeded = 0
+	for i in range(args.runs):
+		print ("---------- BENCH RUN {:02d} ----------".format(i))
+		if os.path.exists(args.stats):
+			os.remove(args.stats)
+		process = Popen([args.engine, args.script], stdout=PIPE)
+		process.communicate()
+		exit_code = process.wait()
+		if exit_code != 0 or not os.path.exists(args.stats):
+			if os.path.exists("./infolog.txt"):
+				shutil.copy2("./infolog.txt", "./infolog_bench_{0:02d}.txt".format(i))
+			print ("run failed: {0}".format(exit_code))
+			continue
+		merge(zones, read_stats(args.stats))
+		succeeded += 1
+	return succeeded
+
+
+def read_fixtures(args, zones):
+	succeeded = 0
+	for filename in args.fixtures:
+		try:
+			run = read_stats(filename)
+		except (IOError, ValueError, KeyError) as e:
+			print ("fixture failed: {0}: {1}".format(filename, e))
+			continue
+		merge(zones, run)
+		succeeded += 1
+	return succeeded
+
+
+def main():
+	parser = argparse.ArgumentParser(description="CircuitAI frame time benchmark")
+	parser.add_argument("--runs", type=int, default=3)
+	parser.add_argument("--engine", default="./spring-headless")
+	parser.add_argument("--script", default="head.script")
+	parser.add_argument("--stats", help="profile/<map>_stats.json in engine's writable data dir")
+	parser.add_argument("--fixtures", nargs="+", help="saved <map>_stats.json files, one per run, instead of engine runs")
+	parser.add_argument("--save", help="write summary as baseline json")
+	parser.add_argument("--baseline", help="compare with baseline json")
+	parser.add_argument("--threshold", type=float, default=0.1, help="allowed p99 regression, fraction")
+	args = parser.parse_args()
+	if not args.fixtures and not args.stats:
+		parser.error("--stats is required without --fixtures")
+
+	zones = {}
+	succeeded = read_fixtures(args, zones) if args.fixtures else run_engine(args, zones)
+
+	if succeeded == 0:
+		print ("no successful runs")
+		sys.exit(2)
+
+	stats = summarize(zones)
+	print ("{0:<60} {1:>8} {2:>10} {3:>10} {4:>10}".format("zone", "count", "p50 us", "p99 us", "max us"))
+	for name in sorted(stats, key=lambda n: -stats[n]["p99"]):
+		s = stats[name]
+		print ("{0:<60.60} {1:>8} {2:>10.1f} {3:>10.1f} {4:>10.1f}".format(name, s["count"], s["p50"], s["p99"], s["max"]))
+
+	if args.save:
+		with open(args.save, "w") as f:
+			json.dump(stats, f, indent=1)
+
+	if args.baseline:
+		with open(args.baseline) as f:
+			baseline = json.load(f)
+		regressions = 0
+		for name, s in stats.items():
+			if name in baseline and s["p99"] > baseline[name]["p99"] * (1.0 + args.threshold):
+				print ("REGRESSION {0}: p99 {1:.1f} us > {2:.1f} us".format(name, s["p99"], baseline[name]["p99"]))
+				regressions += 1
+		sys.exit(1 if regressions > 0 else 0)
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,118 @@
+/*
+ * Microbenchmark of threat circle stamps: per-cell loop (before CCircleRaster) vs row spans.
+ * Same stamps, same 512x512 sector grid, prints cells per second of both and max difference.
+ *
+ * Build from util/ (SpringThreading.h comes from spring's rts/):
+ *   g++ -O2 -std=c++14 -march=native -pthread -I../src/circuit -I<spring>/rts \
+ *       bench_circleraster.cpp ../src/circuit/util/math/CircleRaster.cpp -o bench_circleraster
+ * Run: ./bench_circleraster [num_stamps=20000] [seed=1]
+ */
+
+#include "util/math/CircleRaster.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using circuit::CCircleRaster;
+
+constexpr int WIDTH = 512;
+constexpr int HEIGHT = 512;
+constexpr int MIN_RANGE = 4;
+constexpr int MAX_RANGE = 48;
+
+struct SStamp {
+	int x, z;
+	int range;
+	float threat;
+};
+
+// CThreatMap::AddEnemyAir as of baseline: box scan, radius test and sqrtf per cell
+static long long StampCells(float* grid, const SStamp& e)
+{
+	const int rangeSq = e.range * e.range;
+	const int beginX = std::max(e.x - e.range + 1,      0);
+	const int endX   = std::min(e.x + e.range    ,  WIDTH);
+	const int beginZ = std::max(e.z - e.range + 1,      0);
+	const int endZ   = std::min(e.z + e.range    , HEIGHT);
+	long long cells = 0;
+	for (int z = beginZ; z < endZ; ++z) {
+		const int dzSq = (e.z - z) * (e.z - z);
+		for (int x = beginX; x < endX; ++x) {
+			const int sum = (e.x - x) * (e.x - x) + dzSq;
+			if (sum > rangeSq) {
+				continue;
+			}
+			grid[z * WIDTH + x] += e.threat * (1.0f - 0.5f * sqrtf(sum) / e.range);
+			++cells;
+		}
+	}
+	return cells;
+}
+
+// CThreatMap::AddEnemyAir now
+static long long StampSpans(float* grid, const SStamp& e)
+{
+	long long cells = 0;
+	CCircleRaster::ForEachRow(e.x, e.z, e.range, WIDTH, HEIGHT,
+			[grid, &e, &cells](int z, int beginX, int endX, const float* dist) {
+		CCircleRaster::AddSpanClamp(&grid[z * WIDTH + beginX], dist, endX - beginX,
+				e.threat, -0.5f * e.threat, 0.f);
+		cells += endX - beginX;
+	});
+	return cells;
+}
+
+template<typename F>
+static double Run(const std::vector<SStamp>& stamps, std::vector<float>& grid, F&& stamp, long long& cells)
+{
+	double best = 1e30;
+	for (int rep = 0; rep < 5; ++rep) {
+		std::fill(grid.begin(), grid.end(), 0.f);
+		cells = 0;
+		auto t0 = std::chrono::steady_clock::now();
+		for (const SStamp& e : stamps) {
+			cells += stamp(grid.data(), e);
+		}
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+	}
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	const int numStamps = (argc > 1) ? std::atoi(argv[1]) : 20000;
+	const unsigned seed = (argc > 2) ? std::atoi(argv[2]) : 1;
+
+	std::mt19937 rng(seed);
+	std::vector<SStamp> stamps(numStamps);
+	for (SStamp& e : stamps) {
+		e.x = rng() % WIDTH;
+		e.z = rng() % HEIGHT;
+		e.range = MIN_RANGE + rng() % (MAX_RANGE - MIN_RANGE + 1);
+		e.threat = 1.f + rng() % 100;
+	}
+	for (int r = MIN_RANGE; r <= MAX_RANGE; ++r) {
+		CCircleRaster::GetCircle(r);  // tables are built once per process, keep it out of timing
+	}
+
+	std::vector<float> before(WIDTH * HEIGHT), after(WIDTH * HEIGHT);
+	long long cellsBefore, cellsAfter;
+	const double tBefore = Run(stamps, before, StampCells, cellsBefore);
+	const double tAfter = Run(stamps, after, StampSpans, cellsAfter);
+
+	float maxDiff = 0.f;
+	for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+		maxDiff = std::max(maxDiff, std::fabs(before[i] - after[i]) / std::max(std::fabs(before[i]), 1.f));
+	}
+
+	printf("%dx%d grid, %d stamps, range %d..%d\n", WIDTH, HEIGHT, numStamps, MIN_RANGE, MAX_RANGE);
+	printf("per-cell : %.1f Mcells/s (%lld cells)\n", cellsBefore / tBefore * 1e-6, cellsBefore);
+	printf("row spans: %.1f Mcells/s (%lld cells)\n", cellsAfter / tAfter * 1e-6, cellsAfter);
+	printf("speedup %.2fx, max relative difference %g\n", tBefore / tAfter, maxDiff);
+	return (cellsBefore == cellsAfter) ? 0 : 1;
+}
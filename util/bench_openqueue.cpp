@@ -0,0 +1,285 @@
+/*
+ * Replay benchmark of MicroPather open lists on a synthetic path map.
+ * The same seeded queries run with the binary heap of baseline MicroPather (OpenQueueBH)
+ * and with the open lists CMicroPather uses now (terrain/path/OpenQueue.h):
+ *   A* (FindBestPathTo*)  - OpenQueueBH vs OpenQueue4H
+ *   Dijkstra (MakeCostMap) - OpenQueueBH vs OpenQueueBucket
+ * Prints nodes expanded per second of each and checks that results match.
+ *
+ * Build from util/ (engine headers only for int2 and AIFloat3 used by MicroPather.h):
+ *   g++ -O2 -std=c++14 -I../src/circuit -I<spring>/rts -I<spring>/AI/Wrappers/Cpp/src-generated \
+ *       bench_openqueue.cpp -o bench_openqueue
+ * Run: ./bench_openqueue [size=512] [queries=40] [seed=1]
+ */
+
+#include "terrain/path/OpenQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace NSMicroPather;
+
+/*
+ * Binary heap of baseline MicroPather: PathNode* array, position written back on every swap.
+ * NOTE: Baseline kept the position in PathNode::myIndex, here it is a side array of the same size.
+ */
+class OpenQueueBH {
+public:
+	OpenQueueBH(PathNode* nodes, PathNode** heapArray, int* myIndex)
+		: nodes(nodes), heapArray(heapArray), myIndex(myIndex), size(0)
+	{}
+
+	void Push(PathNode* pNode) {
+		pNode->inOpen = 1;
+		heapArray[++size] = pNode;
+		SetIndex(pNode, size);
+		SiftUp(size);
+	}
+
+	void Update(PathNode* pNode) {
+		SiftUp(myIndex[pNode - nodes]);
+	}
+
+	PathNode* Pop() {
+		PathNode* min = heapArray[1];
+		min->inOpen = 0;
+		heapArray[1] = heapArray[size--];
+		if (size == 0) {
+			return min;
+		}
+		SetIndex(heapArray[1], 1);
+		int index = 1;
+		while (true) {
+			const int left = index << 1;
+			const int right = left + 1;
+			int smallest = index;
+			if ((left <= size) && (heapArray[left]->totalCost < heapArray[smallest]->totalCost)) {
+				smallest = left;
+			}
+			if ((right <= size) && (heapArray[right]->totalCost < heapArray[smallest]->totalCost)) {
+				smallest = right;
+			}
+			if (smallest == index) {
+				break;
+			}
+			Swap(index, smallest);
+			index = smallest;
+		}
+		return min;
+	}
+
+	bool Empty() { return size == 0; }
+
+private:
+	void SetIndex(PathNode* pNode, int i) { myIndex[pNode - nodes] = i; }
+	void Swap(int a, int b) {
+		std::swap(heapArray[a], heapArray[b]);
+		SetIndex(heapArray[a], a);
+		SetIndex(heapArray[b], b);
+	}
+	void SiftUp(int i) {
+		while ((i > 1) && (heapArray[i >> 1]->totalCost > heapArray[i]->totalCost)) {
+			Swap(i >> 1, i);
+			i >>= 1;
+		}
+	}
+
+	PathNode* nodes;
+	PathNode** heapArray;
+	int* myIndex;
+	int size;
+};
+
+struct SGrid {
+	int size;
+	std::vector<float> cost;  // per cell, >= COST_BASE; < 0 - blocked
+	PathNode* nodes;
+
+	void Reset() {
+		for (int i = 0; i < size * size; ++i) {
+			nodes[i].Init(i % size, i / size, i, 0, FLT_BIG, nullptr);
+		}
+	}
+};
+
+static void MakeGrid(SGrid& grid, std::mt19937& rng)
+{
+	const int n = grid.size;
+	grid.cost.assign(n * n, COST_BASE);
+	// Threat blobs
+	for (int b = 0; b < n / 4; ++b) {
+		const int cx = rng() % n, cz = rng() % n, r = 4 + rng() % 24;
+		const float heat = 1.f + rng() % 40;
+		for (int z = std::max(cz - r, 0); z < std::min(cz + r, n); ++z) {
+			for (int x = std::max(cx - r, 0); x < std::min(cx + r, n); ++x) {
+				const float d = std::sqrt(float((x - cx) * (x - cx) + (z - cz) * (z - cz))) / r;
+				if (d < 1.f) {
+					grid.cost[z * n + x] += heat * (1.f - d);
+				}
+			}
+		}
+	}
+	// Walls with gaps
+	for (int w = 0; w < n / 16; ++w) {
+		const bool isVertical = rng() & 1;
+		const int at = rng() % n, from = rng() % n, len = n / 8 + rng() % (n / 4);
+		for (int i = from; i < std::min(from + len, n); ++i) {
+			if (i % 37 != 0) {
+				grid.cost[isVertical ? (i * n + at) : (at * n + i)] = -1.f;
+			}
+		}
+	}
+}
+
+/*
+ * 8-connected search, heuristic == 0 gives MakeCostMap's Dijkstra.
+ * Returns cost at goal (whole map for goal < 0), counts expanded nodes.
+ */
+template<typename Q>
+static float Search(SGrid& grid, Q& open, int start, int goal, long long& expanded)
+{
+	const int n = grid.size;
+	const int gx = goal % n, gz = goal / n;
+	auto heuristic = [&](int i) {
+		if (goal < 0) {
+			return 0.f;
+		}
+		const int dx = std::abs(i % n - gx), dz = std::abs(i / n - gz);
+		return COST_BASE * (std::max(dx, dz) + 0.4142f * std::min(dx, dz));
+	};
+
+	PathNode* nodes = grid.nodes;
+	nodes[start].costFromStart = 0.f;
+	nodes[start].totalCost = heuristic(start);
+	open.Push(&nodes[start]);
+	while (!open.Empty()) {
+		PathNode* node = open.Pop();
+		node->inClosed = 1;
+		++expanded;
+		const int i = node->index2;
+		if (i == goal) {
+			break;
+		}
+		const int x = i % n, z = i / n;
+		for (int dz = -1; dz <= 1; ++dz) {
+			for (int dx = -1; dx <= 1; ++dx) {
+				const int nx = x + dx, nz = z + dz;
+				if ((dx == 0 && dz == 0) || nx < 0 || nz < 0 || nx >= n || nz >= n) {
+					continue;
+				}
+				const int j = nz * n + nx;
+				PathNode* next = &nodes[j];
+				if (next->inClosed || (grid.cost[j] < 0.f)) {
+					continue;
+				}
+				const float c = node->costFromStart + grid.cost[j] * ((dx != 0 && dz != 0) ? 1.4142f : 1.f);
+				if (c < next->costFromStart) {
+					next->costFromStart = c;
+					next->totalCost = c + heuristic(j);
+					if (next->inOpen) {
+						open.Update(next);
+					} else {
+						open.Push(next);
+					}
+				}
+			}
+		}
+	}
+	return (goal >= 0) ? nodes[goal].costFromStart : 0.f;
+}
+
+struct SResult {
+	double seconds = 0.0;
+	long long expanded = 0;
+};
+
+template<typename MakeQ>
+static float Run(SGrid& grid, int start, int goal, MakeQ&& makeQueue, SResult& result, std::vector<float>* dist)
+{
+	grid.Reset();  // NOTE: CMicroPather reuses nodes by frame, keep the reset out of timing
+	auto t0 = std::chrono::steady_clock::now();
+	decltype(auto) open = makeQueue();  // reusable queue comes by reference
+	const float cost = Search(grid, open, start, goal, result.expanded);
+	result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	if (dist != nullptr) {
+		dist->resize(grid.size * grid.size);
+		for (int i = 0; i < grid.size * grid.size; ++i) {
+			(*dist)[i] = grid.nodes[i].costFromStart;
+		}
+	}
+	return cost;
+}
+
+static void Print(const char* name, const SResult& r, int queries)
+{
+	printf("  %-16s %8.2f ms/query  %7.2f Mnodes/s\n", name, r.seconds * 1e3 / queries, r.expanded / r.seconds * 1e-6);
+}
+
+int main(int argc, char* argv[])
+{
+	SGrid grid;
+	grid.size = (argc > 1) ? std::atoi(argv[1]) : 512;
+	const int numQueries = (argc > 2) ? std::atoi(argv[2]) : 40;
+	std::mt19937 rng((argc > 3) ? std::atoi(argv[3]) : 1);
+
+	const int numCells = grid.size * grid.size;
+	MakeGrid(grid, rng);
+	grid.nodes = static_cast<PathNode*>(std::malloc(sizeof(PathNode) * numCells));  // PathNode has private ctor
+	std::vector<PathNode*> bhArray(numCells + 1);
+	std::vector<int> bhIndex(numCells);
+	std::vector<OpenQueue4H::Entry> heapArray(numCells);
+	std::vector<int> heapPos(numCells);
+	OpenQueueBucket bucketQueue;
+
+	auto makeBH = [&]() { return OpenQueueBH(grid.nodes, bhArray.data(), bhIndex.data()); };
+	auto make4H = [&]() { return OpenQueue4H(grid.nodes, heapArray.data(), heapPos.data()); };
+	auto makeBucket = [&]() -> OpenQueueBucket& { bucketQueue.Clear(grid.nodes); return bucketQueue; };
+
+	auto randomCell = [&]() {
+		int i;
+		do {
+			i = rng() % numCells;
+		} while (grid.cost[i] < 0.f);
+		return i;
+	};
+	std::vector<std::pair<int, int>> queries(numQueries);
+	for (auto& q : queries) {
+		q = {randomCell(), randomCell()};
+	}
+
+	int mismatches = 0;
+	SResult aBH, a4H, dBH, dBucket;
+	std::vector<float> distBH, distBucket;
+	for (int pass = 0; pass < 2; ++pass) {  // first pass warms caches, second is reported
+		aBH = a4H = dBH = dBucket = SResult();
+		for (const auto& q : queries) {
+			const float c0 = Run(grid, q.first, q.second, makeBH, aBH, nullptr);
+			const float c1 = Run(grid, q.first, q.second, make4H, a4H, nullptr);
+			mismatches += std::fabs(c0 - c1) > 1e-3f * std::max(c0, 1.f);
+
+			Run(grid, q.first, -1, makeBH, dBH, &distBH);
+			Run(grid, q.first, -1, makeBucket, dBucket, &distBucket);
+			for (int i = 0; i < numCells; ++i) {
+				mismatches += std::fabs(distBH[i] - distBucket[i]) > 1e-3f * std::max(distBH[i], 1.f);
+			}
+		}
+	}
+	std::free(grid.nodes);
+
+	printf("%dx%d grid, %d queries\n", grid.size, grid.size, numQueries);
+	printf("A* (FindBestPathTo*):\n");
+	Print("OpenQueueBH", aBH, numQueries);
+	Print("OpenQueue4H", a4H, numQueries);
+	printf("  speedup %.2fx\n", aBH.seconds / a4H.seconds);
+	printf("Dijkstra (MakeCostMap):\n");
+	Print("OpenQueueBH", dBH, numQueries);
+	Print("OpenQueueBucket", dBucket, numQueries);
+	printf("  speedup %.2fx\n", dBH.seconds / dBucket.seconds);
+	printf("mismatches %d\n", mismatches);
+	return (mismatches == 0) ? 0 : 1;
+}